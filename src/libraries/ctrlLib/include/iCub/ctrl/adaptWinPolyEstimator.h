@@ -92,7 +92,37 @@ protected:
     yarp::sig::Vector winLen;
     yarp::sig::Vector mse;
 
+    yarp::sig::Vector phi;
+    yarp::sig::Vector phiScale;
+    yarp::sig::Vector Acum;
+    yarp::sig::Vector bcum;
+    yarp::sig::Vector L;
+
     bool firstRun;
+    bool incremental;
+
+    /**
+    * Fill the regressors of the current time window and accumulate 
+    * the normal-equation matrices of all the window's suffixes.
+    * @return true if the time window allows for the incremental 
+    *         fitting.
+    */ 
+    bool prepareIncrementalFit();
+
+    /**
+    * Accumulate the normal-equation vectors of all the window's 
+    * suffixes for the current data vector. 
+    */ 
+    void accumIncrementalFit();
+
+    /**
+    * Solve the normal equations of the last n data sample couples, 
+    * storing the result in the regressor's coefficients. 
+    * @param n last n data sample couples to fit.
+    * @return true if the system is well conditioned, false if the 
+    *         fitting has to be carried out through fit().
+    */ 
+    bool solveIncrementalFit(const unsigned int n);
 
     /**
     * Find the regressor which best fits in least square sense the 
@@ -169,6 +199,24 @@ public:
     */
     yarp::sig::Vector estimate(const AWPolyElement &el);
 
+    /**
+    * Enable/disable the incremental fitting: the least-squares 
+    * problems of all the window's lengths are solved through normal 
+    * equations accumulated sample by sample, without allocating 
+    * memory and without resorting to the SVD.
+    * @param sw true to enable, false to disable. 
+    * @note The fitting is no longer carried out through fit(): 
+    *       derived classes redefining fit() for a different purpose
+    *       than speeding up the computation should not enable it.
+    */
+    void setIncrementalFit(const bool sw) { incremental=sw; }
+
+    /**
+    * Return the status of the incremental fitting.
+    * @return true if enabled.
+    */
+    bool getIncrementalFit() const { return incremental; }
+
     /**
     * Reinitialize the internal state. 
     * @note Windows lengths are brought to the maximum value N and 
@@ -41,7 +41,15 @@ AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const dou
     t.resize(N);
     x.resize(N);
 
+    unsigned int P=order+1;
+    phi.resize(N*P);
+    phiScale.resize(P);
+    Acum.resize((N+1)*P*P);
+    bcum.resize((N+1)*P);
+    L.resize(P*P);
+
     firstRun=true;
+    incremental=false;
 }
 
 
@@ -98,6 +106,129 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
 }
 
 
+/***************************************************************************/
+bool AWPolyEstimator::prepareIncrementalFit()
+{
+    // the time axis is normalized within [0,1] (numeric stability reason)
+    double s=t[N-1];
+    if (s<=0.0)
+        return false;
+
+    // same polynomial basis of fit() and eval()
+    unsigned int P=order+1;
+    double _s=s;
+    phiScale[0]=1.0;
+    for (unsigned int j=1; j<P; j++)
+    {
+        phiScale[j]=_s;
+        _s*=_s;
+    }
+
+    for (unsigned int k=0; k<N; k++)
+    {
+        double *p=&phi[k*P];
+        double _u=t[k]/s;
+        p[0]=1.0;
+        for (unsigned int j=1; j<P; j++)
+        {
+            p[j]=_u;
+            _u*=_u;
+        }
+    }
+
+    // Acum(m) holds the normal-equation matrix of the last m samples
+    double *A=&Acum[0];
+    for (unsigned int j=0; j<P*P; j++)
+        A[j]=0.0;
+
+    for (unsigned int m=1; m<=N; m++)
+    {
+        const double *p=&phi[(N-m)*P];
+        const double *A0=&Acum[(m-1)*P*P];
+        double *A1=&Acum[m*P*P];
+        for (unsigned int r=0; r<P; r++)
+            for (unsigned int c=0; c<P; c++)
+                A1[r*P+c]=A0[r*P+c]+p[r]*p[c];
+    }
+
+    return true;
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::accumIncrementalFit()
+{
+    unsigned int P=order+1;
+    double *b=&bcum[0];
+    for (unsigned int j=0; j<P; j++)
+        b[j]=0.0;
+
+    for (unsigned int m=1; m<=N; m++)
+    {
+        const double *p=&phi[(N-m)*P];
+        const double *b0=&bcum[(m-1)*P];
+        double *b1=&bcum[m*P];
+        double _x=x[N-m];
+        for (unsigned int j=0; j<P; j++)
+            b1[j]=b0[j]+p[j]*_x;
+    }
+}
+
+
+/***************************************************************************/
+bool AWPolyEstimator::solveIncrementalFit(const unsigned int n)
+{
+    unsigned int P=order+1;
+    const double *A=&Acum[n*P*P];
+    const double *b=&bcum[n*P];
+    double *l=&L[0];
+
+    // Cholesky factorization A=L*L'
+    for (unsigned int j=0; j<P; j++)
+    {
+        double d=A[j*P+j];
+        for (unsigned int k=0; k<j; k++)
+            d-=l[j*P+k]*l[j*P+k];
+
+        // rank deficiency is left to the pseudo-inverse
+        if (d<=1e-12*A[j*P+j])
+            return false;
+
+        l[j*P+j]=sqrt(d);
+        for (unsigned int i=j+1; i<P; i++)
+        {
+            double e=A[i*P+j];
+            for (unsigned int k=0; k<j; k++)
+                e-=l[i*P+k]*l[j*P+k];
+            l[i*P+j]=e/l[j*P+j];
+        }
+    }
+
+    // forward and backward substitutions
+    for (unsigned int i=0; i<P; i++)
+    {
+        double e=b[i];
+        for (unsigned int k=0; k<i; k++)
+            e-=l[i*P+k]*coeff[k];
+        coeff[i]=e/l[i*P+i];
+    }
+
+    for (int i=P-1; i>=0; i--)
+    {
+        double e=coeff[i];
+        for (unsigned int k=i+1; k<P; k++)
+            e-=l[k*P+i]*coeff[k];
+        coeff[i]=e/l[i*P+i];
+    }
+
+    // back to the original time axis
+    for (unsigned int j=0; j<P; j++)
+        coeff[j]/=phiScale[j];
+
+    return true;
+}
+
+
 /***************************************************************************/
 void AWPolyEstimator::feedData(const AWPolyElement &el)
 {
@@ -131,6 +262,8 @@ Vector AWPolyEstimator::estimate()
     for (unsigned int j=0; j<N; j++)
         t[j]=elemList[delta+j].time-elemList[delta].time;
 
+    bool incr=incremental && prepareIncrementalFit();
+
     // cycle upon all elements
     for (unsigned int i=0; i<dim; i++)
     {
@@ -138,6 +271,9 @@ Vector AWPolyEstimator::estimate()
         for (unsigned int j=0; j<N; j++)
             x[j]=elemList[delta+j].data[i];
 
+        if (incr)
+            accumIncrementalFit();
+
         // change the window length of two units, back and forth
         unsigned int n1=(unsigned int)((winLen[i]>(order+1))?(winLen[i]-1):(order+1));
         unsigned int n2=(unsigned int)((winLen[i]<N)?(winLen[i]+1):N);
@@ -146,7 +282,8 @@ Vector AWPolyEstimator::estimate()
         for (unsigned int n=n1; n<=n2; n++)
         {
             // find the regressor's coefficients
-            coeff=fit(t,x,n);
+            if (!incr || !solveIncrementalFit(n))
+                coeff=fit(t,x,n);
             bool _stop=false;            
 
             // test the regressor upon all the elements
@@ -118,6 +118,7 @@ class iDynLink : public iKin::iKinLink
 {
     friend class iDynChain;
     friend class OneLinkNewtonEuler;
+    friend class OneChainNewtonEuler;
 
 protected:
     // DH rototranslation matrix (it's the same matrix you get calling iKinLink->getH(true) but it's stored here for performance reason)
@@ -552,6 +553,8 @@ protected:
 
     ///pointer to OneChainNewtonEuler class, to be used for computing forces and torques
     OneChainNewtonEuler *NE;
+    ///specifies the backend used for the Newton-Euler sweeps: NE_STANDARD, NE_FAST
+    NewEulBackend backend;
 
     const yarp::sig::Vector zero0;
 
@@ -854,6 +857,22 @@ public:
     */
     void setModeNewtonEuler(const NewEulMode NewEulMode_s=DYNAMIC);
 
+    /**
+    * Set the backend used for the Newton-Euler computations. NE_FAST performs 
+    * the forward kinematic and backward wrench sweeps in place, on fixed-size 
+    * quantities, without allocating any temporary; it is available for the 
+    * default iteration mode (kinematics FORWARD, wrench BACKWARD), otherwise 
+    * the standard computation is carried out. Default is NE_STANDARD.
+    * @param _backend NE_STANDARD/NE_FAST
+    */
+    void setBackendNewtonEuler(const NewEulBackend _backend=NE_STANDARD);
+
+    /**
+    * Get the backend used for the Newton-Euler computations.
+    * @return backend
+    */
+    NewEulBackend getBackendNewtonEuler() const;
+
     /**
     * Returns the links forces as a matrix, where the (i+1)-th col is the i-th force
     * @return a 3x(N+2) matrix with forces, in the form: (i+1)-th col = F_i
@@ -1093,6 +1112,9 @@ public:
 
     /**
     * Compute the joint space mass matrix considering only the active joints.
+    * The matrix is obtained through the Composite Rigid Body Algorithm, i.e. 
+    * with a single backward sweep over the chain; rotor inertias are not
+    * taken into account.
     * @return a DOF-by-DOF symmetric positive-definite matrix
     */
     yarp::sig::Matrix computeMassMatrix();
@@ -1153,6 +1175,27 @@ public:
     */
     yarp::sig::Vector computeCcGravityTorques(const yarp::sig::Vector& ddp0, const yarp::sig::Vector& q, const yarp::sig::Vector& dq);
 
+    /**
+    * Compute the joint accelerations produced by the given torques at the current
+    * joint positions and velocities, by solving M*ddq = tau - Cc - G.
+    * @param tau vector of the torques applied to the active joints
+    * @param ddp0 a vector that is equal and opposite to gravity expressed in the base reference frame (not the 0th frame)
+    * @return a DOF-dim vector, or an empty vector in case of failure
+    * @note After calling this method the joint accelerations of the chain are set to zero
+    */
+    yarp::sig::Vector computeForwardDynamics(const yarp::sig::Vector& tau, const yarp::sig::Vector& ddp0);
+
+    /**
+    * Compute the joint accelerations produced by the given torques, by solving M*ddq = tau - Cc - G.
+    * @param tau vector of the torques applied to the active joints
+    * @param ddp0 a vector that is equal and opposite to gravity expressed in the base reference frame (not the 0th frame)
+    * @param q vector of the active joint positions
+    * @param dq vector of the active joint velocities
+    * @return a DOF-dim vector, or an empty vector in case of failure
+    * @note After calling this method the joint accelerations of the chain are set to zero
+    */
+    yarp::sig::Vector computeForwardDynamics(const yarp::sig::Vector& tau, const yarp::sig::Vector& ddp0, const yarp::sig::Vector& q, const yarp::sig::Vector& dq);
+
 
 
 };
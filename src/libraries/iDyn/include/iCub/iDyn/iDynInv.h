@@ -50,6 +50,7 @@
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/skinDynLib/common.h>
 #include <deque>
+#include <vector>
 #include <string>
 
 
@@ -70,6 +71,10 @@ enum ChainComputationMode { KINFWD_WREFWD, KINFWD_WREBWD, KINBWD_WREFWD, KINBWD_
 const std::string ChainIterationMode_s[2] = {"Forward (Base To End)","Backward (End To Base)"};
 const std::string ChainComputationMode_s[4] = {"Kinematic Forward - Wrench Forward","Kinematic Forward - Wrench Backward","Kinematic Backward - Wrench Forward","Kinematic Backward - Wrench Backward"};
 
+// Newton-Euler computation backends
+enum NewEulBackend { NE_STANDARD, NE_FAST };
+const std::string NewEulBackend_s[2] = {"standard (per-link objects)","fast (in-place fixed-size sweeps)"};
+
     class iDynLink;
     class iDynChain;
     class iDynLimb;
@@ -490,6 +495,8 @@ public:
 */
 class BaseLinkNewtonEuler : public OneLinkNewtonEuler
 {
+    friend class OneChainNewtonEuler;
+
 protected:
     ///initial angular velocity
     yarp::sig::Vector w;    
@@ -901,6 +908,21 @@ protected:
     /// verbosity flag
     unsigned int verbose;
 
+    /// the links of the chain, cached for the fast sweeps
+    std::vector<iDyn::iDynLink*> fastLinks;
+    /// 3x3 rotations (row-major) of the links, cached for the fast sweeps
+    std::vector<double> fastR;
+    /// projected translations R^T*r of the links, cached for the fast sweeps
+    std::vector<double> fastr;
+    /// stamps of the links at the time fastR/fastr were computed
+    std::vector<unsigned long> fastStamp;
+
+    /**
+    * Refreshes the cached rotation and projected translation of the
+    * i-th link, only if its joint or DH parameters have changed.
+    */
+    void updateFastGeometry(const unsigned int i);
+
 public:
 
   /**
@@ -1050,6 +1072,20 @@ public:
      */
     void computeTorques();
 
+    /**
+     * [classic] Same as ForwardKinematicFromBase(), but the sweep is carried out 
+     * in place on fixed-size 3-vectors and 3x3 matrices, without allocating any 
+     * yarp::sig temporaries. The DYNAMIC_W_ROTOR mode falls back to the standard sweep.
+     */
+    void ForwardKinematicFromBaseFast();
+
+    /**
+     * [classic] Same as BackwardWrenchFromEnd(), torques included, but the sweep is 
+     * carried out in place on fixed-size 3-vectors and 3x3 matrices, without allocating 
+     * any yarp::sig temporaries. The DYNAMIC_W_ROTOR mode falls back to the standard sweep.
+     */
+    void BackwardWrenchFromEndFast();
+
     /**
      * [inverse] Base function for inverse Newton-Euler: from the i-th link to the end, 
      * forward of forces and moments using the inverse formula
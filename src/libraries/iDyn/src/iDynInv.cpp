@@ -36,6 +36,42 @@ using namespace iCub::iDyn;
 using namespace iCub::skinDynLib;
 
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// fixed-size helpers for the fast Newton-Euler sweeps (R is 3x3 row-major)
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+inline void cross3(const double *a, const double *b, double *c)
+{
+    c[0]=a[1]*b[2]-a[2]*b[1];
+    c[1]=a[2]*b[0]-a[0]*b[2];
+    c[2]=a[0]*b[1]-a[1]*b[0];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+inline void mult3(const double *R, const double *v, double *c)
+{
+    c[0]=R[0]*v[0]+R[1]*v[1]+R[2]*v[2];
+    c[1]=R[3]*v[0]+R[4]*v[1]+R[5]*v[2];
+    c[2]=R[6]*v[0]+R[7]*v[1]+R[8]*v[2];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+inline void multT3(const double *R, const double *v, double *c)
+{
+    c[0]=R[0]*v[0]+R[3]*v[1]+R[6]*v[2];
+    c[1]=R[1]*v[0]+R[4]*v[1]+R[7]*v[2];
+    c[2]=R[2]*v[0]+R[5]*v[1]+R[8]*v[2];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+inline void addCrossCross3(const double *w, const double *dw, const double *r, double *a)
+{
+    // a += dw x r + w x (w x r)
+    double t[3],u[3];
+    cross3(dw,r,t);
+    a[0]+=t[0]; a[1]+=t[1]; a[2]+=t[2];
+    cross3(w,r,t);
+    cross3(w,t,u);
+    a[0]+=u[0]; a[1]+=u[1]; a[2]+=u[2];
+}
+
+
 //================================
 //
 //      ONE LINK NEWTON EULER
@@ -1708,6 +1744,16 @@ OneChainNewtonEuler::OneChainNewtonEuler(iDynChain *_c, string _info, const NewE
     //the end effector is the last (nLinks+2-1 because it's an index)
     nEndEff = nLinks+1;
 
+    //storage for the fast sweeps
+    fastLinks.resize(nLinks);
+    fastR.resize(9*nLinks);
+    fastr.resize(3*nLinks);
+    fastStamp.resize(nLinks);
+    for(unsigned int i=0; i<nLinks; i++)
+    {
+        fastLinks[i] = chain->refLink(i);
+        fastStamp[i] = fastLinks[i]->stamp+1;   // force the first update
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 OneChainNewtonEuler::~OneChainNewtonEuler()
@@ -1896,6 +1942,183 @@ void OneChainNewtonEuler::computeTorques()
     }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::updateFastGeometry(const unsigned int i)
+{
+    iDynLink *l = fastLinks[i];
+    if(fastStamp[i] == l->stamp)
+        return;
+
+    double H[16];
+    l->fillH(H,true);
+
+    double *R = &fastR[9*i];
+    R[0]=H[0]; R[1]=H[1]; R[2]=H[2];
+    R[3]=H[4]; R[4]=H[5]; R[5]=H[6];
+    R[6]=H[8]; R[7]=H[9]; R[8]=H[10];
+
+    // same as iDynLink::getr(true)
+    const double p[3] = {H[3],H[7],H[11]};
+    multT3(R,p,&fastr[3*i]);
+
+    fastStamp[i] = l->stamp;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::ForwardKinematicFromBaseFast()
+{
+    if(mode == DYNAMIC_W_ROTOR)
+    {
+        ForwardKinematicFromBase();
+        return;
+    }
+
+    // kinematics of the previous frame, starting from the base
+    double w[3],dw[3],ddp[3];
+    const Vector &w0 = neChain[0]->getAngVel();
+    const Vector &dw0 = neChain[0]->getAngAcc();
+    const Vector &ddp0 = neChain[0]->getLinAcc();
+    for(int k=0; k<3; k++)
+    {
+        w[k] = w0[k];
+        dw[k] = dw0[k];
+        ddp[k] = ddp0[k];
+    }
+
+    double tmp[3];
+    for(unsigned int i=0; i<nLinks; i++)
+    {
+        iDynLink *l = fastLinks[i];
+        updateFastGeometry(i);
+        const double *R = &fastR[9*i];
+        const double *r = &fastr[3*i];
+
+        multT3(R,ddp,tmp);
+        ddp[0]=tmp[0]; ddp[1]=tmp[1]; ddp[2]=tmp[2];
+
+        if(mode == STATIC)
+        {
+            w[0]=w[1]=w[2]=0.0;
+            dw[0]=dw[1]=dw[2]=0.0;
+        }
+        else
+        {
+            // see computeAngVel(), computeAngAcc() and computeLinAcc()
+            const double dq = l->dq;
+            const double ddq = (mode == DYNAMIC) ? l->ddq : 0.0;
+
+            tmp[0] = dw[0] + dq*w[1];
+            tmp[1] = dw[1] - dq*w[0];
+            tmp[2] = dw[2] + ddq;
+            multT3(R,tmp,dw);
+
+            w[2] += dq;
+            multT3(R,w,tmp);
+            w[0]=tmp[0]; w[1]=tmp[1]; w[2]=tmp[2];
+
+            addCrossCross3(w,dw,r,ddp);
+        }
+
+        double *lw = l->w.data();
+        double *ldw = l->dw.data();
+        double *lddp = l->ddp.data();
+        double *lddpC = l->ddpC.data();
+        for(int k=0; k<3; k++)
+        {
+            lw[k] = w[k];
+            ldw[k] = dw[k];
+            lddp[k] = lddpC[k] = ddp[k];
+        }
+
+        // see computeLinAccC()
+        if(mode != STATIC)
+            addCrossCross3(w,dw,l->rc.data(),lddpC);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::BackwardWrenchFromEndFast()
+{
+    if((mode == DYNAMIC_W_ROTOR) || (nLinks == 0))
+    {
+        BackwardWrenchFromEnd();
+        return;
+    }
+
+    // the last link receives the end-effector wrench as it is
+    const Vector &Fe = neChain[nEndEff]->getForce();
+    const Vector &Mue = neChain[nEndEff]->getMoment(false);
+    iDynLink *last = fastLinks[nLinks-1];
+    for(int k=0; k<3; k++)
+    {
+        last->F[k] = Fe[k];
+        last->Mu[k] = Mue[k];
+    }
+
+    double mA[3],t[3],u[3],F[3],Mu[3];
+    for(int j=nLinks-1; j>=0; j--)
+    {
+        // wrench of the frame preceding link j, given the one of link j
+        iDynLink *n = fastLinks[j];
+        updateFastGeometry(j);
+        const double *Rn = &fastR[9*j];
+        const double *rnp = &fastr[3*j];
+        const double *rc = n->rc.data();
+        const double *Fn = n->F.data();
+        const double *Mun = n->Mu.data();
+        const double *ddpC = n->ddpC.data();
+
+        // see computeForceBackward()
+        for(int k=0; k<3; k++)
+        {
+            mA[k] = n->m*ddpC[k];
+            t[k] = mA[k] + Fn[k];
+        }
+        mult3(Rn,t,F);
+
+        // see computeMomentBackward()
+        cross3(rnp,Fn,t);
+        const double rrc[3] = {rnp[0]+rc[0],rnp[1]+rc[1],rnp[2]+rc[2]};
+        cross3(rrc,mA,u);
+        for(int k=0; k<3; k++)
+            t[k] += u[k] + Mun[k];
+
+        if(mode != STATIC)
+        {
+            const double *I = n->I.data();
+            const double *w = n->w.data();
+            double Iw[3];
+            mult3(I,n->dw.data(),u);
+            mult3(I,w,Iw);
+            t[0]+=u[0]; t[1]+=u[1]; t[2]+=u[2];
+            cross3(w,Iw,u);
+            t[0]+=u[0]; t[1]+=u[1]; t[2]+=u[2];
+        }
+        mult3(Rn,t,Mu);
+
+        // see computeTorque()
+        n->Tau = Mu[2];
+
+        if(j > 0)
+        {
+            iDynLink *p = fastLinks[j-1];
+            for(int k=0; k<3; k++)
+            {
+                p->F[k] = F[k];
+                p->Mu[k] = Mu[k];
+            }
+        }
+        else
+        {
+            // see BaseLinkNewtonEuler::setForce() and setMoment()
+            BaseLinkNewtonEuler *base = static_cast<BaseLinkNewtonEuler*>(neChain[0]);
+            const double *H0 = base->H0.data();
+            const double R0[9] = {H0[0],H0[1],H0[2],H0[4],H0[5],H0[6],H0[8],H0[9],H0[10]};
+            mult3(R0,F,base->F.data());
+            mult3(R0,Mu,base->Mu.data());
+            for(int k=0; k<3; k++)
+                base->Mu0[k] = Mu[k];
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneChainNewtonEuler::BackwardWrenchFromEnd(const Vector &F, const Vector &Mu)
 {
     
@@ -63,6 +63,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
@@ -107,6 +108,9 @@ protected:
     bool         constrained;
     unsigned int verbose;
 
+    // incremented whenever a parameter affecting H changes
+    unsigned long stamp;
+
     yarp::sig::Matrix H;
     yarp::sig::Matrix cumH;
     yarp::sig::Matrix DnH;
@@ -126,6 +130,8 @@ protected:
     void         release()          { blocked=false;              }
     void         rmCumH()           { cumulative=false;           }
     void         addCumH(const yarp::sig::Matrix &_cumH);
+    void         fillH(double *_H, bool c_override=false);
+    void         fillDnH(double *_DnH, bool c_override=false);
 
 public:
     /**
@@ -199,7 +205,7 @@ public:
     * Sets the Link length A. 
     * @param new Link length _A. 
     */
-    void setA(const double _A) { A=_A; }
+    void setA(const double _A) { A=_A; stamp++; }
 
     /**
     * Returns the Link offset D.
@@ -235,7 +241,7 @@ public:
     * Sets the joint angle offset. 
     * @param new joint angle offset _Offset. 
     */
-    void setOffset(const double _Offset) { Offset=_Offset; }
+    void setOffset(const double _Offset) { Offset=_Offset; stamp++; }
 
     /**
     * Returns the joint angle lower bound.
@@ -358,6 +364,21 @@ public:
 * \ingroup iKinFwd
 *
 * A Base class for defining a Serial Link Chain. 
+*  
+* \note The Chain keeps a cache of the cumulative transforms of 
+*       its Links, which is refreshed on demand by the kinematic
+*       queries (e.g. getH(), EndEffPose(), GeoJacobian()).
+*       Therefore, those queries modify the internal state of the
+*       Chain even though they do not change its configuration:
+*       as for the Links, whose getH() already stores its result
+*       internally, a Chain object must not be accessed
+*       concurrently by multiple threads, not even for reading,
+*       unless the accesses are serialized by the caller (e.g.
+*       the Cartesian solver and controller guard their Chains
+*       with a mutex, while the gaze controller threads work on
+*       their own copies).
+*       Threads needing concurrent queries shall rely on distinct
+*       copies of the Chain.
 */
 class iKinChain
 {
@@ -378,10 +399,20 @@ protected:
     yarp::sig::Matrix hess_J;
     yarp::sig::Matrix hess_Jlnk;
 
+    // cache of the cumulative transforms H0*H_0*...*H_(i-1) over
+    // the full set of links, stored as row-major 4x4 blocks
+    std::vector<double>        fkCache;
+    std::vector<unsigned long> fkStamps;
+    unsigned int               fkValid;
+
     virtual void clone(const iKinChain &c);
     virtual void build();
     virtual void dispose();
 
+    const double *updateFKCache();
+    void          batchFwdKin(const yarp::sig::Matrix &Q, const int k0, const int nk,
+                              double *T, double *ZP);
+
     yarp::sig::Vector RotAng(const yarp::sig::Matrix &R);
     yarp::sig::Vector dRotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dR);
     yarp::sig::Vector d2RotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dRi,
@@ -705,6 +736,28 @@ public:
     */
     yarp::sig::Vector EndEffPosition(const yarp::sig::Vector &q);
 
+    /**
+    * Same as getH() but the result is written into a caller-provided
+    * matrix. The product of the links is carried out through 
+    * fixed-size 4x4 kernels operating on stack storage, hence no 
+    * heap allocation takes place once H is already 4x4. 
+    * @param H is the matrix filled with H(N-1)*HN (resized only if 
+    *          not 4x4).
+    * @see getH
+    */
+    void fastGetH(yarp::sig::Matrix &H);
+
+    /**
+    * Same as EndEffPose() but the result is written into a 
+    * caller-provided vector without heap allocations (once x has 
+    * the proper size). 
+    * @param x is the vector filled with the end-effector pose 
+    *          (resized only if its size is not 7 or 6).
+    * @param axisRep if true returns the axis/angle notation. 
+    * @see EndEffPose
+    */
+    void fastEndEffPose(yarp::sig::Vector &x, const bool axisRep=true);
+
     /**
     * Returns the analitical Jacobian of the ith link.
     * @param i is the Link number. 
@@ -759,6 +812,60 @@ public:
     */
     yarp::sig::Matrix GeoJacobian(const yarp::sig::Vector &q);
 
+    /**
+    * Same as AnaJacobian(col) but the result is written into a 
+    * caller-provided matrix without heap allocations (once J is 
+    * 6xDOF). 
+    * @param J is the matrix filled with the analitical Jacobian. 
+    * @param col selects the part of the derived homogeneous matrix 
+    *            to be put in the upper side of the Jacobian
+    *            matrix: 0 => x, 1 => y, 2 => z, 3 => p (default)
+    * @see AnaJacobian
+    */
+    void fastAnaJacobian(yarp::sig::Matrix &J, unsigned int col=3);
+
+    /**
+    * Same as GeoJacobian() but the result is written into a 
+    * caller-provided matrix without heap allocations (once J is 
+    * 6xDOF). 
+    * @param J is the matrix filled with the geometric Jacobian.
+    * @note The blocked links are not considered.
+    * @see GeoJacobian
+    */
+    void fastGeoJacobian(yarp::sig::Matrix &J);
+
+    /**
+    * Computes the end-effector poses for a block of K joint 
+    * configurations at once. The configurations are stored as 
+    * structure-of-arrays, i.e. the ith row of Q holds the values of 
+    * the ith DOF across all the configurations, so that the links 
+    * product is evaluated in lockstep over the whole block by loops 
+    * amenable to vectorization. 
+    * @param Q is the DOFxK matrix of joint configurations (one per 
+    *          column).
+    * @param X is the 7xK (or 6xK) matrix filled with the poses 
+    *          (one per column).
+    * @param axisRep if true returns the axis/angle notation. 
+    * @return true if successful (e.g. Q has DOF rows). 
+    * @note The current joint angles of the chain are not modified, 
+    *       whereas the joint limits are enforced as in setAng().
+    */
+    bool EndEffPose(const yarp::sig::Matrix &Q, yarp::sig::Matrix &X,
+                    const bool axisRep=true);
+
+    /**
+    * Computes the geometric Jacobians of the end-effector for a 
+    * block of K joint configurations at once.
+    * @param Q is the DOFxK matrix of joint configurations (one per 
+    *          column, structure-of-arrays layout).
+    * @param J is the list filled with the K 6xDOF Jacobians. 
+    * @return true if successful (e.g. Q has DOF rows). 
+    * @note The current joint angles of the chain are not modified, 
+    *       whereas the joint limits are enforced as in setAng().
+    * @see EndEffPose(Q,X,axisRep) 
+    */
+    bool GeoJacobian(const yarp::sig::Matrix &Q, std::deque<yarp::sig::Matrix> &J);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
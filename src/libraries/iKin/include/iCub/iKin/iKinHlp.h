@@ -150,6 +150,21 @@ public:
     */
     static bool getTokenOption(const yarp::os::Bottle &b, double *token);
 
+    /**
+    * Retrieves the solver time and the residual attached to the 
+    * reply of an [ask] request. 
+    * @param b is the bottle containing the data to be retrieved. 
+    * @param time is the pointer where to return the time [s] 
+    *             spent by the solver (can be NULL).
+    * @param residual is the pointer where to return the position 
+    *                 error [m] and the orientation error [rad]
+    *                 of the solution (can be NULL).
+    * @return true iff both the properties are present within the 
+    *         bottle b
+    */
+    static bool getSolutionInfoOption(const yarp::os::Bottle &b, double *time,
+                                      yarp::sig::Vector *residual);
+
     /**
     * Retrieves current fixation point given the current kinematics
     * configuration of the eyes. 
@@ -34,6 +34,8 @@
 #ifndef __IKINIPOPT_H__
 #define __IKINIPOPT_H__
 
+#include <deque>
+
 #include <iCub/iKin/iKinInv.h>
 
 
@@ -214,6 +216,7 @@ private:
 
 protected:
     void *App;
+    void *multiStart;
 
     iKinChain &chain;
     iKinChain chain2ndTask;
@@ -230,6 +233,12 @@ protected:
     double upperBoundInf;
     std::string posePriority;
 
+    bool warmStart;
+    bool warmStartValid;
+    yarp::sig::Vector warm_zL;
+    yarp::sig::Vector warm_zU;
+    yarp::sig::Vector warm_lambda;
+
 public:
     /**
     * Constructor. 
@@ -418,6 +427,56 @@ public:
     */
     void setBoundsInf(const double lower, const double upper);
 
+    /**
+    * Enable\disable the warm start of the optimizer (disabled at 
+    * start-up by default). When enabled, the bound multipliers and 
+    * the constraints multipliers found by the last successful call 
+    * to the solve method are used to initialize the next one, 
+    * which typically shortens the convergence when consecutive 
+    * targets are close to each other (e.g. in tracking mode). 
+    * @param enable true if warm start shall be enabled. 
+    * @note The primal variables are always initialized with q0, 
+    *       thus the caller is in charge of providing a good initial
+    *       guess.
+    */
+    void setWarmStart(const bool enable);
+
+    /**
+    * Returns the current warm start status.
+    * @return true iff warm start is enabled.
+    */
+    bool getWarmStart() const { return warmStart; }
+
+    /**
+    * Discards the multipliers stored for the warm start, so that 
+    * the next call to the solve method starts from scratch.
+    */
+    void resetWarmStart() { warmStartValid=false; }
+
+    /**
+    * Configures the multi-start mode, which spreads the 
+    * optimization over a pool of threads each starting from a 
+    * different initial guess (disabled at start-up by default). 
+    * Each thread owns a copy of the chain and of the optimizer. 
+    * The optimizations run concurrently only if the linear solver 
+    * selected through the "linear_solver" option is one of the 
+    * thread-safe HSL solvers (ma27, ma57, ma77, ma86, ma97); with 
+    * any other solver, MUMPS included, they take turns. 
+    * @param numWorkers is the number of threads of the pool; values
+    *                   lower than 2 disable the multi-start mode.
+    * @param budget is the time budget in seconds granted to each 
+    *               multi-start solution; a non positive value
+    *               waits until every thread is done.
+    * @see solveMultiStart
+    */
+    void setMultiStart(const int numWorkers, const double budget=0.0);
+
+    /**
+    * Returns the number of threads used in multi-start mode.
+    * @return the number of threads (0 if the mode is disabled).
+    */
+    int getMultiStart() const;
+
     /**
     * Executes the IpOpt algorithm trying to converge on target. 
     * @param q0 is the vector of initial joint angles values. 
@@ -461,6 +520,28 @@ public:
                                     double weight3rdTask, yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
                                     int *exit_code=NULL, bool *exhalt=NULL, iKinIterateCallback *iterate=NULL);
 
+    /**
+    * Executes the IpOpt algorithm in multi-start mode: one 
+    * optimization instance per initial guess is run concurrently 
+    * and the first one converging within tolerance stops the 
+    * others; if none converges within the time budget, the 
+    * solution with the smallest task error is returned. 
+    * @param q0 is the list of initial joint angles values; guesses
+    *           exceeding the number of threads are discarded.
+    * @param winner stores the index of the initial guess which led 
+    *               to the returned solution (NULL by default).
+    * @note See the solve method for the description of the other 
+    *       parameters. The iteration callback is not supported.
+    *       Falls back to the solve method if the multi-start mode
+    *       is disabled or one guess only is given.
+    * @return estimated joint angles.
+    * @see setMultiStart
+    */
+    virtual yarp::sig::Vector solveMultiStart(const std::deque<yarp::sig::Vector> &q0, yarp::sig::Vector &xd,
+                                              double weight2ndTask, yarp::sig::Vector &xd_2nd, yarp::sig::Vector &w_2nd,
+                                              double weight3rdTask, yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                              int *exit_code=NULL, bool *exhalt=NULL, int *winner=NULL);
+
     /**
     * Executes the IpOpt algorithm trying to converge on target. 
     * @param q0 is the vector of initial joint angles values. 
@@ -180,7 +180,17 @@
  *    configuration q and the pose mode. The reply will contain
  *    something like [ack] ([q] (...)) ([x] (...)), where the
  *    found configuration q is returned as well as the final
- *    attained pose x.
+ *    attained pose x, together with the time spent by the solver
+ *    ([time] t) and the residual ([res] (pos_err ang_err)) in
+ *    [m] and [rad].
+ *  
+ * \b askb request: example [askb] (([xd] (...)) ([q] (...))) 
+ *    (([xd] (...)) ([pose] [xyz])) ... Batch version of [ask]:
+ *    every list carries the options of a single [ask] request
+ *    and they are solved one after the other, letting the
+ *    tracking thread run in between. The reply is
+ *    [ack] followed by one list per request, in the same order,
+ *    each formatted as the reply to [ask].
  *  
  * Commands concerning the thread status: 
  *  
@@ -389,6 +399,22 @@ protected:
     yarp::sig::Vector w_3rdTask;
     yarp::sig::Vector idx_3rdTask;
 
+    struct SolutionCacheEntry
+    {
+        yarp::sig::Vector key;
+        yarp::sig::Vector q;
+    };
+
+    std::deque<SolutionCacheEntry> solCache;
+    size_t        solCacheSize;
+    double        solCachePosRes;
+    double        solCacheAngRes;
+    double        solCacheJntRes;
+    unsigned int  solCacheHits;
+    unsigned int  solCacheMisses;
+
+    std::deque<double> solveTimes;
+
     yarp::os::Event dofEvent;
 
     virtual PartDescriptor *getPartDesc(yarp::os::Searchable &options)=0;
@@ -420,9 +446,16 @@ protected:
     void postDOFHandling();
     void fillDOFInfo(yarp::os::Bottle &reply);
     void send(const yarp::sig::Vector &xd, const yarp::sig::Vector &x, const yarp::sig::Vector &q, double *tok);
+    bool handleAsk(const yarp::os::Bottle &request, yarp::os::Bottle &reply);
     void printInfo(const std::string &typ, const yarp::sig::Vector &xd, const yarp::sig::Vector &x,
                    const yarp::sig::Vector &q, const double t);    
 
+    yarp::sig::Vector getCacheKey(const yarp::sig::Vector &xd);
+    bool lookUpCache(const yarp::sig::Vector &key, yarp::sig::Vector &q);
+    void storeInCache(const yarp::sig::Vector &key, const yarp::sig::Vector &q);
+    void updateSolveTimes(const double t);
+    void getSolveTimesStats(double &median, double &p99);
+
     virtual void prepareJointsRestTask();
     virtual void respond(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
     virtual bool threadInit();
@@ -514,6 +547,36 @@ public:
     *    all intermediate points of optimization instance; allowed
     *    values are [on] or [off].
     *  
+    * \b warm_start <vocab>: example (warm_start on), selects 
+    *    whether to initialize the multipliers of each optimization
+    *    instance with the ones of the previous instance; allowed
+    *    values are [on] or [off] (default).
+    *  
+    * \b cache_size <int>: example (cache_size 32), specifies the 
+    *    number of past solutions kept as initial guesses for targets
+    *    falling in the same cell of the quantized task space; the
+    *    key accounts also for the DOF configuration and the state of
+    *    the uncontrolled joints. Zero (default) disables the cache.
+    *  
+    * \b cache_res <(double double double)>: example (cache_res 
+    *    (0.005 5.0 1.0)), specifies the cache quantization steps
+    *    for the target position [m], the target orientation [deg]
+    *    and the uncontrolled joints [deg].
+    *  
+    * \b multi_start <int>: example (multi_start 3), specifies the
+    *    number of threads used to run concurrently the optimization
+    *    from the cached solution, the current configuration and the
+    *    rest posture; values lower than 2 (default) disable the
+    *    multi-start mode, which is also ignored when interPoints is
+    *    on. The optimizations run concurrently only with a 
+    *    thread-safe HSL linear solver (ma27, ma57, ma77, ma86, 
+    *    ma97); otherwise, e.g. with MUMPS, they take turns.
+    *  
+    * \b multi_start_budget <double>: example (multi_start_budget 
+    *    0.02), specifies in seconds the time granted to the
+    *    multi-start optimization before picking up the best
+    *    solution found so far; zero (default) disables the budget.
+    *  
     * \b ping_robot_tmo <double>: example (ping_robot_tmo 2.0), 
     *    specifies a timeout in seconds during which robot state
     *    ports are pinged prior to connecting; a timeout equal to
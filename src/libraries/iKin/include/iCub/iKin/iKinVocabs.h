@@ -24,6 +24,7 @@
 #define IKINSLV_VOCAB_CMD_GET           VOCAB3('g','e','t')
 #define IKINSLV_VOCAB_CMD_SET           VOCAB3('s','e','t')
 #define IKINSLV_VOCAB_CMD_ASK           VOCAB3('a','s','k')
+#define IKINSLV_VOCAB_CMD_ASK_BATCH     VOCAB4('a','s','k','b')
 #define IKINSLV_VOCAB_CMD_SUSP          VOCAB4('s','u','s','p')
 #define IKINSLV_VOCAB_CMD_RUN           VOCAB3('r','u','n')
 #define IKINSLV_VOCAB_CMD_STATUS        VOCAB4('s','t','a','t')
@@ -38,6 +39,8 @@
 #define IKINSLV_VOCAB_OPT_XD            VOCAB2('x','d')
 #define IKINSLV_VOCAB_OPT_X             VOCAB1('x')
 #define IKINSLV_VOCAB_OPT_Q             VOCAB1('q')
+#define IKINSLV_VOCAB_OPT_TIME          VOCAB4('t','i','m','e')
+#define IKINSLV_VOCAB_OPT_RESIDUAL      VOCAB3('r','e','s')
 #define IKINSLV_VOCAB_OPT_TOKEN         VOCAB3('t','o','k')
 #define IKINSLV_VOCAB_OPT_VERB          VOCAB4('v','e','r','b')
 #define IKINSLV_VOCAB_OPT_REST_POS      VOCAB4('r','e','s','p')
@@ -25,6 +25,9 @@
 
 #include <iCub/iKin/iKinFwd.h>
 
+// number of configurations processed in lockstep by the batched kinematics
+#define BATCH_SIZE      64
+
 using namespace std;
 using namespace yarp::os;
 using namespace yarp::dev;
@@ -34,6 +37,70 @@ using namespace iCub::ctrl;
 using namespace iCub::iKin;
 
 
+/************************************************************************/
+inline void mult4x4(const double *A, const double *B, double *C)
+{
+    // C=A*B over row-major 4x4 storage; C must not alias A or B
+    for (int r=0; r<16; r+=4)
+    {
+        const double a0=A[r], a1=A[r+1], a2=A[r+2], a3=A[r+3];
+        C[r]  =a0*B[0]+a1*B[4]+a2*B[8] +a3*B[12];
+        C[r+1]=a0*B[1]+a1*B[5]+a2*B[9] +a3*B[13];
+        C[r+2]=a0*B[2]+a1*B[6]+a2*B[10]+a3*B[14];
+        C[r+3]=a0*B[3]+a1*B[7]+a2*B[11]+a3*B[15];
+    }
+}
+
+
+/************************************************************************/
+inline void copy4x4(const double *A, double *B)
+{
+    for (int i=0; i<16; i++)
+        B[i]=A[i];
+}
+
+
+/************************************************************************/
+inline void dcm2pose(const double *H, double *x, const bool axisRep)
+{
+    x[0]=H[3];
+    x[1]=H[7];
+    x[2]=H[11];
+
+    if (axisRep)
+    {
+        double v0=H[9]-H[6];
+        double v1=H[2]-H[8];
+        double v2=H[4]-H[1];
+        double r=sqrt(v0*v0+v1*v1+v2*v2);
+
+        // rotations of 0 or 180 deg: rely on the general purpose
+        // yarp implementation which is allocation-free only here
+        if (r<1e-9)
+        {
+            Matrix R(4,4);
+            copy4x4(H,R.data());
+            Vector ax=dcm2axis(R);
+            x[3]=ax[0]; x[4]=ax[1]; x[5]=ax[2]; x[6]=ax[3];
+        }
+        else
+        {
+            x[3]=v0/r;
+            x[4]=v1/r;
+            x[5]=v2/r;
+            x[6]=atan2(0.5*r,0.5*(H[0]+H[5]+H[10]-1.0));
+        }
+    }
+    else
+    {
+        // Euler Angles as XYZ (see iKinChain::RotAng())
+        x[3]=atan2(-H[9],H[10]);
+        x[4]=asin(H[8]);
+        x[5]=atan2(-H[4],H[0]);
+    }
+}
+
+
 /************************************************************************/
 void iCub::iKin::notImplemented(const unsigned int verbose)
 {
@@ -62,6 +129,7 @@ iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
     cumulative =false;
     constrained=true;
     verbose    =0;
+    stamp      =0;
 
     H.resize(4,4);
     H.zero();
@@ -99,11 +167,13 @@ void iKinLink::clone(const iKinLink &l)
     H   =l.H;
     cumH=l.cumH;
     DnH =l.DnH;
+
+    stamp++;
 }
 
 
 /************************************************************************/
-iKinLink::iKinLink(const iKinLink &l)
+iKinLink::iKinLink(const iKinLink &l) : stamp(0)
 {
     clone(l);
 }
@@ -124,7 +194,10 @@ void iKinLink::setMin(const double _Min)
     Min=_Min;
 
     if (Ang<Min)
+    {
         Ang=Min;
+        stamp++;
+    }
 }
 
 
@@ -134,7 +207,10 @@ void iKinLink::setMax(const double _Max)
     Max=_Max;
 
     if (Ang>Max)
+    {
         Ang=Max;
+        stamp++;
+    }
 }
 
 
@@ -142,6 +218,7 @@ void iKinLink::setMax(const double _Max)
 void iKinLink::setD(const double _D)
 {
     H(2,3)=D=_D;
+    stamp++;
 }
 
 
@@ -152,6 +229,7 @@ void iKinLink::setAlpha(const double _Alpha)
 
     H(2,2)=c_alpha=cos(Alpha);
     H(2,1)=s_alpha=sin(Alpha);
+    stamp++;
 }
 
 
@@ -160,10 +238,15 @@ double iKinLink::setAng(double _Ang)
 {
     if (!blocked)
     {
+        double prevAng=Ang;
+
         if (constrained)
             Ang=(_Ang<Min) ? Min : ((_Ang>Max) ? Max : _Ang);
         else
             Ang=_Ang;
+
+        if (Ang!=prevAng)
+            stamp++;
     }
     else if (verbose)
         yWarning("Attempt to set joint angle to %g while blocked",_Ang);
@@ -259,11 +342,50 @@ void iKinLink::addCumH(const Matrix &_cumH)
 }
 
 
+/************************************************************************/
+void iKinLink::fillH(double *_H, bool c_override)
+{
+    double theta=Ang+Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    double L[16]={ c_theta, -s_theta*c_alpha,  s_theta*s_alpha, c_theta*A,
+                   s_theta,  c_theta*c_alpha, -c_theta*s_alpha, s_theta*A,
+                   0.0,      s_alpha,          c_alpha,         D,
+                   0.0,      0.0,              0.0,             1.0 };
+
+    if (cumulative && !c_override)
+        mult4x4(cumH.data(),L,_H);
+    else
+        copy4x4(L,_H);
+}
+
+
+/************************************************************************/
+void iKinLink::fillDnH(double *_DnH, bool c_override)
+{
+    double theta=Ang+Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    double L[16]={ -s_theta, -c_theta*c_alpha, c_theta*s_alpha, -s_theta*A,
+                    c_theta, -s_theta*c_alpha, s_theta*s_alpha,  c_theta*A,
+                    0.0,      0.0,             0.0,              0.0,
+                    0.0,      0.0,             0.0,              0.0 };
+
+    if (cumulative && !c_override)
+        mult4x4(cumH.data(),L,_DnH);
+    else
+        copy4x4(L,_DnH);
+}
+
+
 /************************************************************************/
 iKinChain::iKinChain()
 {
     N=DOF=verbose=0;
     H0=HN=eye(4,4);
+    fkValid=0;
 }
 
 
@@ -283,6 +405,8 @@ void iKinChain::clone(const iKinChain &c)
     quickList.assign(c.quickList.begin(),c.quickList.end());
     hash.assign(c.hash.begin(),c.hash.end());
     hash_dof.assign(c.hash_dof.begin(),c.hash_dof.end());
+
+    fkValid=0;
 }
 
 
@@ -366,6 +490,7 @@ void iKinChain::clear()
 
     N=DOF=0;
     H0=HN=eye(4,4);
+    fkValid=0;
 }
 
 
@@ -562,6 +687,8 @@ void iKinChain::build()
 
     if (DOF>0)
         curr_q.resize(DOF,0);
+
+    fkValid=0;
 }
 
 
@@ -571,6 +698,7 @@ bool iKinChain::setH0(const Matrix &_H0)
     if ((_H0.rows()==4) && (_H0.cols()==4))
     {
         H0=_H0;
+        fkValid=0;
         return true;
     }
     else
@@ -662,6 +790,47 @@ double iKinChain::getAng(const unsigned int i)
 }
 
 
+/************************************************************************/
+const double *iKinChain::updateFKCache()
+{
+    size_t sz=16*(N+1);
+    if (fkCache.size()!=sz)
+    {
+        fkCache.resize(sz);
+        fkStamps.resize(N);
+        fkValid=0;
+    }
+
+    if (fkValid==0)
+    {
+        copy4x4(H0.data(),&fkCache[0]);
+        fkValid=1;
+    }
+
+    // find the first link modified since the last update:
+    // only the subsequent frames need to be recomputed
+    for (unsigned int i=0; i+1<fkValid; i++)
+    {
+        if (allList[i]->stamp!=fkStamps[i])
+        {
+            fkValid=i+1;
+            break;
+        }
+    }
+
+    double L[16];
+    for (unsigned int i=fkValid-1; i<N; i++)
+    {
+        allList[i]->fillH(L,true);
+        mult4x4(&fkCache[16*i],L,&fkCache[16*(i+1)]);
+        fkStamps[i]=allList[i]->stamp;
+    }
+
+    fkValid=N+1;
+    return &fkCache[0];
+}
+
+
 /************************************************************************/
 Vector iKinChain::RotAng(const Matrix &R)
 {
@@ -738,41 +907,36 @@ Vector iKinChain::d2RotAng(const Matrix &R, const Matrix &dRi,
 /************************************************************************/
 Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 {
-    Matrix H=H0;
-    unsigned int _i,n;
-    deque<iKinLink*> *l;
-    bool cumulHN=false;
-    bool c_override;
-
     if (allLink)
     {
-        n=N;
-        l=&allList;
-        c_override=true;
+        yAssert(i<N);
 
-        _i=i;
-        if (_i>=N-1)
-            cumulHN=true;
-    }
-    else
-    {
-        n=DOF;
-        l=&quickList;
-        c_override=false;
+        const double *fk=updateFKCache();
+        Matrix H(4,4);
+        copy4x4(fk+16*(i+1),H.data());
 
-        if (i==DOF)
-            _i=quickList.size();
-        else
-            _i=i;
+        if (i>=N-1)
+            H*=HN;
 
-        if (hash[_i]>=N-1)
-            cumulHN=true;
+        return H;
     }
 
-    yAssert(i<n);
+    Matrix H=H0;
+    unsigned int _i;
+    bool cumulHN=false;
+
+    if (i==DOF)
+        _i=quickList.size();
+    else
+        _i=i;
+
+    if (hash[_i]>=N-1)
+        cumulHN=true;
+
+    yAssert(i<DOF);
 
     for (unsigned int j=0; j<=_i; j++)
-        H*=((*l)[j]->getH(c_override));
+        H*=quickList[j]->getH();
 
     if (cumulHN)
         H*=HN;
@@ -784,15 +948,11 @@ Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 /************************************************************************/
 Matrix iKinChain::getH()
 {
-    // may be different from DOF since one blocked link may lie
-    // at the end of the chain.
-    unsigned int n=quickList.size();
-    Matrix H=H0;
-
-    for (unsigned int i=0; i<n; i++)
-        H*=quickList[i]->getH();
+    const double *fk=updateFKCache();
+    Matrix H(4,4);
+    mult4x4(fk+16*N,HN.data(),H.data());
 
-    return H*HN;
+    return H;
 }
 
 
@@ -806,6 +966,17 @@ Matrix iKinChain::getH(const Vector &q)
 }
 
 
+/************************************************************************/
+void iKinChain::fastGetH(Matrix &H)
+{
+    if ((H.rows()!=4) || (H.cols()!=4))
+        H.resize(4,4);
+
+    const double *fk=updateFKCache();
+    mult4x4(fk+16*N,HN.data(),H.data());
+}
+
+
 /************************************************************************/
 Vector iKinChain::Pose(const unsigned int i, const bool axisRep)
 {
@@ -897,6 +1068,145 @@ Vector iKinChain::EndEffPose(const Vector &q, const bool axisRep)
 }
 
 
+/************************************************************************/
+void iKinChain::fastEndEffPose(Vector &x, const bool axisRep)
+{
+    size_t len=axisRep ? 7 : 6;
+    if (x.length()!=len)
+        x.resize(len);
+
+    const double *fk=updateFKCache();
+    double H[16];
+    mult4x4(fk+16*N,HN.data(),H);
+    dcm2pose(H,x.data(),axisRep);
+}
+
+
+/************************************************************************/
+void iKinChain::batchFwdKin(const Matrix &Q, const int k0, const int nk,
+                            double *T, double *ZP)
+{
+    // T holds the upper 3x4 part of the roto-translation matrices
+    // in structure-of-arrays form: T[e*BATCH_SIZE+k], e=4*row+col
+    const double *h0=H0.data();
+    for (int e=0; e<12; e++)
+        for (int k=0; k<nk; k++)
+            T[e*BATCH_SIZE+k]=h0[e];
+
+    double c[BATCH_SIZE],s[BATCH_SIZE];
+    unsigned int d=0;
+
+    for (unsigned int i=0; i<N; i++)
+    {
+        iKinLink *l=allList[i];
+
+        if ((d<DOF) && (hash[d]==i))
+        {
+            // park z-axis and origin of the frame preceding the DOF
+            if (ZP!=NULL)
+            {
+                double *zp=ZP+6*d*BATCH_SIZE;
+                const int src[6]={2,6,10,3,7,11};
+                for (int e=0; e<6; e++)
+                    for (int k=0; k<nk; k++)
+                        zp[e*BATCH_SIZE+k]=T[src[e]*BATCH_SIZE+k];
+            }
+
+            const double *q=Q[d]+k0;
+            const double Min=l->Min, Max=l->Max;
+            for (int k=0; k<nk; k++)
+            {
+                double theta=q[k];
+                if (l->constrained)
+                    theta=(theta<Min) ? Min : ((theta>Max) ? Max : theta);
+
+                theta+=l->Offset;
+                c[k]=cos(theta);
+                s[k]=sin(theta);
+            }
+
+            d++;
+        }
+        else
+        {
+            double theta=l->Ang+l->Offset;
+            double c_theta=cos(theta);
+            double s_theta=sin(theta);
+            for (int k=0; k<nk; k++)
+            {
+                c[k]=c_theta;
+                s[k]=s_theta;
+            }
+        }
+
+        // T=T*H_i exploiting the structure of the DH matrix
+        const double ca=l->c_alpha, sa=l->s_alpha;
+        const double A=l->A, D=l->D;
+        for (int r=0; r<3; r++)
+        {
+            double *t0=T+4*r*BATCH_SIZE;
+            double *t1=t0+BATCH_SIZE;
+            double *t2=t1+BATCH_SIZE;
+            double *t3=t2+BATCH_SIZE;
+
+            for (int k=0; k<nk; k++)
+            {
+                double a=t0[k]*c[k]+t1[k]*s[k];
+                double b=t1[k]*c[k]-t0[k]*s[k];
+                double z=t2[k];
+
+                t0[k]=a;
+                t1[k]=ca*b+sa*z;
+                t2[k]=ca*z-sa*b;
+                t3[k]+=A*a+D*z;
+            }
+        }
+    }
+}
+
+
+/************************************************************************/
+bool iKinChain::EndEffPose(const Matrix &Q, Matrix &X, const bool axisRep)
+{
+    if ((DOF==0) || (Q.rows()!=(int)DOF))
+    {
+        if (verbose)
+            yError("EndEffPose() failed due to wrong configurations size: %d!=%d",Q.rows(),DOF);
+
+        return false;
+    }
+
+    int K=Q.cols();
+    int rows=axisRep ? 7 : 6;
+    if ((X.rows()!=rows) || (X.cols()!=K))
+        X.resize(rows,K);
+
+    double T[12*BATCH_SIZE];
+    double G[16]={0.0,0.0,0.0,0.0, 0.0,0.0,0.0,0.0, 0.0,0.0,0.0,0.0, 0.0,0.0,0.0,1.0};
+    double H[16],x[7];
+
+    for (int k0=0; k0<K; k0+=BATCH_SIZE)
+    {
+        int nk=std::min(BATCH_SIZE,K-k0);
+        batchFwdKin(Q,k0,nk,T,NULL);
+
+        for (int k=0; k<nk; k++)
+        {
+            for (int e=0; e<12; e++)
+                G[e]=T[e*BATCH_SIZE+k];
+
+            mult4x4(G,HN.data(),H);
+            dcm2pose(H,x,axisRep);
+
+            for (int r=0; r<rows; r++)
+                X(r,k0+k)=x[r];
+        }
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 Vector iKinChain::EndEffPosition()
 {
@@ -1015,36 +1325,85 @@ Matrix iKinChain::AnaJacobian(const Vector &q, unsigned int col)
 }
 
 
+/************************************************************************/
+void iKinChain::fastAnaJacobian(Matrix &J, unsigned int col)
+{
+    yAssert(DOF>0);
+
+    col=col>3 ? 3 : col;
+
+    if ((J.rows()!=6) || (J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    // may be different from DOF since one blocked link may lie
+    // at the end of the chain.
+    unsigned int n=quickList.size();
+    double bufH[2][16],bufdH[2][16],L[16],dL[16];
+    double *H,*dH;
+
+    for (unsigned int i=0; i<DOF; i++)
+    {
+        int k=0;
+        copy4x4(H0.data(),bufH[k]);
+        copy4x4(H0.data(),bufdH[k]);
+
+        for (unsigned int j=0; j<n; j++)
+        {
+            quickList[j]->fillH(L);
+            mult4x4(bufH[k],L,bufH[1-k]);
+
+            if (hash_dof[i]==j)
+            {
+                quickList[j]->fillDnH(dL);
+                mult4x4(bufdH[k],dL,bufdH[1-k]);
+            }
+            else
+                mult4x4(bufdH[k],L,bufdH[1-k]);
+
+            k=1-k;
+        }
+
+        H=bufH[1-k];
+        dH=bufdH[1-k];
+        mult4x4(bufH[k],HN.data(),H);
+        mult4x4(bufdH[k],HN.data(),dH);
+
+        // see iKinChain::dRotAng()
+        J(0,i)=dH[col];
+        J(1,i)=dH[4+col];
+        J(2,i)=dH[8+col];
+        J(3,i)=(H[9]*dH[10]-H[10]*dH[9])/(H[9]*H[9]+H[10]*H[10]);
+        J(4,i)=dH[8]/sqrt(fabs(1.0-H[8]*H[8]));
+        J(5,i)=(H[4]*dH[0]-H[0]*dH[4])/(H[4]*H[4]+H[0]*H[0]);
+    }
+}
+
+
 /************************************************************************/
 Matrix iKinChain::GeoJacobian(const unsigned int i)
 {
     yAssert(i<N);
 
     Matrix J(6,i+1);
-    Matrix PN,Z;
-    Vector w;
+    const double *fk=updateFKCache();
+    double PN[16];
 
-    deque<Matrix> intH;
-    intH.push_back(H0);
-
-    for (unsigned int j=0; j<=i; j++)
-        intH.push_back(intH[j]*allList[j]->getH(true));
-
-    PN=intH[i+1];
     if (i>=N-1)
-        PN=PN*HN;
+        mult4x4(fk+16*(i+1),HN.data(),PN);
+    else
+        copy4x4(fk+16*(i+1),PN);
 
     for (unsigned int j=0; j<=i; j++)
     {
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
+        const double *Z=fk+16*j;
+        double p0=PN[3]-Z[3], p1=PN[7]-Z[7], p2=PN[11]-Z[11];
 
-        J(0,j)=w[0];
-        J(1,j)=w[1];
-        J(2,j)=w[2];
-        J(3,j)=Z(0,2);
-        J(4,j)=Z(1,2);
-        J(5,j)=Z(2,2);
+        J(0,j)=Z[6]*p2-Z[10]*p1;
+        J(1,j)=Z[10]*p0-Z[2]*p2;
+        J(2,j)=Z[2]*p1-Z[6]*p0;
+        J(3,j)=Z[2];
+        J(4,j)=Z[6];
+        J(5,j)=Z[10];
     }
 
     return J;
@@ -1056,44 +1415,104 @@ Matrix iKinChain::GeoJacobian()
 {
     yAssert(DOF>0);
 
-    Matrix J(6,DOF);
-    Matrix PN,Z;
-    Vector w;
+    Matrix J;
+    fastGeoJacobian(J);
+
+    return J;
+}
 
-    deque<Matrix> intH;
-    intH.push_back(H0);
 
-    for (unsigned int i=0; i<N; i++)
-        intH.push_back(intH[i]*allList[i]->getH(true));
+/************************************************************************/
+Matrix iKinChain::GeoJacobian(const Vector &q)
+{
+    yAssert(DOF>0);
+
+    setAng(q);
+    return GeoJacobian();
+}
 
-    PN=intH[N]*HN;
+
+/************************************************************************/
+void iKinChain::fastGeoJacobian(Matrix &J)
+{
+    yAssert(DOF>0);
+
+    if ((J.rows()!=6) || (J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    const double *fk=updateFKCache();
+    double PN[16];
+    mult4x4(fk+16*N,HN.data(),PN);
 
     for (unsigned int i=0; i<DOF; i++)
     {
-        unsigned int j=hash[i];
+        const double *Z=fk+16*hash[i];
+        double p0=PN[3]-Z[3], p1=PN[7]-Z[7], p2=PN[11]-Z[11];
 
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
-
-        J(0,i)=w[0];
-        J(1,i)=w[1];
-        J(2,i)=w[2];
-        J(3,i)=Z(0,2);
-        J(4,i)=Z(1,2);
-        J(5,i)=Z(2,2);
+        J(0,i)=Z[6]*p2-Z[10]*p1;
+        J(1,i)=Z[10]*p0-Z[2]*p2;
+        J(2,i)=Z[2]*p1-Z[6]*p0;
+        J(3,i)=Z[2];
+        J(4,i)=Z[6];
+        J(5,i)=Z[10];
     }
-
-    return J;
 }
 
 
 /************************************************************************/
-Matrix iKinChain::GeoJacobian(const Vector &q)
+bool iKinChain::GeoJacobian(const Matrix &Q, deque<Matrix> &J)
 {
-    yAssert(DOF>0);
+    if ((DOF==0) || (Q.rows()!=(int)DOF))
+    {
+        if (verbose)
+            yError("GeoJacobian() failed due to wrong configurations size: %d!=%d",Q.rows(),DOF);
 
-    setAng(q);
-    return GeoJacobian();
+        return false;
+    }
+
+    int K=Q.cols();
+    J.resize(K);
+
+    double T[12*BATCH_SIZE];
+    vector<double> ZP(6*DOF*BATCH_SIZE);
+    const double *hn=HN.data();
+
+    for (int k0=0; k0<K; k0+=BATCH_SIZE)
+    {
+        int nk=std::min(BATCH_SIZE,K-k0);
+        batchFwdKin(Q,k0,nk,T,&ZP[0]);
+
+        for (int k=0; k<nk; k++)
+        {
+            Matrix &Jk=J[k0+k];
+            if ((Jk.rows()!=6) || (Jk.cols()!=(int)DOF))
+                Jk.resize(6,DOF);
+
+            // end-effector position: R*pHN+p
+            double pN[3];
+            for (int r=0; r<3; r++)
+                pN[r]=T[(4*r)*BATCH_SIZE+k]*hn[3]+T[(4*r+1)*BATCH_SIZE+k]*hn[7]+
+                      T[(4*r+2)*BATCH_SIZE+k]*hn[11]+T[(4*r+3)*BATCH_SIZE+k];
+
+            for (unsigned int i=0; i<DOF; i++)
+            {
+                const double *zp=&ZP[6*i*BATCH_SIZE+k];
+                double z0=zp[0], z1=zp[BATCH_SIZE], z2=zp[2*BATCH_SIZE];
+                double p0=pN[0]-zp[3*BATCH_SIZE];
+                double p1=pN[1]-zp[4*BATCH_SIZE];
+                double p2=pN[2]-zp[5*BATCH_SIZE];
+
+                Jk(0,i)=z1*p2-z2*p1;
+                Jk(1,i)=z2*p0-z0*p2;
+                Jk(2,i)=z0*p1-z1*p0;
+                Jk(3,i)=z0;
+                Jk(4,i)=z1;
+                Jk(5,i)=z2;
+            }
+        }
+    }
+
+    return true;
 }
 
 
@@ -187,6 +187,32 @@ bool CartesianHelper::getTokenOption(const Bottle &b, double *token)
 }
 
 
+/************************************************************************/
+bool CartesianHelper::getSolutionInfoOption(const Bottle &b, double *time,
+                                            Vector *residual)
+{
+    if (!b.check(Vocab::decode(IKINSLV_VOCAB_OPT_TIME)) ||
+        !b.check(Vocab::decode(IKINSLV_VOCAB_OPT_RESIDUAL)))
+        return false;
+
+    if (time!=NULL)
+        *time=b.find(Vocab::decode(IKINSLV_VOCAB_OPT_TIME)).asDouble();
+
+    if (residual!=NULL)
+    {
+        Bottle *resData=b.find(Vocab::decode(IKINSLV_VOCAB_OPT_RESIDUAL)).asList();
+        if (resData==NULL)
+            return false;
+
+        residual->resize(resData->size());
+        for (size_t i=0; i<residual->length(); i++)
+            (*residual)[i]=resData->get(i).asDouble();
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 bool CartesianHelper::computeFixationPointData(iKinChain &eyeL,
                                                iKinChain &eyeR,
@@ -17,13 +17,23 @@
 */
 
 #include <limits>
+#include <deque>
+#include <algorithm>
 
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
 
+#include <yarp/os/Log.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/Time.h>
+
 #include <iCub/iKin/iKinIpOpt.h>
 
 #define CAST_IPOPTAPP(x)                    (static_cast<IpoptApplication*>(x))
+#define CAST_MSPOOL(x)                      (static_cast<iKinMultiStartPool*>(x))
+#define IKINIPOPT_MULTISTART_POLL           0.002   // [s]
 #define IKINIPOPT_SHOULDER_MAXABDUCTION     (100.0*CTRL_DEG2RAD)
 
 using namespace std;
@@ -279,8 +289,14 @@ protected:
 
     iKinIterateCallback *callback;
 
+    yarp::sig::Vector *warm_zL;
+    yarp::sig::Vector *warm_zU;
+    yarp::sig::Vector *warm_lambda;
+    bool              *warmValid;
+
     double weight2ndTask;
     double weight3rdTask;
+    double taskErr;
     bool   firstGo;
 
     /************************************************************************/
@@ -419,11 +435,29 @@ public:
         upperBoundInf=std::numeric_limits<double>::max();
 
         callback=NULL;
+
+        warm_zL=warm_zU=warm_lambda=NULL;
+        warmValid=NULL;
+
+        taskErr=0.0;
     }
 
     /************************************************************************/
     yarp::sig::Vector get_qd() { return qd; }
 
+    /************************************************************************/
+    double get_task_error() const { return taskErr; }
+
+    /************************************************************************/
+    void set_warm_start(yarp::sig::Vector *_zL, yarp::sig::Vector *_zU,
+                        yarp::sig::Vector *_lambda, bool *_valid)
+    {
+        warm_zL=_zL;
+        warm_zU=_zU;
+        warm_lambda=_lambda;
+        warmValid=_valid;
+    }
+
     /************************************************************************/
     void set_callback(iKinIterateCallback *_callback) { callback=_callback; }
 
@@ -548,6 +582,27 @@ public:
         for (Index i=0; i<n; i++)
             x[i]=q0[i];
 
+        // multipliers are requested only upon warm start:
+        // reuse the ones of the previous solution if they
+        // are compatible with the current problem
+        bool warm=(warmValid!=NULL) && *warmValid &&
+                  ((int)warm_zL->length()==n) && ((int)warm_lambda->length()==m);
+
+        if (init_z)
+        {
+            for (Index i=0; i<n; i++)
+            {
+                z_L[i]=warm?(*warm_zL)[i]:1.0;
+                z_U[i]=warm?(*warm_zU)[i]:1.0;
+            }
+        }
+
+        if (init_lambda)
+        {
+            for (Index i=0; i<m; i++)
+                lambda[i]=warm?(*warm_lambda)[i]:0.0;
+        }
+
         return true;
     }
     
@@ -781,7 +836,30 @@ public:
         for (Index i=0; i<n; i++)
             qd[i]=x[i];
 
+        computeQuantities(x);
+        taskErr=norm(*e_1st)+norm(*e_cst);
+
         qd=chain.setAng(qd);
+
+        // store multipliers for the next warm start
+        if (warmValid!=NULL)
+        {
+            *warmValid=(status==SUCCESS) || (status==STOP_AT_ACCEPTABLE_POINT);
+            if (*warmValid)
+            {
+                warm_zL->resize(n); warm_zU->resize(n);
+                warm_lambda->resize(m);
+
+                for (Index i=0; i<n; i++)
+                {
+                    (*warm_zL)[i]=z_L[i];
+                    (*warm_zU)[i]=z_U[i];
+                }
+
+                for (Index i=0; i<m; i++)
+                    (*warm_lambda)[i]=lambda[i];
+            }
+        }
     }
 
     /************************************************************************/
@@ -789,6 +867,275 @@ public:
 };
 
 
+
+/************************************************************************/
+struct iKinMultiStartPool;
+
+
+/************************************************************************/
+class iKinMultiStartWorker : public yarp::os::Thread
+{
+private:
+    // Copy constructor: not implemented.
+    iKinMultiStartWorker(const iKinMultiStartWorker&);
+    // Assignment operator: not implemented.
+    iKinMultiStartWorker &operator=(const iKinMultiStartWorker&);
+
+protected:
+    iKinMultiStartPool &pool;
+    int                 id;
+
+    deque<iKinLink*>    links;
+    yarp::os::Semaphore job;
+
+    /************************************************************************/
+    void disposeLinks()
+    {
+        chain.clear();
+        chain2ndTask.clear();
+
+        for (size_t i=0; i<links.size(); i++)
+            delete links[i];
+
+        links.clear();
+    }
+
+public:
+    IpoptApplication *App;
+
+    iKinChain chain;
+    iKinChain chain2ndTask;
+
+    iKinLinIneqConstr *pLIC;
+    unsigned int       ctrlPose;
+    string             posePriority;
+
+    double obj_scaling;
+    double x_scaling;
+    double g_scaling;
+    double lowerBoundInf;
+    double upperBoundInf;
+
+    yarp::sig::Vector q0;
+    yarp::sig::Vector xd;
+    yarp::sig::Vector xd_2nd;
+    yarp::sig::Vector w_2nd;
+    yarp::sig::Vector qd_3rd;
+    yarp::sig::Vector w_3rd;
+    double            weight2ndTask;
+    double            weight3rdTask;
+
+    yarp::sig::Vector       qd;
+    ApplicationReturnStatus status;
+    double                  taskErr;
+
+    /************************************************************************/
+    iKinMultiStartWorker(iKinMultiStartPool &_pool, const int _id) :
+                         pool(_pool), id(_id), job(0)
+    {
+        App=new IpoptApplication();
+        App->Initialize();
+
+        pLIC=NULL;
+        status=Internal_Error;
+        taskErr=0.0;
+    }
+
+    /************************************************************************/
+    void cloneChain(iKinChain &c, const unsigned int n2nd)
+    {
+        // the links are allocated only when the structure
+        // of the chain changes; otherwise, their parameters,
+        // limits and angles are copied in place
+        bool rebuild=(links.size()!=c.getN()) || (chain2ndTask.getN()!=n2nd);
+        for (unsigned int i=0; !rebuild && (i<c.getN()); i++)
+            rebuild=(links[i]->isBlocked()!=c[i].isBlocked());
+
+        if (rebuild)
+        {
+            // each worker owns its links, so that the
+            // chains can be moved concurrently
+            disposeLinks();
+            for (unsigned int i=0; i<c.getN(); i++)
+            {
+                iKinLink *l=new iKinLink(c[i]);
+                links.push_back(l);
+                chain<<*l;
+            }
+
+            for (unsigned int i=0; i<n2nd; i++)
+                chain2ndTask<<*links[i];
+        }
+        else for (unsigned int i=0; i<c.getN(); i++)
+            *links[i]=c[i];
+
+        chain.setH0(c.getH0());
+        chain.setHN(c.getHN());
+
+        chain2ndTask.setH0(c.getH0());
+        if (n2nd==c.getN())
+            chain2ndTask.setHN(c.getHN());
+    }
+
+    /************************************************************************/
+    void post() { job.post(); }
+
+    /************************************************************************/
+    void onStop() { job.post(); }
+
+    /************************************************************************/
+    void run();
+
+    /************************************************************************/
+    virtual ~iKinMultiStartWorker()
+    {
+        disposeLinks();
+        delete App;
+    }
+};
+
+
+/************************************************************************/
+struct iKinMultiStartPool
+{
+    deque<iKinMultiStartWorker*> workers;
+    yarp::os::Semaphore          done;
+    yarp::os::Mutex              mutex;
+    yarp::os::Mutex              solverMutex;
+    double                       budget;
+    bool                         halt;
+    bool                         serialize;
+    bool                         serializeWarned;
+    int                          first;
+
+    /************************************************************************/
+    iKinMultiStartPool(const int n, const double _budget) : done(0)
+    {
+        budget=_budget;
+        halt=false;
+        serialize=true;
+        serializeWarned=false;
+        first=-1;
+
+        for (int i=0; i<n; i++)
+        {
+            workers.push_back(new iKinMultiStartWorker(*this,i));
+            workers.back()->start();
+        }
+    }
+
+    /************************************************************************/
+    void setHalt(const bool sw)
+    {
+        mutex.lock();
+        halt=sw;
+        mutex.unlock();
+    }
+
+    /************************************************************************/
+    bool isHalted()
+    {
+        mutex.lock();
+        bool ret=halt;
+        mutex.unlock();
+
+        return ret;
+    }
+
+    /************************************************************************/
+    ~iKinMultiStartPool()
+    {
+        for (size_t i=0; i<workers.size(); i++)
+        {
+            workers[i]->stop();
+            delete workers[i];
+        }
+    }
+};
+
+
+/************************************************************************/
+class iKinMultiStart_NLP : public iKin_NLP
+{
+protected:
+    iKinMultiStartPool &pool;
+
+public:
+    /************************************************************************/
+    iKinMultiStart_NLP(iKinMultiStartWorker &w, iKinMultiStartPool &_pool) :
+                       iKin_NLP(w.chain,w.ctrlPose,w.q0,w.xd,
+                                w.weight2ndTask,w.chain2ndTask,w.xd_2nd,w.w_2nd,
+                                w.weight3rdTask,w.qd_3rd,w.w_3rd,*w.pLIC),
+                       pool(_pool) { }
+
+    /************************************************************************/
+    bool intermediate_callback(AlgorithmMode mode, Index iter, Number obj_value,
+                               Number inf_pr, Number inf_du, Number mu, Number d_norm,
+                               Number regularization_size, Number alpha_du, Number alpha_pr,
+                               Index ls_trials, const IpoptData* ip_data,
+                               IpoptCalculatedQuantities* ip_cq)
+    {
+        // the halt flag is shared among the workers
+        return !pool.isHalted();
+    }
+};
+
+
+/************************************************************************/
+static bool isThreadSafeLinearSolver(const string &solver)
+{
+    // the HSL solvers keep no global state, whereas e.g.
+    // the sequential MUMPS relies on a non reentrant MPI stub
+    return ((solver=="ma27") || (solver=="ma57") || (solver=="ma77") ||
+            (solver=="ma86") || (solver=="ma97"));
+}
+
+
+/************************************************************************/
+void iKinMultiStartWorker::run()
+{
+    while (true)
+    {
+        job.wait();
+        if (isStopping())
+            break;
+
+        SmartPtr<iKinMultiStart_NLP> nlp=new iKinMultiStart_NLP(*this,pool);
+
+        nlp->set_scaling(obj_scaling,x_scaling,g_scaling);
+        nlp->set_bound_inf(lowerBoundInf,upperBoundInf);
+        nlp->set_posePriority(posePriority);
+
+        // a linear solver which is not reentrant
+        // requires the optimizations to take turns
+        if (pool.serialize)
+            pool.solverMutex.lock();
+
+        status=App->OptimizeTNLP(GetRawPtr(nlp));
+
+        if (pool.serialize)
+            pool.solverMutex.unlock();
+
+        qd=nlp->get_qd();
+        taskErr=nlp->get_task_error();
+
+        // the first solution within tolerance stops the others
+        if ((status==Solve_Succeeded) || (status==Solved_To_Acceptable_Level))
+        {
+            pool.mutex.lock();
+            if (pool.first<0)
+            {
+                pool.first=id;
+                pool.halt=true;
+            }
+            pool.mutex.unlock();
+        }
+
+        pool.done.post();
+    }
+}
+
+
 /************************************************************************/
 iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const double tol,
                            const double constr_tol, const int max_iter,
@@ -798,6 +1145,8 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     ctrlPose=_ctrlPose;
     posePriority="position";
     pLIC=&noLIC;
+    warmStart=warmStartValid=false;
+    multiStart=NULL;
 
     if (ctrlPose>IKINCTRL_POSE_ANG)
         ctrlPose=IKINCTRL_POSE_ANG;
@@ -1023,6 +1372,25 @@ void iKinIpOptMin::setBoundsInf(const double lower, const double upper)
 }
 
 
+/************************************************************************/
+void iKinIpOptMin::setWarmStart(const bool enable)
+{
+    if (enable)
+    {
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_bound_push",1e-6);
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_mult_bound_push",1e-6);
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_slack_bound_push",1e-6);
+    }
+    else
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point","no");
+
+    CAST_IPOPTAPP(App)->Initialize();
+
+    warmStart=enable;
+    warmStartValid=false;
+}
+
+
 /************************************************************************/
 yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                       double weight2ndTask, yarp::sig::Vector &xd_2nd,
@@ -1040,6 +1408,15 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
     nlp->set_posePriority(posePriority);
     nlp->set_callback(iterate);
 
+    if (warmStart)
+    {
+        // IpOpt asks for the multipliers only if instructed to do so,
+        // which makes sense only when a previous solution is available
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point",
+                                                      warmStartValid?"yes":"no");
+        nlp->set_warm_start(&warm_zL,&warm_zU,&warm_lambda,&warmStartValid);
+    }
+
     ApplicationReturnStatus status=CAST_IPOPTAPP(App)->OptimizeTNLP(GetRawPtr(nlp));
 
     if (exit_code!=NULL)
@@ -1049,6 +1426,126 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
 }
 
 
+/************************************************************************/
+void iKinIpOptMin::setMultiStart(const int numWorkers, const double budget)
+{
+    delete CAST_MSPOOL(multiStart);
+    multiStart=NULL;
+
+    if (numWorkers>1)
+        multiStart=new iKinMultiStartPool(numWorkers,budget);
+}
+
+
+/************************************************************************/
+int iKinIpOptMin::getMultiStart() const
+{
+    return (multiStart!=NULL)?(int)CAST_MSPOOL(multiStart)->workers.size():0;
+}
+
+
+/************************************************************************/
+yarp::sig::Vector iKinIpOptMin::solveMultiStart(const std::deque<yarp::sig::Vector> &q0,
+                                                yarp::sig::Vector &xd,
+                                                double weight2ndTask, yarp::sig::Vector &xd_2nd,
+                                                yarp::sig::Vector &w_2nd, double weight3rdTask,
+                                                yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                                int *exit_code, bool *exhalt, int *winner)
+{
+    iKinMultiStartPool *pool=CAST_MSPOOL(multiStart);
+    size_t n=(pool!=NULL)?std::min(q0.size(),pool->workers.size()):0;
+
+    if (winner!=NULL)
+        *winner=0;
+
+    // not worth dispatching a single guess
+    if (n<=1)
+        return solve(q0.empty()?chain.getAng():q0[0],xd,
+                     weight2ndTask,xd_2nd,w_2nd,
+                     weight3rdTask,qd_3rd,w_3rd,
+                     exit_code,exhalt);
+
+    pool->setHalt(false);
+    pool->first=-1;
+
+    string solver;
+    if (!CAST_IPOPTAPP(App)->Options()->GetStringValue("linear_solver",solver,""))
+        solver="";  // the default of the Ipopt build, e.g. mumps
+    pool->serialize=!isThreadSafeLinearSolver(solver);
+    if (pool->serialize && !pool->serializeWarned)
+    {
+        yWarning("multi-start: linear solver \"%s\" not known to be thread-safe, the optimizations will be run one at a time",
+                 solver.empty()?"default":solver.c_str());
+        pool->serializeWarned=true;
+    }
+
+    for (size_t i=0; i<n; i++)
+    {
+        iKinMultiStartWorker *w=pool->workers[i];
+
+        w->cloneChain(chain,chain2ndTask.getN());
+        *w->App->Options()=*CAST_IPOPTAPP(App)->Options();
+        w->App->Options()->SetStringValue("warm_start_init_point","no");
+
+        w->pLIC=pLIC;
+        w->ctrlPose=ctrlPose;
+        w->posePriority=posePriority;
+        w->obj_scaling=obj_scaling;
+        w->x_scaling=x_scaling;
+        w->g_scaling=g_scaling;
+        w->lowerBoundInf=lowerBoundInf;
+        w->upperBoundInf=upperBoundInf;
+
+        w->q0=q0[i];
+        w->xd=xd;
+        w->xd_2nd=xd_2nd;
+        w->w_2nd=w_2nd;
+        w->qd_3rd=qd_3rd;
+        w->w_3rd=w_3rd;
+        w->weight2ndTask=weight2ndTask;
+        w->weight3rdTask=weight3rdTask;
+
+        w->post();
+    }
+
+    // once halted, the workers quit at the next iteration
+    double t0=yarp::os::Time::now();
+    for (size_t finished=0; finished<n; )
+    {
+        if ((exhalt!=NULL) && *exhalt)
+            pool->setHalt(true);
+
+        if ((pool->budget>0.0) && (yarp::os::Time::now()-t0>pool->budget))
+            pool->setHalt(true);
+
+        if (pool->done.waitWithTimeout(IKINIPOPT_MULTISTART_POLL))
+            finished++;
+    }
+
+    // pick up the first converged solution or,
+    // if none, the one with the smallest task error
+    int best=pool->first;
+    if (best<0)
+    {
+        best=0;
+        for (size_t i=1; i<n; i++)
+            if (pool->workers[i]->taskErr<pool->workers[best]->taskErr)
+                best=(int)i;
+    }
+
+    iKinMultiStartWorker *w=pool->workers[best];
+    yarp::sig::Vector qd=chain.setAng(w->qd);
+
+    if (exit_code!=NULL)
+        *exit_code=w->status;
+
+    if (winner!=NULL)
+        *winner=best;
+
+    return qd;
+}
+
+
 /************************************************************************/
 yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                       double weight2ndTask, yarp::sig::Vector &xd_2nd,
@@ -1070,6 +1567,7 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
 /************************************************************************/
 iKinIpOptMin::~iKinIpOptMin()
 {
+    delete CAST_MSPOOL(multiStart);
     delete CAST_IPOPTAPP(App);
 }
 
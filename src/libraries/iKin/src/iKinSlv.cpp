@@ -17,6 +17,7 @@
 */
 
 #include <cmath>
+#include <vector>
 #include <algorithm>
 
 #include <yarp/os/LogStream.h>
@@ -33,6 +34,10 @@
 #define CARTSLV_WEIGHT_2ND_TASK             0.01
 #define CARTSLV_WEIGHT_3RD_TASK             0.01
 #define CARTSLV_UNCTRLEDJNTS_THRES          1.0     // [deg]
+#define CARTSLV_CACHE_POS_RES               0.005   // [m]
+#define CARTSLV_CACHE_ANG_RES               5.0     // [deg]
+#define CARTSLV_CACHE_JNT_RES               1.0     // [deg]
+#define CARTSLV_SOLVE_TIMES_WINDOW          200
 
 using namespace std;
 using namespace yarp::os;
@@ -292,6 +297,12 @@ CartesianSolver::CartesianSolver(const string &_slvName) : RateThread(CARTSLV_DE
     unctrlJointsNum=0;
     ping_robot_tmo=0.0;
 
+    solCacheSize=0;
+    solCachePosRes=CARTSLV_CACHE_POS_RES;
+    solCacheAngRes=CTRL_DEG2RAD*CARTSLV_CACHE_ANG_RES;
+    solCacheJntRes=CTRL_DEG2RAD*CARTSLV_CACHE_JNT_RES;
+    solCacheHits=solCacheMisses=0;
+
     prt=NULL;
     slv=NULL;
     clb=NULL;
@@ -955,81 +966,32 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
             //-----------------
             case IKINSLV_VOCAB_CMD_ASK:
             {
-                Bottle *b_xd=getTargetOption(command);
-                Bottle *b_q=getJointsOption(command);
-            
-                // some integrity checks
-                if (b_xd==NULL)
-                {
-                    reply.addVocab(IKINSLV_VOCAB_REP_NACK);
-                    break;
-                }
-                else if (b_xd->size()<3)    // at least the positional part must be given 
-                {
-                    reply.addVocab(IKINSLV_VOCAB_REP_NACK);
-                    break;
-                }
-            
                 lock();
-            
-                // get the target
-                Vector xd(b_xd->size());
-                for (size_t i=0; i<xd.length(); i++)
-                    xd[i]=b_xd->get(i).asDouble();
-            
-                // accounts for the starting DOF
-                // if different from the actual one
-                if (b_q!=NULL)
-                {
-                    size_t len=std::min((size_t)b_q->size(),(size_t)prt->chn->getDOF());
-                    for (size_t i=0; i<len; i++)
-                        (*prt->chn)(i).setAng(CTRL_DEG2RAD*b_q->get(i).asDouble());
-                }
-                else
-                    getFeedback();  // otherwise get the current configuration
-            
-                // account for the pose 
-                if (command.check(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)))
+                handleAsk(command,reply);
+                unlock();
+
+                break;
+            }
+
+            //-----------------
+            case IKINSLV_VOCAB_CMD_ASK_BATCH:
+            {
+                // solve the requests one by one, releasing the lock
+                // in between so that tracking in run() is not stalled
+                reply.addVocab(IKINSLV_VOCAB_REP_ACK);
+                for (int i=1; i<command.size(); i++)
                 {
-                    int pose=command.find(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)).asVocab();
-            
-                    if (pose==IKINSLV_VOCAB_VAL_POSE_FULL)
-                        slv->set_ctrlPose(IKINCTRL_POSE_FULL);
-                    else if (pose==IKINSLV_VOCAB_VAL_POSE_XYZ)
-                        slv->set_ctrlPose(IKINCTRL_POSE_XYZ);
+                    Bottle &solution=reply.addList();
+                    if (Bottle *request=command.get(i).asList())
+                    {
+                        lock();
+                        handleAsk(*request,solution);
+                        unlock();
+                    }
+                    else
+                        solution.addVocab(IKINSLV_VOCAB_REP_NACK);
                 }
-            
-                // set things for the 3rd task
-                for (unsigned int i=0; i<prt->chn->getDOF(); i++)
-                    if (idx_3rdTask[i]!=0.0)
-                        qd_3rdTask[i]=(*prt->chn)(i).getAng();
-            
-                // call the solver to converge
-                double t0=Time::now();
-                Vector q=solve(xd);
-                double t1=Time::now();
-            
-                Vector x=prt->chn->EndEffPose(q);
-            
-                // change to degrees
-                q*=CTRL_RAD2DEG;
-            
-                // dump on screen
-                if (verbosity)
-                    printInfo("ask",xd,x,q,t1-t0);
-            
-                // prepare the complete joints configuration
-                Vector _q(prt->chn->getN());
-                for (unsigned int i=0; i<prt->chn->getN(); i++)
-                    _q[i]=CTRL_RAD2DEG*prt->chn->getAng(i);
-            
-                // fill the reply accordingly
-                reply.addVocab(IKINSLV_VOCAB_REP_ACK);
-                addVectorOption(reply,IKINSLV_VOCAB_OPT_X,x);
-                addVectorOption(reply,IKINSLV_VOCAB_OPT_Q,_q);
 
-                unlock();
-            
                 break;
             }
 
@@ -1091,6 +1053,7 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                 reply.addVocab(IKINSLV_VOCAB_CMD_GET);
                 reply.addVocab(IKINSLV_VOCAB_CMD_SET);
                 reply.addVocab(IKINSLV_VOCAB_CMD_ASK);
+                reply.addVocab(IKINSLV_VOCAB_CMD_ASK_BATCH);
                 reply.addVocab(IKINSLV_VOCAB_CMD_SUSP);
                 reply.addVocab(IKINSLV_VOCAB_CMD_RUN);
                 reply.addVocab(IKINSLV_VOCAB_CMD_STATUS);
@@ -1111,6 +1074,8 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                 reply.addVocab(IKINSLV_VOCAB_OPT_XD);
                 reply.addVocab(IKINSLV_VOCAB_OPT_X);
                 reply.addVocab(IKINSLV_VOCAB_OPT_Q);
+                reply.addVocab(IKINSLV_VOCAB_OPT_TIME);
+                reply.addVocab(IKINSLV_VOCAB_OPT_RESIDUAL);
                 reply.addString("***** values");
                 reply.addVocab(IKINSLV_VOCAB_VAL_POSE_FULL);
                 reply.addVocab(IKINSLV_VOCAB_VAL_POSE_XYZ);
@@ -1139,6 +1104,98 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
 }
 
 
+/************************************************************************/
+bool CartesianSolver::handleAsk(const Bottle &request, Bottle &reply)
+{
+    Bottle *b_xd=getTargetOption(request);
+    Bottle *b_q=getJointsOption(request);
+
+    // some integrity checks
+    if (b_xd==NULL)
+    {
+        reply.addVocab(IKINSLV_VOCAB_REP_NACK);
+        return false;
+    }
+    else if (b_xd->size()<3)    // at least the positional part must be given 
+    {
+        reply.addVocab(IKINSLV_VOCAB_REP_NACK);
+        return false;
+    }
+
+    // get the target
+    Vector xd(b_xd->size());
+    for (size_t i=0; i<xd.length(); i++)
+        xd[i]=b_xd->get(i).asDouble();
+
+    // accounts for the starting DOF
+    // if different from the actual one
+    if (b_q!=NULL)
+    {
+        size_t len=std::min((size_t)b_q->size(),(size_t)prt->chn->getDOF());
+        for (size_t i=0; i<len; i++)
+            (*prt->chn)(i).setAng(CTRL_DEG2RAD*b_q->get(i).asDouble());
+    }
+    else
+        getFeedback();  // otherwise get the current configuration
+
+    // account for the pose 
+    if (request.check(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)))
+    {
+        int pose=request.find(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)).asVocab();
+
+        if (pose==IKINSLV_VOCAB_VAL_POSE_FULL)
+            slv->set_ctrlPose(IKINCTRL_POSE_FULL);
+        else if (pose==IKINSLV_VOCAB_VAL_POSE_XYZ)
+            slv->set_ctrlPose(IKINCTRL_POSE_XYZ);
+    }
+
+    // set things for the 3rd task
+    for (unsigned int i=0; i<prt->chn->getDOF(); i++)
+        if (idx_3rdTask[i]!=0.0)
+            qd_3rdTask[i]=(*prt->chn)(i).getAng();
+
+    // call the solver to converge
+    double t0=Time::now();
+    Vector q=solve(xd);
+    double t1=Time::now();
+
+    Vector x=prt->chn->EndEffPose(q);
+
+    // residual: position error [m] and,
+    // for full pose, orientation error [rad]
+    Vector res(2,0.0);
+    res[0]=norm(xd.subVector(0,2)-x.subVector(0,2));
+    if ((slv->get_ctrlPose()==IKINCTRL_POSE_FULL) && (xd.length()>=7))
+    {
+        Matrix Rerr=axis2dcm(xd.subVector(3,6))*axis2dcm(x.subVector(3,6)).transposed();
+        res[1]=fabs(dcm2axis(Rerr)[3]);
+    }
+
+    // change to degrees
+    q*=CTRL_RAD2DEG;
+
+    // dump on screen
+    if (verbosity)
+        printInfo("ask",xd,x,q,t1-t0);
+
+    // prepare the complete joints configuration
+    Vector _q(prt->chn->getN());
+    for (unsigned int i=0; i<prt->chn->getN(); i++)
+        _q[i]=CTRL_RAD2DEG*prt->chn->getAng(i);
+
+    // fill the reply accordingly
+    reply.addVocab(IKINSLV_VOCAB_REP_ACK);
+    addVectorOption(reply,IKINSLV_VOCAB_OPT_X,x);
+    addVectorOption(reply,IKINSLV_VOCAB_OPT_Q,_q);
+    Bottle &timePart=reply.addList();
+    timePart.addVocab(IKINSLV_VOCAB_OPT_TIME);
+    timePart.addDouble(t1-t0);
+    addVectorOption(reply,IKINSLV_VOCAB_OPT_RESIDUAL,res);
+
+    return true;
+}
+
+
 /************************************************************************/
 void CartesianSolver::send(const Vector &xd, const Vector &x, const Vector &q,
                            double *tok)
@@ -1170,6 +1227,115 @@ void CartesianSolver::printInfo(const string &typ, const Vector &xd,
     printf("  Target txPose   [m] = %s\n",x_.toString().c_str());
     printf("Target txJoints [deg] = %s\n",q.toString().c_str());
     printf("    computed in   [s] = %g\n",t);
+
+    double median,p99;
+    getSolveTimesStats(median,p99);
+    printf("  median time     [s] = %g\n",median);
+    printf("     p99 time     [s] = %g\n",p99);
+    if (solCacheSize>0)
+        printf("  cache hits/misses   = %u/%u\n",solCacheHits,solCacheMisses);
+}
+
+
+/************************************************************************/
+Vector CartesianSolver::getCacheKey(const Vector &xd)
+{
+    Vector unctrlJoints;
+    latchUncontrolledJoints(unctrlJoints);
+
+    Vector key(1+dof.length()+6+unctrlJoints.length(),0.0);
+    size_t k=0;
+
+    key[k++]=slv->get_ctrlPose();
+
+    for (size_t i=0; i<dof.length(); i++)
+        key[k++]=dof[i];
+
+    for (int i=0; i<3; i++)
+        key[k++]=floor(xd[i]/solCachePosRes+0.5);
+
+    // orientation is quantized as a rotation vector
+    if ((slv->get_ctrlPose()!=IKINCTRL_POSE_XYZ) && (xd.length()>=7))
+    {
+        for (int i=0; i<3; i++)
+            key[k++]=floor(xd[3+i]*xd[6]/solCacheAngRes+0.5);
+    }
+    else
+        k+=3;
+
+    if (unctrlJointsNum>0)
+        for (size_t i=0; i<unctrlJoints.length(); i++)
+            key[k++]=floor(unctrlJoints[i]/solCacheJntRes+0.5);
+
+    return key;
+}
+
+
+/************************************************************************/
+bool CartesianSolver::lookUpCache(const Vector &key, Vector &q)
+{
+    for (deque<SolutionCacheEntry>::iterator it=solCache.begin(); it!=solCache.end(); it++)
+    {
+        if ((it->key.length()==key.length()) && (it->key==key))
+        {
+            q=it->q;
+
+            // keep most recently used entries on top
+            SolutionCacheEntry entry=*it;
+            solCache.erase(it);
+            solCache.push_front(entry);
+
+            solCacheHits++;
+            return true;
+        }
+    }
+
+    solCacheMisses++;
+    return false;
+}
+
+
+/************************************************************************/
+void CartesianSolver::storeInCache(const Vector &key, const Vector &q)
+{
+    if (!solCache.empty() && (solCache.front().key.length()==key.length()) &&
+        (solCache.front().key==key))
+    {
+        solCache.front().q=q;
+        return;
+    }
+
+    SolutionCacheEntry entry;
+    entry.key=key;
+    entry.q=q;
+    solCache.push_front(entry);
+
+    while (solCache.size()>solCacheSize)
+        solCache.pop_back();
+}
+
+
+/************************************************************************/
+void CartesianSolver::updateSolveTimes(const double t)
+{
+    solveTimes.push_back(t);
+    if (solveTimes.size()>CARTSLV_SOLVE_TIMES_WINDOW)
+        solveTimes.pop_front();
+}
+
+
+/************************************************************************/
+void CartesianSolver::getSolveTimesStats(double &median, double &p99)
+{
+    median=p99=0.0;
+    if (solveTimes.empty())
+        return;
+
+    vector<double> t(solveTimes.begin(),solveTimes.end());
+    sort(t.begin(),t.end());
+
+    median=t[t.size()>>1];
+    p99=t[std::min(t.size()-1,(size_t)ceil(0.99*t.size())-1)];
 }
 
 
@@ -1414,6 +1580,35 @@ bool CartesianSolver::open(Searchable &options)
     // instantiate the optimizer
     slv=new iKinIpOptMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
 
+    if (options.check("warm_start"))
+        if (options.find("warm_start").asVocab()==IKINSLV_VOCAB_VAL_ON)
+            slv->setWarmStart(true);
+
+    // multi-start mode
+    if (options.check("multi_start"))
+        slv->setMultiStart(options.find("multi_start").asInt(),
+                           options.check("multi_start_budget",Value(0.0)).asDouble());
+
+    // solutions cache
+    solCacheSize=std::max(0,options.check("cache_size",Value(0)).asInt());
+    if (Bottle *v=options.find("cache_res").asList())
+    {
+        if (v->size()>=3)
+        {
+            solCachePosRes=v->get(0).asDouble();
+            solCacheAngRes=CTRL_DEG2RAD*v->get(1).asDouble();
+            solCacheJntRes=CTRL_DEG2RAD*v->get(2).asDouble();
+        }
+
+        if ((solCachePosRes<=0.0) || (solCacheAngRes<=0.0) || (solCacheJntRes<=0.0))
+        {
+            yWarning("%s: invalid cache_res, using defaults",slvName.c_str());
+            solCachePosRes=CARTSLV_CACHE_POS_RES;
+            solCacheAngRes=CTRL_DEG2RAD*CARTSLV_CACHE_ANG_RES;
+            solCacheJntRes=CTRL_DEG2RAD*CARTSLV_CACHE_JNT_RES;
+        }
+    }
+
     // instantiate solver callback object if required    
     if (options.check("interPoints"))
         if (options.find("interPoints").asVocab()==IKINSLV_VOCAB_VAL_ON)
@@ -1530,10 +1725,52 @@ void CartesianSolver::prepareJointsRestTask()
 /************************************************************************/
 Vector CartesianSolver::solve(Vector &xd)
 {
-    return slv->solve(prt->chn->getAng(),xd,
-                      slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
-                      CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
-                      NULL,NULL,clb);
+    Vector q0=prt->chn->getAng();
+
+    // start from a previous solution, if any
+    Vector key,qc;
+    bool hit=false;
+    if (solCacheSize>0)
+    {
+        key=getCacheKey(xd);
+        hit=lookUpCache(key,qc) && (qc.length()==q0.length());
+    }
+
+    double t0=Time::now();
+    Vector q;
+
+    // intermediate points require the single-start solver
+    if ((slv->getMultiStart()>1) && (clb==NULL))
+    {
+        // seeds: cached solution (if any), current
+        // configuration and rest posture
+        deque<Vector> guesses;
+        if (hit)
+            guesses.push_back(qc);
+        guesses.push_back(q0);
+
+        Vector qRest(q0.length());
+        for (unsigned int i=0, offs=0; (i<prt->chn->getN()) && (offs<qRest.length()); i++)
+            if (!(*prt->chn)[i].isBlocked())
+                qRest[offs++]=restJntPos[i];
+        guesses.push_back(qRest);
+
+        q=slv->solveMultiStart(guesses,xd,
+                               slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
+                               CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask);
+    }
+    else
+        q=slv->solve(hit?qc:q0,xd,
+                     slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
+                     CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
+                     NULL,NULL,clb);
+
+    updateSolveTimes(Time::now()-t0);
+
+    if (solCacheSize>0)
+        storeInCache(key,q);
+
+    return q;
 }
 
 
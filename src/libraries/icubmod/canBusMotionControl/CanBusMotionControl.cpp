@@ -51,6 +51,7 @@
 
 const int REPORT_PERIOD=6; //seconds
 const double BCAST_STATUS_TIMEOUT=6; //seconds
+const int PIPELINED_READ_CHUNK=64; //max requests sent in a single burst by _readPipelined
 
 
 using namespace yarp;
@@ -371,6 +372,19 @@ public:
     inline int getJoints (void) const { return _njoints; }
     inline bool getErrorStatus (void) const { return _error_status;}
 
+    void resetBroadcastStats ()
+    {
+        _bcastDecodeTime=0;
+        _bcastDecodeMax=0;
+        _bcastDecodeCount=0;
+    }
+
+    // copy _bcastRecvBuffer into _bcastSnapshot, called by the can thread only
+    void publishBroadcasts ();
+    // seqlock read of _bcastSnapshot: repeat the reads until endBroadcastRead() returns true
+    inline unsigned int beginBroadcastRead ();
+    inline bool endBroadcastRead (unsigned int version);
+
     void printMessage(const char *fmt, ...)
     {
         va_list ap; 
@@ -411,6 +425,13 @@ public:
     CanBuffer _echoBuffer;/// echo buffer.
 
     BCastBufferElement *_bcastRecvBuffer;/// local storage for bcast messages.
+    BCastBufferElement *_bcastSnapshot;/// copy of _bcastRecvBuffer published every cycle, read by the getters without _mutex.
+    volatile unsigned int _bcastVersion;/// seqlock counter of _bcastSnapshot, odd while the can thread is writing it.
+
+    double _bcastDecodeTime;/// time spent decoding and publishing broadcasts since last report [ms].
+    double _bcastDecodeMax;/// worst decode time since last report [ms].
+    unsigned int _bcastDecodeCount;/// number of decoded cycles since last report.
+    volatile long _bcastReadRetries;/// snapshot reads that overlapped a publish and were repeated (atomic, updated by the readers on retry only).
 
     unsigned char _my_address;/// 
     unsigned char _destinations[CAN_MAX_CARDS];/// list of connected cards (and their addresses).
@@ -2044,6 +2065,10 @@ CanBusResources::CanBusResources ()
     _writeMessages = 0;
     _echoMessages = 0;
     _bcastRecvBuffer = NULL;
+    _bcastSnapshot = NULL;
+    _bcastVersion = 0;
+    resetBroadcastStats();
+    _bcastReadRetries = 0;
 
     _error_status = true;
     requestsQueue=0;
@@ -2137,6 +2162,8 @@ bool CanBusResources::initialize (const CanBusMotionControlParameters& parms)
             _bcastRecvBuffer[j]._speed_rotor.resetStats();
             _bcastRecvBuffer[j]._accel_rotor.resetStats();
         }
+    _bcastSnapshot = allocAndCheck<BCastBufferElement> (_njoints);
+    publishBroadcasts();
 
     //previously initialized
     iCanBus->canSetBaudRate(_speed);
@@ -2211,6 +2238,7 @@ bool CanBusResources::uninitialize ()
 
     //yTrace("CanBusResources::uninitialize\n");
     checkAndDestroy<BCastBufferElement> (_bcastRecvBuffer);
+    checkAndDestroy<BCastBufferElement> (_bcastSnapshot);
 
     if (_initialized)
     {
@@ -2321,6 +2349,67 @@ bool CanBusResources::writePacket ()
     return true;
 }
 
+static inline void bcastBarrier(void)
+{
+#if defined(_MSC_VER)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+// only the failed reads are counted, so that a successful read never writes shared memory
+static inline void bcastCountRetry(volatile long *counter)
+{
+#if defined(_MSC_VER)
+    InterlockedIncrement(counter);
+#else
+    __sync_fetch_and_add(counter,1);
+#endif
+}
+
+// read and clear the retries counter without losing the increments of concurrent readers
+static inline long bcastTakeRetries(volatile long *counter)
+{
+#if defined(_MSC_VER)
+    return InterlockedExchange(counter,0);
+#else
+    return __sync_fetch_and_and(counter,0);
+#endif
+}
+
+void CanBusResources::publishBroadcasts ()
+{
+    // single writer: the can thread. Readers never block it, they retry
+    // when the version changed (or is odd) while they were reading.
+    _bcastVersion++;
+    bcastBarrier();
+    for (int j=0; j<_njoints; j++)
+        _bcastSnapshot[j]=_bcastRecvBuffer[j];
+    bcastBarrier();
+    _bcastVersion++;
+}
+
+unsigned int CanBusResources::beginBroadcastRead ()
+{
+    // wait for the writer on the version load only: the retries are
+    // counted once per failed endBroadcastRead(), never while spinning
+    unsigned int version=_bcastVersion;
+    while (version & 1)
+        version=_bcastVersion;
+    bcastBarrier();
+    return version;
+}
+
+bool CanBusResources::endBroadcastRead (unsigned int version)
+{
+    bcastBarrier();
+    if (_bcastVersion==version)
+        return true;
+    bcastCountRetry(&_bcastReadRetries);
+    return false;
+}
+
 bool CanBusResources::printMessage (const CanMessage& m)
 {
     unsigned int id;
@@ -2405,7 +2494,8 @@ ImplementAxisInfo(this),
 ImplementPWMControl(this),
 ImplementCurrentControl(this),
 _mutex(1),
-_done(0)
+_done(0),
+_stampMutex(1)
 {
     system_resources = (void *) new CanBusResources;
     ACE_ASSERT (system_resources != NULL);
@@ -3449,6 +3539,15 @@ void CanBusMotionControl::handleBroadcasts()
             }
         }
     }
+
+    // make the decoded values visible to the getters as a single consistent snapshot
+    r.publishBroadcasts();
+
+    double decodeTime=(Time::now()-before)*1000;
+    r._bcastDecodeTime+=decodeTime;
+    if (decodeTime>r._bcastDecodeMax)
+        r._bcastDecodeMax=decodeTime;
+    r._bcastDecodeCount++;
 }
 
 ///
@@ -3553,6 +3652,17 @@ void CanBusMotionControl:: run()
                     avPeriod,
                     avThTime);
 
+            if (r._bcastDecodeCount>0)
+            {
+                yDebug("%s [%d] bcast decode av:%.3lf[ms] max:%.3lf[ms], snapshot read retries:%ld\n",
+                        canDevName.c_str(),
+                        r._networkN,
+                        r._bcastDecodeTime/r._bcastDecodeCount,
+                        r._bcastDecodeMax,
+                        bcastTakeRetries(&r._bcastReadRetries));
+            }
+            r.resetBroadcastStats();
+
             const char *can=canDevName.c_str();
             logNetworkData(can,r._networkN,10,yarp::os::Value(r._polling_interval));
             logNetworkData(can,r._networkN,11,yarp::os::Value((double)avPeriod));
@@ -3864,13 +3974,16 @@ bool CanBusMotionControl::getControlModesRaw(int *v)
     CanBusResources& r = RES(system_resources);
     int i;
     int temp;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++)
+    unsigned int version;
+    do
     {
-        temp = int(r._bcastRecvBuffer[i]._controlmodeStatus);
-        v[i]=from_modeint_to_modevocab(temp);
-    }
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++)
+        {
+            temp = int(r._bcastSnapshot[i]._controlmodeStatus);
+            v[i]=from_modeint_to_modevocab(temp);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 /*
@@ -4059,12 +4172,14 @@ bool CanBusMotionControl::getControlModeRaw(int j, int *v)
     DEBUG_FUNC("Calling GET_CONTROL_MODE\n");
     //_readWord16 (CAN_GET_CONTROL_MODE, j, s); 
 
-    _mutex.wait();
-    s = r._bcastRecvBuffer[j]._controlmodeStatus;
-  
-    *v=from_modeint_to_modevocab(s);
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        s = r._bcastSnapshot[j]._controlmodeStatus;
 
-    _mutex.post();
+        *v=from_modeint_to_modevocab(s);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -4076,14 +4191,12 @@ bool CanBusMotionControl::getControlModesRaw(const int n_joints, const int *join
     if (joints==0) return false;
     if (modes==0) return false;
 
-    CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
+    // the single joint getter reads the broadcast snapshot, no need for _mutex
     for (i = 0; i < n_joints; i++)
     {
         getControlModeRaw(joints[i], &modes[i]);
     }
-    _mutex.post();
     return true;
 }
 
@@ -4574,28 +4687,53 @@ bool CanBusMotionControl::helper_getPosPidRaw (int axis, Pid *out)
     if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2))
         return false;
 
-    short s;
-    short s2;
-
-    DEBUG_FUNC("Calling GET_P_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_P_GAIN, axis, s); out->kp = double(s);
-    DEBUG_FUNC("Calling CAN_GET_D_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_D_GAIN, axis, s); out->kd = double(s);
-    DEBUG_FUNC("Calling CAN_GET_I_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_I_GAIN, axis, s); out->ki = double(s);
-    DEBUG_FUNC("Calling CAN_GET_ILIM_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_ILIM_GAIN, axis, s); out->max_int = double(s);
-    DEBUG_FUNC("Calling CAN_GET_OFFSET\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_OFFSET, axis, s); out->offset= double(s);
-    DEBUG_FUNC("Calling CAN_GET_SCALE\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_SCALE, axis, s); out->scale = double(s);
-    DEBUG_FUNC("Calling CAN_GET_TLIM\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_TLIM, axis, s); out->max_output = double(s);
-    DEBUG_FUNC("Calling CAN_GET_POS_STICTION_PARAMS\n");
-    _readWord16Ex (ICUBCANPROTO_POL_MC_CMD__GET_POS_STICTION_PARAMS, axis, s, s2 ); out->stiction_up_val = double(s); out->stiction_down_val = double(s2);
+    return helper_getPosPidsRaw(1, &axis, out);
+}
+
+/// all gains of all the requested axes are read with a single pipelined burst.
+bool CanBusMotionControl::helper_getPosPidsRaw (int n, const int *axes, Pid *out)
+{
+    static const int msgs[] = {
+        ICUBCANPROTO_POL_MC_CMD__GET_P_GAIN,
+        ICUBCANPROTO_POL_MC_CMD__GET_D_GAIN,
+        ICUBCANPROTO_POL_MC_CMD__GET_I_GAIN,
+        ICUBCANPROTO_POL_MC_CMD__GET_ILIM_GAIN,
+        ICUBCANPROTO_POL_MC_CMD__GET_OFFSET,
+        ICUBCANPROTO_POL_MC_CMD__GET_SCALE,
+        ICUBCANPROTO_POL_MC_CMD__GET_TLIM,
+        ICUBCANPROTO_POL_MC_CMD__GET_POS_STICTION_PARAMS
+    };
+    const int nMsgs = sizeof(msgs)/sizeof(msgs[0]);
+
+    if (n < 1)
+        return false;
+
+    CanReadRequest *reqs = new CanReadRequest[n*nMsgs];
+    int i, k;
+    for (i = 0; i < n; i++)
+        for (k = 0; k < nMsgs; k++)
+            reqs[i*nMsgs+k].set(msgs[k], axes[i]);
+
+    DEBUG_FUNC("Calling GET_POS_PID on %d axes\n", n);
+    bool ret = _readPipelined(reqs, n*nMsgs);
+
+    for (i = 0; i < n; i++)
+    {
+        const CanReadRequest *q = &reqs[i*nMsgs];
+        out[i].kp = double(q[0].getWord16(0));
+        out[i].kd = double(q[1].getWord16(0));
+        out[i].ki = double(q[2].getWord16(0));
+        out[i].max_int = double(q[3].getWord16(0));
+        out[i].offset = double(q[4].getWord16(0));
+        out[i].scale = double(q[5].getWord16(0));
+        out[i].max_output = double(q[6].getWord16(0));
+        out[i].stiction_up_val = double(q[7].getWord16(0));
+        out[i].stiction_down_val = double(q[7].getWord16(2));
+    }
     DEBUG_FUNC("Get PID done!\n");
-    
-    return true;
+
+    delete [] reqs;
+    return ret;
 }
 
 bool CanBusMotionControl::getPidRaw (const PidControlTypeEnum& pidtype, int axis, Pid *pid)
@@ -4630,11 +4768,27 @@ bool CanBusMotionControl::getPidsRaw (const PidControlTypeEnum& pidtype, Pid *pi
     CanBusResources& r = RES(system_resources);
 
     int i;
+    int *axes = new int[r.getJoints()];
     for (i = 0; i < r.getJoints(); i++)
+        axes[i] = i;
+
+    switch (pidtype)
     {
-        getPidRaw(pidtype,i,&pids[i]);
+        case VOCAB_PIDTYPE_POSITION:
+            helper_getPosPidsRaw(r.getJoints(), axes, pids);
+        break;
+        case VOCAB_PIDTYPE_TORQUE:
+            helper_getTrqPidsRaw(r.getJoints(), axes, pids);
+        break;
+        default:
+            for (i = 0; i < r.getJoints(); i++)
+            {
+                getPidRaw(pidtype,i,&pids[i]);
+            }
+        break;
     }
 
+    delete [] axes;
     return true;
 }
 
@@ -4690,146 +4844,65 @@ bool CanBusMotionControl::helper_getTrqPidRaw (int axis, Pid *out)
 {
     DEBUG_FUNC("Calling CAN_GET_TORQUE_PID \n");
 
-    CanBusResources& r = RES(system_resources);
     if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2))
         return false;
 
- 
- 
-    if (!ENABLED(axis))
-    {
-        //@@@ TODO: check here
-        // value = 0;
-        return true;
-    }
- 
-
-    _mutex.wait();
-    int id;
-    if (!threadPool->getId(id))
-    {
-        yError("More than %d threads, cannot allow more\n", CANCONTROL_MAX_THREADS);
-        _mutex.post();
-        return false;
-    }
-
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PID);
-    r.writePacket();
+    return helper_getTrqPidsRaw(1, &axis, out);
+}
 
-    ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.post();
-    t->synch();
+/// torque pid, pid limits, model params and stiction of all the requested
+/// axes are read with a single pipelined burst. Disabled axes are left untouched.
+bool CanBusMotionControl::helper_getTrqPidsRaw (int n, const int *axes, Pid *out)
+{
+    static const int msgs[] = {
+        ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PID,
+        ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PIDLIMITS,
+        ICUBCANPROTO_POL_MC_CMD__GET_MODEL_PARAMS,
+        ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_STICTION_PARAMS
+    };
+    const int nMsgs = sizeof(msgs)/sizeof(msgs[0]);
 
-    if (!r.getErrorStatus() || (t->timedOut()))
-    {
-        yError("getTorquePid: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
+    if (n < 1)
         return false;
-    }
 
-    CanMessage *m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    unsigned char *data;
-    data=m->getData()+1;
-    out->kp= *((short *)(data));
-    data+=2;
-    out->ki= *((short *)(data));
-    data+=2;
-    out->kd= *((short *)(data));
-    data+=2;
-    out->scale= *((char *)(data));
-
-    t->clear();
-
-    _mutex.wait();
-    
-    DEBUG_FUNC("Calling CAN_GET_TORQUE_PIDLIMITS\n");
-   
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PIDLIMITS);
-    r.writePacket();
+    CanReadRequest *reqs = new CanReadRequest[n*nMsgs];
+    int i, k;
+    for (i = 0; i < n; i++)
+        for (k = 0; k < nMsgs; k++)
+            reqs[i*nMsgs+k].set(msgs[k], axes[i]);
 
-    // ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.post();
-    t->synch();
+    bool ret = _readPipelined(reqs, n*nMsgs);
+    if (!ret)
+        yError("getTorquePids: at least one message timed out\n");
 
-    if (!r.getErrorStatus() || (t->timedOut()))
+    for (i = 0; i < n; i++)
     {
-        yError("getTorquePidLimits: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
+        const CanReadRequest *q = &reqs[i*nMsgs];
+        if (!ENABLED(axes[i]))
+            continue;
 
-    m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    data=m->getData()+1;
-    out->offset= *((short *)(data));
-    data+=2;
-    out->max_output= *((short *)(data));
-    data+=2;
-    out->max_int= *((short *)(data));
-
-    t->clear();
-
-    _mutex.wait();
-    
-    DEBUG_FUNC("Calling CAN_GET_MODEL_PARAMS\n");
-   
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_MODEL_PARAMS);
-    r.writePacket();
-
-    // ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.post();
-    t->synch();
-
-    if (!r.getErrorStatus() || (t->timedOut()))
-    {
-        yError("CAN_GET_MODEL_PARAMS: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
+        if (q[0].valid)
+        {
+            out[i].kp = q[0].getWord16(0);
+            out[i].ki = q[0].getWord16(2);
+            out[i].kd = q[0].getWord16(4);
+            out[i].scale = (char)(q[0].data[6]);
+        }
+        if (q[1].valid)
+        {
+            out[i].offset = q[1].getWord16(0);
+            out[i].max_output = q[1].getWord16(2);
+            out[i].max_int = q[1].getWord16(4);
+        }
+        if (q[2].valid)
+            out[i].kff = q[2].getWord16(0);
 
-    m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
-        return false;
+        out[i].stiction_up_val = double(q[3].getWord16(0));
+        out[i].stiction_down_val = double(q[3].getWord16(2));
     }
 
-    data=m->getData()+1;
-    out->kff= *((short *)(data));
-
-    t->clear();
-
-    DEBUG_FUNC("Calling CAN_GET_TORQUE_STICTION_PARAMS\n");
-    short s1;
-    short s2;
-    _readWord16Ex (ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_STICTION_PARAMS, axis, s1, s2 );
-    out->stiction_up_val = double(s1); 
-    out->stiction_down_val = double(s2);
-
-    return true;
+    delete [] reqs;
+    return ret;
 }
 
 bool CanBusMotionControl::setPidsRaw(const PidControlTypeEnum& pidtype, const Pid *pids)
@@ -4898,9 +4971,12 @@ bool CanBusMotionControl::getTorqueRaw (int j, double *trq)
         return false;
 
     int k=castToMapper(yarp::dev::ImplementTorqueControl::helper)->toUser(j);
-    _mutex.wait();
-    *trq = double(r._bcastRecvBuffer[k]._torque);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *trq = double(r._bcastSnapshot[k]._torque);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -4978,25 +5054,28 @@ bool CanBusMotionControl::getPidErrorRaw(const PidControlTypeEnum& pidtype, int
     if (!(axis >= 0 && axis <= r.getJoints()))
         return false;
 
-    _mutex.wait();
-    switch (pidtype)
+    unsigned int version;
+    do
     {
-        case VOCAB_PIDTYPE_POSITION:
-        *err = double(r._bcastRecvBuffer[axis]._position_error);
-        break;
-        case VOCAB_PIDTYPE_TORQUE:
-        *err = double(r._bcastRecvBuffer[axis]._torque_error);
-        break;
-        case VOCAB_PIDTYPE_VELOCITY:
-        *err = 0; //not yet implemented
-        NOT_YET_IMPLEMENTED("getPidErrorRaw VOCAB_PIDTYPE_VELOCITY");
-        break;
-        case VOCAB_PIDTYPE_CURRENT:
-        *err = 0; //not yet implemented
-        NOT_YET_IMPLEMENTED("getPidErrorRaw VOCAB_PIDTYPE_CURRENT");
-        break;
-    }
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        switch (pidtype)
+        {
+            case VOCAB_PIDTYPE_POSITION:
+            *err = double(r._bcastSnapshot[axis]._position_error);
+            break;
+            case VOCAB_PIDTYPE_TORQUE:
+            *err = double(r._bcastSnapshot[axis]._torque_error);
+            break;
+            case VOCAB_PIDTYPE_VELOCITY:
+            *err = 0; //not yet implemented
+            NOT_YET_IMPLEMENTED("getPidErrorRaw VOCAB_PIDTYPE_VELOCITY");
+            break;
+            case VOCAB_PIDTYPE_CURRENT:
+            *err = 0; //not yet implemented
+            NOT_YET_IMPLEMENTED("getPidErrorRaw VOCAB_PIDTYPE_CURRENT");
+            break;
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -5459,28 +5538,29 @@ bool CanBusMotionControl::getPidOutputRaw(const PidControlTypeEnum& pidtype, int
     CanBusResources& r = RES(system_resources);
     if (!(axis >= 0 && axis <= r.getJoints()))
         return false;
-    _mutex.wait();
-
-    switch (pidtype)
+    unsigned int version;
+    do
     {
-        case VOCAB_PIDTYPE_POSITION:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
-        break;
-        case VOCAB_PIDTYPE_VELOCITY:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
-        break;
-        case VOCAB_PIDTYPE_CURRENT:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
-        break;
-        case VOCAB_PIDTYPE_TORQUE:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
-        break;
-        default:
-            yError()<<"Invalid pidtype:"<<pidtype;
-        break;
-    }
-    
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        switch (pidtype)
+        {
+            case VOCAB_PIDTYPE_POSITION:
+                *(out) = double(r._bcastSnapshot[axis]._pid_value);
+            break;
+            case VOCAB_PIDTYPE_VELOCITY:
+                *(out) = double(r._bcastSnapshot[axis]._pid_value);
+            break;
+            case VOCAB_PIDTYPE_CURRENT:
+                *(out) = double(r._bcastSnapshot[axis]._pid_value);
+            break;
+            case VOCAB_PIDTYPE_TORQUE:
+                *(out) = double(r._bcastSnapshot[axis]._pid_value);
+            break;
+            default:
+                yError()<<"Invalid pidtype:"<<pidtype;
+            break;
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -5753,25 +5833,29 @@ bool CanBusMotionControl::getRefSpeedRaw (int axis, double *spd)
     return true;
 }
 
-/// cmd is an array of double (LATER: to be optimized).
+/// cmd is an array of double, all axes are read with a single pipelined burst.
 bool CanBusMotionControl::getRefAccelerationsRaw (double *accs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    short value = 0;
 
+    CanReadRequest *reqs = new CanReadRequest[r.getJoints()];
     for(i = 0; i < r.getJoints(); i++)
+        reqs[i].set(ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_ACCELER, i);
+
+    bool ret = _readPipelined(reqs, r.getJoints());
+    if (ret)
     {
-        if (_readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_ACCELER, i, value) == true) {
-            _ref_accs[i] = accs[i] = double (value);
+        for(i = 0; i < r.getJoints(); i++)
+        {
+            _ref_accs[i] = accs[i] = double (reqs[i].getWord16(0));
             accs[i] *= 1000.0;
             accs[i] *= 1000.0;
         }
-        else
-            return false;
     }
 
-    return true;
+    delete [] reqs;
+    return ret;
 }
 
 /// cmd is an array of double (LATER: to be optimized).
@@ -5793,23 +5877,25 @@ bool CanBusMotionControl::getRefAccelerationRaw (int axis, double *accs)
     return true;
 }
 
-/// cmd is an array of double (LATER: to be optimized).
+/// cmd is an array of double, all axes are read with a single pipelined burst.
 bool CanBusMotionControl::getRefTorquesRaw (double *ref_trqs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    short value = 0;
 
+    CanReadRequest *reqs = new CanReadRequest[r.getJoints()];
     for(i = 0; i < r.getJoints(); i++)
+        reqs[i].set(ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_TORQUE, i);
+
+    bool ret = _readPipelined(reqs, r.getJoints());
+    if (ret)
     {
-        if (_readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_TORQUE, i, value) == true) {
-            _ref_torques[i] = ref_trqs[i] = double (value);
-        }
-        else
-            return false;
+        for(i = 0; i < r.getJoints(); i++)
+            _ref_torques[i] = ref_trqs[i] = double (reqs[i].getWord16(0));
     }
 
-    return true;
+    delete [] reqs;
+    return ret;
 }
 
 /// cmd is an array of double (LATER: to be optimized).
@@ -6126,27 +6212,31 @@ bool CanBusMotionControl::getEncodersRaw(double *v)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    
     double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_joint._value);
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        stamp=0;
+        for (i = 0; i < r.getJoints(); i++) {
+            v[i] = double(r._bcastSnapshot[i]._position_joint._value);
 
-        if (stamp<r._bcastRecvBuffer[i]._position_joint._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_joint._stamp;
-    }
+            if (stamp<r._bcastSnapshot[i]._position_joint._stamp)
+                stamp=r._bcastSnapshot[i]._position_joint._stamp;
+        }
+    } while (!r.endBroadcastRead(version));
 
+    _stampMutex.wait();
     stampEncoders.update(stamp);
-
-    _mutex.post();
+    _stampMutex.post();
     return true;
 }
 
 Stamp CanBusMotionControl::getLastInputStamp()
 {
-    _mutex.wait();
+    _stampMutex.wait();
     Stamp ret=stampEncoders;
-    _mutex.post();
+    _stampMutex.post();
     return ret;
 }
 
@@ -6155,9 +6245,12 @@ bool CanBusMotionControl::getEncoderRaw(int axis, double *v)
     CanBusResources& r = RES(system_resources);
     if (!(axis >= 0 && axis <= r.getJoints()))return false;
 
-    _mutex.wait();
-    *v = double(r._bcastRecvBuffer[axis]._position_joint._value);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *v = double(r._bcastSnapshot[axis]._position_joint._value);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6166,12 +6259,15 @@ bool CanBusMotionControl::getEncoderSpeedsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++) {
-        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._speed_joint)*1000.0)/vel_factor;
-    }
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++) {
+            int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
+            v[i] = (double(r._bcastSnapshot[i]._speed_joint)*1000.0)/vel_factor;
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6182,10 +6278,13 @@ bool CanBusMotionControl::getEncoderSpeedRaw(int j, double *v)
     if (!(j >= 0 && j <= r.getJoints()))
         return false;
 
-    _mutex.wait();
-    int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[j]._speed_joint)*1000.0)/vel_factor;
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
+        *v = (double(r._bcastSnapshot[j]._speed_joint)*1000.0)/vel_factor;
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6194,13 +6293,16 @@ bool CanBusMotionControl::getEncoderAccelerationsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++) {
-        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
-        int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Acc_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
-    }
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++) {
+            int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
+            int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Acc_estimator_shift));
+            v[i] = (double(r._bcastSnapshot[i]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6211,11 +6313,14 @@ bool CanBusMotionControl::getEncoderAccelerationRaw(int j, double *v)
     if (!(j >= 0 && j <= r.getJoints()))
         return false;
 
-    _mutex.wait();
-    int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
-    int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Acc_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[j]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
+        int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Acc_estimator_shift));
+        *v = (double(r._bcastSnapshot[j]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6246,19 +6351,23 @@ bool CanBusMotionControl::getMotorEncodersRaw(double *v)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    
     double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_rotor._value);
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        stamp=0;
+        for (i = 0; i < r.getJoints(); i++) {
+            v[i] = double(r._bcastSnapshot[i]._position_rotor._value);
 
-        if (stamp<r._bcastRecvBuffer[i]._position_rotor._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_rotor._stamp;
-    }
+            if (stamp<r._bcastSnapshot[i]._position_rotor._stamp)
+                stamp=r._bcastSnapshot[i]._position_rotor._stamp;
+        }
+    } while (!r.endBroadcastRead(version));
 
+    _stampMutex.wait();
     stampEncoders.update(stamp);
-
-    _mutex.post();
+    _stampMutex.post();
     return true;
 }
 
@@ -6267,9 +6376,12 @@ bool CanBusMotionControl::getMotorEncoderRaw(int m, double *v)
     CanBusResources& r = RES(system_resources);
     if (!(m >= 0 && m <= r.getJoints()))return false;
 
-    _mutex.wait();
-    *v = double(r._bcastRecvBuffer[m]._position_rotor._value);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *v = double(r._bcastSnapshot[m]._position_rotor._value);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6279,20 +6391,24 @@ bool CanBusMotionControl::getMotorEncodersTimedRaw(double *v, double *t)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    
     double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_rotor._value);
-        t[i] = r._bcastRecvBuffer[i]._position_rotor._stamp;
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        stamp=0;
+        for (i = 0; i < r.getJoints(); i++) {
+            v[i] = double(r._bcastSnapshot[i]._position_rotor._value);
+            t[i] = r._bcastSnapshot[i]._position_rotor._stamp;
 
-        if (stamp<r._bcastRecvBuffer[i]._position_rotor._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_rotor._stamp;
-    }
+            if (stamp<r._bcastSnapshot[i]._position_rotor._stamp)
+                stamp=r._bcastSnapshot[i]._position_rotor._stamp;
+        }
+    } while (!r.endBroadcastRead(version));
 
+    _stampMutex.wait();
     stampEncoders.update(stamp);
-
-    _mutex.post();
+    _stampMutex.post();
     return true;
 }
 
@@ -6301,10 +6417,13 @@ bool CanBusMotionControl::getMotorEncoderTimedRaw(int m, double *v, double *t)
     CanBusResources& r = RES(system_resources);
     if (!(m >= 0 && m <= r.getJoints()))return false;
 
-    _mutex.wait();
-    *v = double(r._bcastRecvBuffer[m]._position_rotor._value);
-    *t = r._bcastRecvBuffer[m]._position_rotor._stamp;
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *v = double(r._bcastSnapshot[m]._position_rotor._value);
+        *t = r._bcastSnapshot[m]._position_rotor._stamp;
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6337,12 +6456,15 @@ bool CanBusMotionControl::getMotorEncoderSpeedsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++) {
-        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._speed_rotor._value)*1000.0)/vel_factor;
-    }
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++) {
+            int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
+            v[i] = (double(r._bcastSnapshot[i]._speed_rotor._value)*1000.0)/vel_factor;
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6351,10 +6473,13 @@ bool CanBusMotionControl::getMotorEncoderSpeedRaw(int m, double *v)
     CanBusResources& r = RES(system_resources);
     if (!(m >= 0 && m <= r.getJoints()))return false;
 
-    _mutex.wait();
-    int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[m]._speed_rotor._value)*1000.0)/vel_factor;
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
+        *v = (double(r._bcastSnapshot[m]._speed_rotor._value)*1000.0)/vel_factor;
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6362,13 +6487,16 @@ bool CanBusMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++) {
-        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
-        int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Acc_estimator_shift));
-        accs[i] = (double(r._bcastRecvBuffer[i]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
-    }
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++) {
+            int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
+            int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Acc_estimator_shift));
+            accs[i] = (double(r._bcastSnapshot[i]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6377,11 +6505,14 @@ bool CanBusMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
     CanBusResources& r = RES(system_resources);
     if (!(m >= 0 && m <= r.getJoints()))return false;
 
-    _mutex.wait();
-    int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
-    int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Acc_estimator_shift));
-    *acc = (double(r._bcastRecvBuffer[m]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
+        int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Acc_estimator_shift));
+        *acc = (double(r._bcastSnapshot[m]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6401,13 +6532,15 @@ bool CanBusMotionControl::getCurrentsRaw(double *cs)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++)
+    unsigned int version;
+    do
     {
-        cs[i] = double(r._bcastRecvBuffer[i]._current);
-    }
-
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++)
+        {
+            cs[i] = double(r._bcastSnapshot[i]._current);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -6418,9 +6551,12 @@ bool CanBusMotionControl::getCurrentRaw(int axis, double *c)
     if (!(axis >= 0 && axis <= r.getJoints()))
         return false;
 
-    _mutex.wait();
-    *c = double(r._bcastRecvBuffer[axis]._current);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *c = double(r._bcastSnapshot[axis]._current);
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6589,16 +6725,19 @@ bool CanBusMotionControl::getAmpStatusRaw(int *st)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++)
+    unsigned int version;
+    do
     {
-    //  WARNING
-    //    Line changed with no idea about what it should do
-    //    st[i] = short(r._bcastRecvBuffer[i]._fault);  
-        st[i] = short(r._bcastRecvBuffer[i]._axisStatus);  
-   
-    }
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++)
+        {
+        //  WARNING
+        //    Line changed with no idea about what it should do
+        //    st[i] = short(r._bcastSnapshot[i]._fault);  
+            st[i] = short(r._bcastSnapshot[i]._axisStatus);  
+
+        }
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6607,9 +6746,12 @@ bool CanBusMotionControl::getAmpStatusRaw(int j, int *st)
 {
     CanBusResources& r = RES(system_resources);
 
-    _mutex.wait();
-    st[j] = short(r._bcastRecvBuffer[j]._axisStatus);  
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        st[j] = short(r._bcastSnapshot[j]._axisStatus);  
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -6635,8 +6777,16 @@ bool CanBusMotionControl::getLimitsRaw(int axis, double *min, double *max)
     int iMax=0;
     bool ret=true;
 
-    ret = ret && _readDWord (ICUBCANPROTO_POL_MC_CMD__GET_MIN_POSITION, axis, iMin);
-    ret = ret && _readDWord (ICUBCANPROTO_POL_MC_CMD__GET_MAX_POSITION, axis, iMax);
+    CanReadRequest reqs[2];
+    reqs[0].set(ICUBCANPROTO_POL_MC_CMD__GET_MIN_POSITION, axis);
+    reqs[1].set(ICUBCANPROTO_POL_MC_CMD__GET_MAX_POSITION, axis);
+
+    ret = _readPipelined(reqs, 2);
+    if (ret)
+    {
+        iMin = reqs[0].getDWord(0);
+        iMax = reqs[1].getDWord(0);
+    }
 
     *min=iMin;
     *max=iMax;
@@ -6715,11 +6865,24 @@ bool CanBusMotionControl::getRefSpeedsRaw(const int n_joint, const int *joints,
 
 bool CanBusMotionControl::getRefAccelerationsRaw(const int n_joint, const int *joints, double *accs)
 {
-    bool ret = true;
+    if (n_joint < 1)
+        return false;
+
+    CanReadRequest *reqs = new CanReadRequest[n_joint];
     for(int j=0; j<n_joint; j++)
+        reqs[j].set(ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_ACCELER, joints[j]);
+
+    bool ret = _readPipelined(reqs, n_joint);
+    if (ret)
     {
-        ret = ret && getRefAccelerationRaw(joints[j], &accs[j]);
+        for(int j=0; j<n_joint; j++)
+        {
+            _ref_accs[joints[j]] = double (reqs[j].getWord16(0));
+            accs[j] = _ref_accs[joints[j]] * 1000.0 * 1000.0;
+        }
     }
+
+    delete [] reqs;
     return ret;
 }
 
@@ -7441,6 +7604,100 @@ bool CanBusMotionControl::_readWord16Array (int msg, double *out)
     return true;
 }
 
+/// reads a list of (msg, axis) requests: all requests are sent in a single
+/// burst and the replies are collected with a single wait, instead of paying
+/// a full round trip per request. A (msg, axis) pair must appear only once.
+/// Disabled axes get a zero reply, as in _readWord16().
+bool CanBusMotionControl::_readPipelined (CanReadRequest *reqs, int n)
+{
+    CanBusResources& r = RES(system_resources);
+    bool ret = true;
+    int first = 0;
+    int k;
+
+    for (k = 0; k < n; k++)
+        reqs[k].set(reqs[k].msg, reqs[k].axis);
+
+    while (first < n)
+    {
+        int last = (n-first > PIPELINED_READ_CHUNK) ? first+PIPELINED_READ_CHUNK : n;
+
+        _mutex.wait();
+        int id;
+        if (!threadPool->getId(id))
+        {
+            yError("More than %d threads, cannot allow more\n", CANCONTROL_MAX_THREADS);
+            _mutex.post();
+            return false;
+        }
+
+        r.startPacket();
+        for (k = first; k < last; k++)
+        {
+            int axis = reqs[k].axis;
+            if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2) || axis >= r.getJoints())
+            {
+                ret = false;
+                continue;
+            }
+
+            if (!ENABLED(axis))
+            {
+                reqs[k].valid = true;
+                continue;
+            }
+
+            r.addMessage (id, axis, reqs[k].msg);
+        }
+
+        if (r._writeMessages < 1)
+        {
+            _mutex.post();
+            first = last;
+            continue;
+        }
+
+        DEBUG_FUNC("readPipelined: called from thread %d, %d requests\n", id, r._writeMessages);
+        r.writePacket();
+
+        ThreadTable2 *t=threadPool->getThreadTable(id);
+        t->setPending(r._writeMessages);
+        _mutex.post();
+        t->synch();
+
+        if (!r.getErrorStatus() || (t->timedOut()))
+        {
+            yError("readPipelined: at least one message timed out\n");
+            ret = false;
+        }
+
+        // replies which did arrive are used even if others timed out
+        for (k = first; k < last; k++)
+        {
+            int axis = reqs[k].axis;
+            if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2) || axis >= r.getJoints() || !ENABLED(axis))
+                continue;
+
+            CanMessage *m = t->getByJointAndMsg(axis, reqs[k].msg, r._destInv);
+            if (m == 0)
+            {
+                ret = false;
+                continue;
+            }
+
+            unsigned int len = m->getLen();
+            if (len > 1)
+                memcpy(reqs[k].data, m->getData()+1, (len-1 < sizeof(reqs[k].data)) ? len-1 : sizeof(reqs[k].data));
+            reqs[k].valid = true;
+        }
+
+        t->clear();
+        first = last;
+    }
+
+    return ret;
+}
+
 yarp::dev::DeviceDriver *CanBusMotionControl::createDevice(yarp::os::Searchable& config)
 {
     //analogSensor
@@ -7478,20 +7735,24 @@ bool CanBusMotionControl::getEncodersTimedRaw(double *v, double *t)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    
     double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_joint._value);
-        t[i] = r._bcastRecvBuffer[i]._position_joint._stamp;
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        stamp=0;
+        for (i = 0; i < r.getJoints(); i++) {
+            v[i] = double(r._bcastSnapshot[i]._position_joint._value);
+            t[i] = r._bcastSnapshot[i]._position_joint._stamp;
 
-        if (stamp<r._bcastRecvBuffer[i]._position_joint._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_joint._stamp;
-    }
+            if (stamp<r._bcastSnapshot[i]._position_joint._stamp)
+                stamp=r._bcastSnapshot[i]._position_joint._stamp;
+        }
+    } while (!r.endBroadcastRead(version));
 
+    _stampMutex.wait();
     stampEncoders.update(stamp);
-
-    _mutex.post();
+    _stampMutex.post();
     return true;
 }
 
@@ -7500,10 +7761,13 @@ bool CanBusMotionControl::getEncoderTimedRaw(int axis, double *v, double *t)
     CanBusResources& r = RES(system_resources);
     if (!(axis >= 0 && axis <= r.getJoints()))return false;
 
-    _mutex.wait();
-    *v = double(r._bcastRecvBuffer[axis]._position_joint._value);
-    *t = r._bcastRecvBuffer[axis]._position_joint._stamp;
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *v = double(r._bcastSnapshot[axis]._position_joint._value);
+        *t = r._bcastSnapshot[axis]._position_joint._stamp;
+    } while (!r.endBroadcastRead(version));
 
     return true;
 }
@@ -7515,12 +7779,13 @@ bool CanBusMotionControl::getInteractionModeRaw(int axis, yarp::dev::Interaction
     DEBUG_FUNC("Calling GET_INTERACTION_MODE SINGLE JOINT\n");
     CanBusResources& r = RES(system_resources);
     int temp;
-    _mutex.wait();
-
-    temp = int(r._bcastRecvBuffer[axis]._interactionmodeStatus);
-    *mode=(yarp::dev::InteractionModeEnum)from_interactionint_to_interactionvocab(temp);
-    
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        temp = int(r._bcastSnapshot[axis]._interactionmodeStatus);
+        *mode=(yarp::dev::InteractionModeEnum)from_interactionint_to_interactionvocab(temp);
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -7530,14 +7795,12 @@ bool CanBusMotionControl::getInteractionModesRaw(int n_joints, int *joints, yarp
     if (joints==0) return false;
     if (modes==0) return false;
 
-    CanBusResources& r = RES(system_resources);
     int i;
-    _mutex.wait();
+    // the single joint getter reads the broadcast snapshot, no need for _mutex
     for (i = 0; i < n_joints; i++)
     {
         getInteractionModeRaw(joints[i], &modes[i]);
     }
-    _mutex.post();
     return true;
 }
 
@@ -7547,13 +7810,16 @@ bool CanBusMotionControl::getInteractionModesRaw(yarp::dev::InteractionModeEnum*
     CanBusResources& r = RES(system_resources);
     int i;
     int temp;
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++)
+    unsigned int version;
+    do
     {
-        temp = int(r._bcastRecvBuffer[i]._interactionmodeStatus);
-        modes[i]=(yarp::dev::InteractionModeEnum)from_interactionint_to_interactionvocab(temp);
-    }
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++)
+        {
+            temp = int(r._bcastSnapshot[i]._interactionmodeStatus);
+            modes[i]=(yarp::dev::InteractionModeEnum)from_interactionint_to_interactionvocab(temp);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -7657,9 +7923,12 @@ bool CanBusMotionControl::getDutyCycleRaw(int j, double *v)
     CanBusResources& r = RES(system_resources);
     if (!(j >= 0 && j <= r.getJoints()))
         return false;
-    _mutex.wait();
-    *(v) = double(r._bcastRecvBuffer[j]._pid_value);
-    _mutex.post();
+    unsigned int version;
+    do
+    {
+        version = r.beginBroadcastRead();
+        *(v) = double(r._bcastSnapshot[j]._pid_value);
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -7668,13 +7937,15 @@ bool CanBusMotionControl::getDutyCyclesRaw(double *v)
     CanBusResources& r = RES(system_resources);
     int i;
 
-    _mutex.wait();
-    for (i = 0; i < r.getJoints(); i++)
+    unsigned int version;
+    do
     {
-        v[i] = double(r._bcastRecvBuffer[i]._pid_value);
-    }
-
-    _mutex.post();
+        version = r.beginBroadcastRead();
+        for (i = 0; i < r.getJoints(); i++)
+        {
+            v[i] = double(r._bcastSnapshot[i]._pid_value);
+        }
+    } while (!r.endBroadcastRead(version));
     return true;
 }
 
@@ -39,6 +39,7 @@
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/RateThread.h>
 #include <string>
+#include <string.h>
 #include <list>
 
 #include <iCub/FactoryInterface.h>
@@ -93,6 +94,45 @@ struct ImpedanceLimits
     double get_min_damp()  {return min_damp;}
     double get_max_damp()  {return max_damp;}
 };
+
+/**
+* One entry of a pipelined read, see CanBusMotionControl::_readPipelined().
+* The caller fills msg and axis; on return valid tells whether a reply was
+* received and data holds its payload (message id byte excluded).
+*/
+struct CanReadRequest
+{
+    int msg;
+    int axis;
+    bool valid;
+    unsigned char data[7];
+
+    CanReadRequest()
+    {
+        msg=0; axis=0; valid=false;
+        memset(data, 0, sizeof(data));
+    }
+
+    void set(int m, int a)
+    {
+        msg=m; axis=a; valid=false;
+        memset(data, 0, sizeof(data));
+    }
+
+    short getWord16(int offset) const
+    {
+        short ret;
+        memcpy(&ret, data+offset, sizeof(ret));
+        return ret;
+    }
+
+    int getDWord(int offset) const
+    {
+        int ret;
+        memcpy(&ret, data+offset, sizeof(ret));
+        return ret;
+    }
+};
 /**
 * \file CanBusMotionControl.h 
 * class for interfacing with a generic can device driver.
@@ -878,6 +918,7 @@ public:
     //helpers
     bool helper_setPosPidRaw( int j, const Pid &pid);
     bool helper_getPosPidRaw(int j, Pid *pid);
+    bool helper_getPosPidsRaw(int n, const int *axes, Pid *pids);
 
     //
     /////////////////////////////// END Position Control INTERFACE
@@ -903,6 +944,7 @@ public:
     //helper
     bool helper_setTrqPidRaw(int j, const Pid &pid);
     bool helper_getTrqPidRaw(int j, Pid *pid);
+    bool helper_getTrqPidsRaw(int n, const int *axes, Pid *pids);
     
     //
     /////////////////////////////// END Torque Control INTERFACE
@@ -1126,6 +1168,7 @@ protected:
     void *system_resources;
     yarp::os::Semaphore _mutex;
     yarp::os::Semaphore _done;
+    yarp::os::Semaphore _stampMutex; // protects stampEncoders, broadcast getters do not take _mutex
     ICanBus *canController;
 
     bool _writerequested;
@@ -1156,6 +1199,7 @@ protected:
     bool _readWord16 (int msg, int axis, short& value);
     bool _readWord16Ex (int msg, int axis, short& value1, short& value2);
     bool _readWord16Array (int msg, double *out);
+    bool _readPipelined (CanReadRequest *reqs, int n);
     bool _readDWord (int msg, int axis, int& value);
     bool _readDWordArray (int msg, double *out);
     bool _writeDWord (int msg, int axis, int value);
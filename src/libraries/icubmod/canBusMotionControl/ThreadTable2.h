@@ -98,6 +98,10 @@ public:
     //get can message from joint number
     inline yarp::dev::CanMessage *getByJoint(int j, const unsigned char *destInv);
 
+    //get can message from joint number and message id, used when
+    //several different requests were issued to the same joint
+    inline yarp::dev::CanMessage *getByJointAndMsg(int j, int msg, const unsigned char *destInv);
+
     //get n-nth message in the list of replies
     inline yarp::dev::CanMessage *get(int n);
 };
@@ -118,6 +122,21 @@ yarp::dev::CanMessage *ThreadTable2::getByJoint(int j, const unsigned char *dest
     return 0;
 }
 
+yarp::dev::CanMessage *ThreadTable2::getByJointAndMsg(int j, int msg, const unsigned char *destInv)
+{
+    for(int k=0;k<_replied && k<BUF_SIZE;k++)
+    {
+        // slots of timed out requests are marked with an invalid id
+        if (_replies[k].getId()==0xffff)
+            continue;
+        if ((_replies[k].getData()[0] & 0x7F)!=msg)
+            continue;
+        if (getJoint(_replies[k], destInv)==j)
+            return &_replies[k];
+    }
+    return 0;
+}
+
 bool ThreadTable2::push(const yarp::dev::CanMessage &m)
 {
     lock();
@@ -149,6 +168,10 @@ bool ThreadTable2::push(const yarp::dev::CanMessage &m)
 bool ThreadTable2::timeout()
 {
     lock();
+    // no reply will fill this slot, mark it so that it cannot be
+    // mistaken for a reply left over from a previous request
+    if (_replied<BUF_SIZE)
+        _replies[_replied].setId(0xffff);
     _replied++;
     _pending--;
     _timedOut++;
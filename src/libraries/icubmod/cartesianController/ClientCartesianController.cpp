@@ -1597,6 +1597,59 @@ bool ClientCartesianController::tweakGet(Bottle &options)
 }
 
 
+/************************************************************************/
+bool ClientCartesianController::askForPoses(const deque<Vector> &xd, deque<Vector> &xdhat,
+                                            deque<Vector> &qdhat, deque<double> &times,
+                                            deque<Vector> &residuals)
+{
+    if (!connected || xd.empty())
+        return false;
+
+    // targets with 3 components are solved for the position only,
+    // targets with 7 components for the full pose
+    Bottle command, reply;
+    command.addVocab(IKINCARTCTRL_VOCAB_CMD_ASK_BATCH);
+    for (size_t i=0; i<xd.size(); i++)
+    {
+        Bottle &request=command.addList();
+        addVectorOption(request,IKINCARTCTRL_VOCAB_OPT_XD,xd[i]);
+        addPoseOption(request,xd[i].length()>3?IKINCTRL_POSE_FULL:IKINCTRL_POSE_XYZ);
+    }
+
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    if ((reply.get(0).asVocab()!=IKINCARTCTRL_VOCAB_REP_ACK) ||
+        (reply.size()!=(int)xd.size()+1))
+        return false;
+
+    xdhat.assign(xd.size(),Vector());
+    qdhat.assign(xd.size(),Vector());
+    times.assign(xd.size(),0.0);
+    residuals.assign(xd.size(),Vector());
+
+    // failed requests are returned with empty solutions
+    bool ret=true;
+    for (size_t i=0; i<xd.size(); i++)
+    {
+        Vector x,o;
+        Bottle *solution=reply.get((int)i+1).asList();
+        if ((solution!=NULL) && getDesiredOption(*solution,x,o,qdhat[i]))
+        {
+            xdhat[i]=cat(x,o);
+            getSolutionInfoOption(*solution,&times[i],&residuals[i]);
+        }
+        else
+            ret=false;
+    }
+
+    return ret;
+}
+
+
 /************************************************************************/
 ClientCartesianController::~ClientCartesianController()
 {
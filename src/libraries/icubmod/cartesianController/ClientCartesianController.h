@@ -42,6 +42,7 @@
 
 #include <string>
 #include <set>
+#include <deque>
 #include <map>
 
 #include <yarp/os/all.h>
@@ -155,6 +156,11 @@ public:
     bool tweakSet(const yarp::os::Bottle &options);
     bool tweakGet(yarp::os::Bottle &options);
 
+    // not part of ICartesianControl: solve a batch of targets in one request
+    bool askForPoses(const std::deque<yarp::sig::Vector> &xd, std::deque<yarp::sig::Vector> &xdhat,
+                     std::deque<yarp::sig::Vector> &qdhat, std::deque<double> &times,
+                     std::deque<yarp::sig::Vector> &residuals);
+
     virtual ~ClientCartesianController();
 };
 
@@ -240,6 +240,7 @@ void ServerCartesianController::openPorts()
     portSlvIn.open((prefixName+"/"+slvName+"/in").c_str());
     portSlvOut.open((prefixName+"/"+slvName+"/out").c_str());
     portSlvRpc.open((prefixName+"/"+slvName+"/rpc").c_str());
+    portSlvAsk.open((prefixName+"/"+slvName+"/ask").c_str());
     portCmd->open((prefixName+"/command:i").c_str());
     portState.open((prefixName+"/state:o").c_str());
     portEvent.open((prefixName+"/events:o").c_str());
@@ -250,6 +251,28 @@ void ServerCartesianController::openPorts()
 }
 
 
+/************************************************************************/
+bool ServerCartesianController::relayAsk(const Bottle &command, Bottle &reply)
+{
+    if (!connected)
+        return false;
+
+    // queries go through a dedicated port and do not
+    // hold the control mutex, so that run() is never stalled
+    // while the solver is busy with them
+    LockGuard lg(mutexAsk);
+
+    Bottle slvCommand=command;
+    if (!portSlvAsk.write(slvCommand,reply))
+    {
+        yError("%s: unable to get reply from solver!",ctrlName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 void ServerCartesianController::closePorts()
 {
@@ -266,6 +289,7 @@ void ServerCartesianController::closePorts()
     portSlvIn.interrupt();
     portSlvOut.interrupt();
     portSlvRpc.interrupt();
+    portSlvAsk.interrupt();
     portState.interrupt();
     portEvent.interrupt();
     portRpc.interrupt();
@@ -273,6 +297,7 @@ void ServerCartesianController::closePorts()
     portSlvIn.close();
     portSlvOut.close();
     portSlvRpc.close();
+    portSlvAsk.close();
     portState.close();
     portEvent.close();
     portRpc.close();
@@ -352,15 +377,11 @@ bool ServerCartesianController::respond(const Bottle &command, Bottle &reply)
 
             //-----------------
             case IKINCARTCTRL_VOCAB_CMD_ASK:
+            case IKINCARTCTRL_VOCAB_CMD_ASK_BATCH:
             {
                 // just behave as a relay
-                Bottle slvCommand=command;
-
-                if (!portSlvRpc.write(slvCommand,reply))
-                {
-                    yError("%s: unable to get reply from solver!",ctrlName.c_str());
+                if (!relayAsk(command,reply))
                     reply.addVocab(IKINCARTCTRL_VOCAB_REP_NACK);
-                }
 
                 break;
             }
@@ -2293,6 +2314,7 @@ bool ServerCartesianController::connectToSolver()
         ok&=Network::connect((portSlvName+"/out").c_str(),portSlvIn.getName().c_str(),"udp");
         ok&=Network::connect(portSlvOut.getName().c_str(),(portSlvName+"/in").c_str(),"udp");
         ok&=Network::connect(portSlvRpc.getName().c_str(),(portSlvName+"/rpc").c_str());
+        ok&=Network::connect(portSlvAsk.getName().c_str(),(portSlvName+"/rpc").c_str());
 
         if (ok)
             yInfo("%s: Connections established with %s",ctrlName.c_str(),slvName.c_str());
@@ -2668,8 +2690,6 @@ bool ServerCartesianController::askForPose(const Vector &xd, const Vector &od,
     if (!connected)
         return false;
 
-    LockGuard lg(mutex);
-
     Bottle command, reply;
     Vector tg(xd.length()+od.length());
     for (size_t i=0; i<xd.length(); i++)
@@ -2684,10 +2704,8 @@ bool ServerCartesianController::askForPose(const Vector &xd, const Vector &od,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (relayAsk(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
-    else
-        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
 
     return ret;
 }
@@ -2701,8 +2719,6 @@ bool ServerCartesianController::askForPose(const Vector &q0, const Vector &xd,
     if (!connected)
         return false;
 
-    LockGuard lg(mutex);
-
     Bottle command, reply;
     Vector tg(xd.length()+od.length());
     for (size_t i=0; i<xd.length(); i++)
@@ -2718,10 +2734,8 @@ bool ServerCartesianController::askForPose(const Vector &q0, const Vector &xd,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (relayAsk(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
-    else
-        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
 
     return ret;
 }
@@ -2734,8 +2748,6 @@ bool ServerCartesianController::askForPosition(const Vector &xd, Vector &xdhat,
     if (!connected)
         return false;
 
-    LockGuard lg(mutex);
-
     Bottle command, reply;
     command.addVocab(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,xd);
@@ -2743,10 +2755,8 @@ bool ServerCartesianController::askForPosition(const Vector &xd, Vector &xdhat,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (relayAsk(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
-    else
-        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
 
     return ret;
 }
@@ -2760,8 +2770,6 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
     if (!connected)
         return false;
 
-    LockGuard lg(mutex);
-
     Bottle command, reply;
     command.addVocab(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,xd);
@@ -2770,10 +2778,8 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (relayAsk(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
-    else
-        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
 
     return ret;
 }
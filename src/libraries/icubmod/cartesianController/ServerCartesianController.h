@@ -176,6 +176,7 @@ protected:
     bool         syncEventEnabled;
 
     yarp::os::Mutex mutex;
+    yarp::os::Mutex mutexAsk;
     yarp::os::Event syncEvent;
     yarp::os::Stamp txInfo;
     yarp::os::Stamp poseInfo;
@@ -192,6 +193,7 @@ protected:
     yarp::os::BufferedPort<yarp::os::Bottle>   portSlvIn;
     yarp::os::BufferedPort<yarp::os::Bottle>   portSlvOut;
     yarp::os::RpcClient                        portSlvRpc;
+    yarp::os::RpcClient                        portSlvAsk;
 
     yarp::os::BufferedPort<yarp::sig::Vector>  portState;
     yarp::os::BufferedPort<yarp::os::Bottle>   portEvent;
@@ -236,6 +238,7 @@ protected:
     void   openPorts();
     void   closePorts();
     bool   respond(const yarp::os::Bottle &command, yarp::os::Bottle &reply);    
+    bool   relayAsk(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
     bool   alignJointsBounds();
     double getFeedback(yarp::sig::Vector &_fb);
     void   createController();
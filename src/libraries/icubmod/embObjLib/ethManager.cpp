@@ -26,6 +26,13 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <poll.h>
+#include <arpa/inet.h>
+#include <string.h>
+#include <limits>
+#endif
+
 using namespace yarp::dev;
 using namespace yarp::os;
 using namespace yarp::os::impl;
@@ -464,6 +471,93 @@ bool EthBoards::execute(eOipv4addr_t ipv4, void (*action)(EthResource* res, void
 }
 
 
+bool EthBoards::execute(int first, int stride, bool tx, void (*action)(EthResource* res, void* p), void* par)
+{
+    if((NULL == action) || (first < 0) || (stride <= 0))
+    {
+        return(false);
+    }
+
+    for(int i=first; i<maxEthBoards; i+=stride)
+    {
+        yarp::os::Semaphore &sem = (tx) ? (txLock[i]) : (rxLock[i]);
+        sem.wait();
+        EthResource* res = LUT[i].resource;
+        if(NULL != res)
+        {
+            action(res, par);
+        }
+        sem.post();
+    }
+
+    return(true);
+}
+
+
+bool EthBoards::get_index(eOipv4addr_t ipv4, uint8_t &index)
+{
+    index = 0;
+    eo_common_ipv4addr_to_decimal(ipv4, NULL, NULL, NULL, &index);
+    index --;
+
+    return(index<maxEthBoards);
+}
+
+
+bool EthBoards::lockRX(eOipv4addr_t ipv4, bool on)
+{
+    uint8_t index = 0;
+    if(!get_index(ipv4, index))
+    {
+        return false;
+    }
+
+    if(on)
+    {
+        rxLock[index].wait();
+    }
+    else
+    {
+        rxLock[index].post();
+    }
+
+    return true;
+}
+
+
+bool EthBoards::lockTX(eOipv4addr_t ipv4, bool on)
+{
+    uint8_t index = 0;
+    if(!get_index(ipv4, index))
+    {
+        return false;
+    }
+
+    if(on)
+    {
+        txLock[index].wait();
+    }
+    else
+    {
+        txLock[index].post();
+    }
+
+    return true;
+}
+
+
+bool EthBoards::lockTXRX(eOipv4addr_t ipv4, bool on)
+{
+    // same order as TheEthManager::lockTXRX()
+    if(on)
+    {
+        return(lockTX(ipv4, true) && lockRX(ipv4, true));
+    }
+
+    return(lockRX(ipv4, false) && lockTX(ipv4, false));
+}
+
+
 
 // - class TheEthManager
 
@@ -636,16 +730,32 @@ void ethEvalTXropframe(EthResource *r, void* p)
 
 bool TheEthManager::Transmission(void)
 {
-    lockTX(true);
+    // every board is protected by its own tx lock. the tx workers (if any) prepare and send the packets of their boards
+    // in parallel with us.
+    int stride = txWorkers.size() + 1;
+
+    for(size_t w=0; w<txWorkers.size(); w++)
+    {
+        txWorkers[w]->triggerTransmission();
+    }
 
-    ethBoards->execute(ethEvalTXropframe, this);
+    processTXslice(0, stride);
 
-    lockTX(false);
+    for(size_t w=0; w<txWorkers.size(); w++)
+    {
+        txWorkers[w]->waitDone();
+    }
 
     return true;
 }
 
 
+void TheEthManager::processTXslice(int first, int stride)
+{
+    ethBoards->execute(first, stride, true, ethEvalTXropframe, this);
+}
+
+
 void ethEvalPresence(EthResource *r, void* p)
 {
     if((NULL == r) || (NULL == p))
@@ -658,7 +768,8 @@ void ethEvalPresence(EthResource *r, void* p)
 
 bool TheEthManager::CheckPresence(void)
 {
-    ethBoards->execute(ethEvalPresence, this);
+    // the presence of a board is updated also by the reception, thus we use the rx lock of each board
+    ethBoards->execute(0, 1, false, ethEvalPresence, this);
     return true;
 }
 
@@ -942,7 +1053,9 @@ EthResource *TheEthManager::requestResource2(IethResource *interface, yarp::os::
 
         if(true == rr->open2(ipv4addr, cfgtotal))
         {
+            ethBoards->lockTXRX(ipv4addr, true);
             ethBoards->add(rr);
+            ethBoards->lockTXRX(ipv4addr, false);
         }
         else
         {
@@ -961,7 +1074,9 @@ EthResource *TheEthManager::requestResource2(IethResource *interface, yarp::os::
     }
 
 
+    ethBoards->lockTXRX(ipv4addr, true);
     ethBoards->add(rr, interface);
+    ethBoards->lockTXRX(ipv4addr, false);
 
 
     lockTXRX(false);
@@ -1042,9 +1157,13 @@ int TheEthManager::releaseResource2(EthResource* ethresource, IethResource* inte
     // the ropframe sent now do not contain any regular for the interface anymore, thus we can just removing the interface in list of those assciated
     // to the resource, without any harm. only thing is: protect ethBoards with a mutex.
 
-    // now we change internal data structure of ethBoards, thus .. must disable tx and rx
+    // now we change internal data structure of ethBoards, thus .. must disable tx and rx.
+    // the global locks protect vs other requests / releases, the locks of the board vs the rx and tx threads.
     lockTXRX(true);
 
+    eOipv4addr_t ipv4addr = rr->getIPv4remoteAddress();
+    ethBoards->lockTXRX(ipv4addr, true);
+
     // remove the interface
     ethBoards->rem(rr, type);
 
@@ -1053,6 +1172,12 @@ int TheEthManager::releaseResource2(EthResource* ethresource, IethResource* inte
     {   // remove also the resource
         rr->close();
         ethBoards->rem(rr);
+    }
+
+    ethBoards->lockTXRX(ipv4addr, false);
+
+    if(0 == remaining)
+    {
         delete rr;
     }
 
@@ -1143,6 +1268,29 @@ bool TheEthManager::createCommunicationObjects(ACE_INET_Addr localaddress, int t
             sender = new EthSender(txrate);
             receiver = new EthReceiver(rxrate);
 
+            // the user can process the boards in parallel by environment variable ETHMANAGER_WORKERS
+            int numofworkers = 0;
+            ConstString _workers = NetworkBase::getEnvironment("ETHMANAGER_WORKERS");
+            if(_workers != "")
+            {
+                numofworkers = NetType::toInt(_workers);
+            }
+            if((numofworkers < 0) || (numofworkers > EthWorker::EthWorkerMaxNumber))
+            {
+                numofworkers = 0;
+            }
+            for(int w=0; w<numofworkers; w++)
+            {
+                rxWorkers.push_back(new EthWorker(this, w+1, numofworkers+1));
+                txWorkers.push_back(new EthWorker(this, w+1, numofworkers+1));
+                rxWorkers.back()->start();
+                txWorkers.back()->start();
+            }
+            if(numofworkers > 0)
+            {
+                yDebug() << "TheEthManager::createCommunicationObjects() processes rx and tx of the boards with" << numofworkers << "workers each";
+            }
+
             sender->config(UDP_socket, this);
             receiver->config(UDP_socket, this);
 
@@ -1202,6 +1350,19 @@ bool TheEthManager::stopCommunicationThreads()
     {
         receiver->stop();
     }
+    // the workers are used only by sender and receiver
+    for(size_t w=0; w<rxWorkers.size(); w++)
+    {
+        rxWorkers[w]->stop();
+        delete rxWorkers[w];
+    }
+    rxWorkers.clear();
+    for(size_t w=0; w<txWorkers.size(); w++)
+    {
+        txWorkers[w]->stop();
+        delete txWorkers[w];
+    }
+    txWorkers.clear();
     return ret;
 }
 
@@ -1224,7 +1385,53 @@ bool TheEthManager::Reception(ACE_INET_Addr adr, uint64_t* data, ssize_t size, b
 
     eOipv4addr_t ipv4addr = eo_common_ipv4addr(ip1, ip2, ip3, ip4);
 
-    lockRX(true);
+    dispatchRXpacket(ipv4addr, data, size, collectStatistics);
+
+    return(true);
+}
+
+
+bool TheEthManager::Reception(const eOipv4addr_t *ipv4addrs, uint64_t **data, const ssize_t *sizes, int num, bool collectStatistics)
+{
+    // the rx workers (if any) process in parallel with us the packets of their boards
+    int stride = rxWorkers.size() + 1;
+
+    for(size_t w=0; w<rxWorkers.size(); w++)
+    {
+        rxWorkers[w]->triggerReception(ipv4addrs, data, sizes, num, collectStatistics);
+    }
+
+    processRXslice(ipv4addrs, data, sizes, num, collectStatistics, 0, stride);
+
+    for(size_t w=0; w<rxWorkers.size(); w++)
+    {
+        rxWorkers[w]->waitDone();
+    }
+
+    return(true);
+}
+
+
+void TheEthManager::processRXslice(const eOipv4addr_t *ipv4addrs, uint64_t **data, const ssize_t *sizes, int num, bool collectStatistics, int first, int stride)
+{
+    for(int i=0; i<num; i++)
+    {
+        uint8_t index = 0;
+        if((1 == stride) || (EthBoards::get_index(ipv4addrs[i], index) && (first == (index % stride))))
+        {
+            dispatchRXpacket(ipv4addrs[i], data[i], sizes[i], collectStatistics);
+        }
+    }
+}
+
+
+void TheEthManager::dispatchRXpacket(eOipv4addr_t ipv4addr, uint64_t* data, ssize_t size, bool collectStatistics)
+{
+    // the rx lock of the board protects its EthResource vs its removal and vs the check of presence
+    if(false == ethBoards->lockRX(ipv4addr, true))
+    {   // not the address of a board
+        return;
+    }
 
     EthResource* r = ethBoards->get_resource(ipv4addr);
 
@@ -1248,10 +1455,7 @@ bool TheEthManager::Reception(ACE_INET_Addr adr, uint64_t* data, ssize_t size, b
     //    yError() << "TheEthManager::Reception cannot get a ethres associated to address" << address;
     }
 
-    lockRX(false);
-
-
-    return(true);
+    ethBoards->lockRX(ipv4addr, false);
 }
 
 
@@ -1426,10 +1630,43 @@ EthReceiver::EthReceiver(int raterx): RateThread(raterx)
     {
         statPrintInterval = 0.0;
     }
+
+    // the batch mode is enabled by environment variable ETHRECEIVER_BATCH_MODE
+    batchMode = false;
+    stopRequested = 0;
+#if defined(__linux__)
+    batchSize = EthReceiverDefaultBatchSize;
+    ConstString mode = NetworkBase::getEnvironment("ETHRECEIVER_BATCH_MODE");
+    if ((mode != "") && (NetType::toInt(mode) != 0))
+    {
+        batchMode = true;
+    }
+#endif
+}
+
+// the stop request is written by the thread which stops the receiver and read by the rx thread
+static inline void ethSetFlag(volatile long *flag, long value)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange(flag, value);
+#else
+    __sync_lock_test_and_set(flag, value);
+    __sync_synchronize();
+#endif
+}
+
+static inline long ethGetFlag(volatile long *flag)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange(flag, 0, 0);
+#else
+    return __sync_fetch_and_add(flag, 0);
+#endif
 }
 
 void EthReceiver::onStop()
 {
+    ethSetFlag(&stopRequested, 1);
     // in here i send a small packet to ... myself ?
     uint8_t tmp = 0;
     ethManager->sendPacket( &tmp, 1, ethManager->getLocalIPaddress());
@@ -1474,10 +1711,79 @@ bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
 
     yWarning() << "in EthReceiver::config() the config socket has queue size = "<< sock_input_buf_size<< "; you request ETHRECEIVER_BUFFER_SIZE=" << _dgram_buffer_size;
 
+#if defined(__linux__)
+    if(batchMode)
+    {
+        batchMode = configBatchMode();
+    }
+#endif
+
     return true;
 }
 
 
+#if defined(__linux__)
+
+bool EthReceiver::configBatchMode(void)
+{
+    // the user can change the number of packets read with a single recvmmsg() by environment variable ETHRECEIVER_BATCH_SIZE
+    ConstString _batch_size = NetworkBase::getEnvironment("ETHRECEIVER_BATCH_SIZE");
+    if (_batch_size != "")
+    {
+        batchSize = NetType::toInt(_batch_size);
+    }
+    if((batchSize <= 0) || (batchSize > EthReceiverMaxBatchSize))
+    {
+        batchSize = EthReceiverDefaultBatchSize;
+    }
+
+    const size_t pktwords = EthResource::maxRXpacketsize/8;
+    const size_t ctrlsize = CMSG_SPACE(sizeof(uint32_t));
+
+    batchData.assign(batchSize*pktwords, 0);
+    batchMsgs.resize(batchSize);
+    batchIov.resize(batchSize);
+    batchAddr.resize(batchSize);
+    batchCtrl.assign(batchSize*ctrlsize, 0);
+    batchIPv4.resize(batchSize);
+    batchPkts.resize(batchSize);
+    batchSizes.resize(batchSize);
+
+    for(int i=0; i<batchSize; i++)
+    {
+        batchPkts[i] = &batchData[i*pktwords];
+        batchIov[i].iov_base = batchPkts[i];
+        batchIov[i].iov_len = EthResource::maxRXpacketsize;
+        memset(&batchMsgs[i], 0, sizeof(struct mmsghdr));
+        batchMsgs[i].msg_hdr.msg_name = &batchAddr[i];
+        batchMsgs[i].msg_hdr.msg_iov = &batchIov[i];
+        batchMsgs[i].msg_hdr.msg_iovlen = 1;
+        batchMsgs[i].msg_hdr.msg_control = &batchCtrl[i*ctrlsize];
+    }
+
+    // ask the kernel to tell us how many packets it drops because the socket queue is full
+#if defined(SO_RXQ_OVFL)
+    int one = 1;
+    if(0 != setsockopt(recv_socket->get_handle(), SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)))
+    {
+        yWarning() << "in EthReceiver::configBatchMode() cannot set SO_RXQ_OVFL: the count of dropped packets is not available";
+    }
+#endif
+
+    memset(&batchStats, 0, sizeof(batchStats));
+    for(int i=0; i<256; i++)
+    {
+        minFrameDelay[i] = std::numeric_limits<int64_t>::max();
+    }
+
+    yDebug() << "EthReceiver uses the batch mode with up to" << batchSize << "packets per recvmmsg()";
+
+    return true;
+}
+
+#endif
+
+
 bool EthReceiver::threadInit()
 {
     yTrace() << "Do some initialization here if needed";
@@ -1506,6 +1812,14 @@ uint64_t getRopFrameAge(char *pck)
 
 void EthReceiver::run()
 {
+#if defined(__linux__)
+    if(batchMode)
+    {
+        runBatchMode();
+        return;
+    }
+#endif
+
     ssize_t       incoming_msg_size = 0;
     ACE_INET_Addr sender_addr;
     uint64_t      incoming_msg_data[EthResource::maxRXpacketsize/8];   // 8-byte aligned local buffer for incoming packet: it must be able to accomodate max size of packet
@@ -1551,5 +1865,227 @@ void EthReceiver::run()
 }
 
 
+#if defined(__linux__)
+
+bool EthReceiver::isStopRequested(void)
+{
+    // isStopping() covers a stop() which does not go through onStop()
+    return (0 != ethGetFlag(&stopRequested)) || isStopping();
+}
+
+void EthReceiver::runBatchMode(void)
+{
+    // we stay in here until the thread is stopped: onStop() wakes us up by sending a packet to our socket, but
+    // the request is checked also at every poll() timeout (at most the period of the thread) and after every recvmmsg(),
+    // so that the loop ends even if that packet is lost or the socket is flooded.
+    // the check on presence of the eth boards is done at the rate of the thread.
+    const int sockfd = recv_socket->get_handle();
+    const size_t ctrlsize = CMSG_SPACE(sizeof(uint32_t));
+    const double period = 0.001 * rateofthread;
+    const bool collectStatistics = (statPrintInterval > 0) ? true : false;
+
+    struct pollfd pfd;
+    pfd.fd = sockfd;
+    pfd.events = POLLIN;
+
+    double now = yarp::os::Time::now();
+    double nextCheck = now + period;
+    double nextPrint = now + statPrintInterval;
+
+    while(!isStopRequested())
+    {
+        int timeout = (int)(1000.0 * (nextCheck - now));
+        if(timeout < 0)
+        {
+            timeout = 0;
+        }
+
+        int ret = poll(&pfd, 1, timeout);
+        if((ret > 0) && (pfd.revents & POLLIN))
+        {
+            // drain the socket: we stop when a batch is not full
+            int n = batchSize;
+            while((n == batchSize) && !isStopRequested())
+            {
+                for(int i=0; i<batchSize; i++)
+                {   // recvmmsg() overwrites the lengths
+                    batchMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+                    batchMsgs[i].msg_hdr.msg_controllen = ctrlsize;
+                }
+
+                n = recvmmsg(sockfd, &batchMsgs[0], batchSize, MSG_DONTWAIT, NULL);
+                if(n <= 0)
+                {
+                    break;
+                }
+
+                int64_t hosttime = (int64_t)(1000000.0 * yarp::os::Time::now());
+
+                for(int i=0; i<n; i++)
+                {
+                    uint32_t a32 = ntohl(batchAddr[i].sin_addr.s_addr);
+                    batchIPv4[i] = eo_common_ipv4addr((a32 >> 24) & 0xff, (a32 >> 16) & 0xff, (a32 >> 8) & 0xff, a32 & 0xff);
+                    batchSizes[i] = batchMsgs[i].msg_len;
+
+#if defined(SO_RXQ_OVFL)
+                    for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&batchMsgs[i].msg_hdr); NULL != cmsg; cmsg = CMSG_NXTHDR(&batchMsgs[i].msg_hdr, cmsg))
+                    {
+                        if((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL))
+                        {
+                            memcpy(&batchStats.kernelDrops, CMSG_DATA(cmsg), sizeof(uint32_t));
+                        }
+                    }
+#endif
+
+                    if(collectStatistics && (batchSizes[i] >= 24))
+                    {   // a ropframe has a header of 24 bytes which contains its age in the clock of the board:
+                        // we measure it vs the minimum delay seen for the same board
+                        int64_t delay = hosttime - (int64_t)getRopFrameAge((char*)batchPkts[i]);
+                        int64_t &mindelay = minFrameDelay[a32 & 0xff];
+                        if(delay < mindelay)
+                        {
+                            mindelay = delay;
+                        }
+                        double age = (double)(delay - mindelay);
+                        batchStats.ageSum += age;
+                        batchStats.ageCount++;
+                        if(age > batchStats.ageMax)
+                        {
+                            batchStats.ageMax = age;
+                        }
+                    }
+                }
+
+                ethManager->Reception(&batchIPv4[0], &batchPkts[0], &batchSizes[0], n, collectStatistics);
+
+                batchStats.packets += n;
+                batchStats.batches++;
+                if(n == batchSize)
+                {
+                    batchStats.fullBatches++;
+                }
+                if(n > batchStats.maxBatch)
+                {
+                    batchStats.maxBatch = n;
+                }
+            }
+        }
+        else if((ret < 0) && (errno != EINTR))
+        {
+            yError() << "EthReceiver::runBatchMode() fails in poll() with errno" << errno;
+            yarp::os::Time::delay(period);
+        }
+
+        now = yarp::os::Time::now();
+        if(now >= nextCheck)
+        {
+            // execute the check on presence of all eth boards.
+            ethManager->CheckPresence();
+            nextCheck = now + period;
+        }
+
+        if(collectStatistics && (now >= nextPrint))
+        {
+            printBatchStatistics();
+            nextPrint = now + statPrintInterval;
+        }
+    }
+}
+
+
+void EthReceiver::printBatchStatistics(void)
+{
+    double avgBatch = (batchStats.batches > 0) ? ((double)batchStats.packets / batchStats.batches) : 0.0;
+    double avgAge = (batchStats.ageCount > 0) ? (batchStats.ageSum / batchStats.ageCount) : 0.0;
+
+    yDebug() << "EthReceiver batch statistics: packets =" << batchStats.packets << ", batches =" << batchStats.batches
+             << ", avg batch =" << avgBatch << ", max batch =" << batchStats.maxBatch << ", full batches =" << batchStats.fullBatches
+             << ", kernel drops =" << batchStats.kernelDrops
+             << ", ropframe age (usec) avg =" << avgAge << ", max =" << batchStats.ageMax;
+
+    // the count of kernel drops is cumulative and it is not reset
+    uint32_t drops = batchStats.kernelDrops;
+    memset(&batchStats, 0, sizeof(batchStats));
+    batchStats.kernelDrops = drops;
+}
+
+#endif
+
+
+
+// -- class EthWorker
+// -- here is it code
+
+EthWorker::EthWorker(TheEthManager* _ethManager, int _first, int _stride) : startSem(0), doneSem(0)
+{
+    ethManager = _ethManager;
+    first = _first;
+    stride = _stride;
+
+    job = jobReception;
+    ipv4addrs = NULL;
+    data = NULL;
+    sizes = NULL;
+    num = 0;
+    collectStatistics = false;
+}
+
+EthWorker::~EthWorker()
+{
+
+}
+
+void EthWorker::triggerReception(const eOipv4addr_t *_ipv4addrs, uint64_t **_data, const ssize_t *_sizes, int _num, bool _collectStatistics)
+{
+    job = jobReception;
+    ipv4addrs = _ipv4addrs;
+    data = _data;
+    sizes = _sizes;
+    num = _num;
+    collectStatistics = _collectStatistics;
+    startSem.post();
+}
+
+void EthWorker::triggerTransmission(void)
+{
+    job = jobTransmission;
+    startSem.post();
+}
+
+void EthWorker::waitDone(void)
+{
+    doneSem.wait();
+}
+
+void EthWorker::run()
+{
+    for(;;)
+    {
+        startSem.wait();
+        if(isStopping())
+        {
+            break;
+        }
+
+        if(jobReception == job)
+        {
+            ethManager->processRXslice(ipv4addrs, data, sizes, num, collectStatistics, first, stride);
+        }
+        else
+        {
+            ethManager->processTXslice(first, stride);
+        }
+
+        doneSem.post();
+    }
+}
+
+void EthWorker::onStop()
+{
+    // wake up the thread so that it can exit
+    startSem.post();
+}
+
+
 
 // eof
@@ -38,6 +38,12 @@
 #include <stdio.h>
 #include <map>
 
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#endif
+
 
 // ACE includes
 #include <ace/ACE.h>
@@ -52,6 +58,7 @@
 #include <yarp/dev/DeviceDriver.h>
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/os/RateThread.h>
+#include <yarp/os/Thread.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/Time.h>
@@ -122,6 +129,19 @@ public:
     // executes an action on the ethResource having a specific ipv4.
     bool execute(eOipv4addr_t ipv4, void (*action)(EthResource* res, void* p), void* par);
 
+    // executes an action on the EthResource of the boards with index first, first+stride, first+2*stride, etc.
+    // the action on each board is done with the rx or tx lock of that board taken.
+    bool execute(int first, int stride, bool tx, void (*action)(EthResource* res, void* p), void* par);
+
+    // per-board locks. the rx (tx) lock of a board protects its EthResource vs concurrent use in reception (transmission)
+    // and vs its addition / removal. they return false if the ipv4 cannot be the address of a board.
+    bool lockRX(eOipv4addr_t ipv4, bool on);
+    bool lockTX(eOipv4addr_t ipv4, bool on);
+    bool lockTXRX(eOipv4addr_t ipv4, bool on);
+
+    // the index of the board with a given ipv4 (it does not need the board to be added). it returns false if it is not valid.
+    static bool get_index(eOipv4addr_t ipv4, uint8_t &index);
+
 
 private:
 
@@ -152,6 +172,9 @@ private:
     int sizeofLUT;
     ethboardProperties_t LUT[EthBoards::maxEthBoards];
 
+    yarp::os::Semaphore rxLock[EthBoards::maxEthBoards];
+    yarp::os::Semaphore txLock[EthBoards::maxEthBoards];
+
 private:
 
     // private functions
@@ -169,6 +192,7 @@ private:
 // forward declaration because they are used inside TheEthManager
 class EthSender;
 class EthReceiver;
+class EthWorker;
 
 class yarp::dev::TheEthManager: public DeviceDriver
 //class yarp::dev::TheEthManager
@@ -219,6 +243,13 @@ public:
 
     bool Reception(ACE_INET_Addr adr, uint64_t* data, ssize_t size, bool collectStatistics);
 
+    // it gives a batch of received packets to the boards. if there are workers, the packets of different boards are processed in parallel.
+    bool Reception(const eOipv4addr_t *ipv4addrs, uint64_t **data, const ssize_t *sizes, int num, bool collectStatistics);
+
+    // they process the received packets / prepare and transmit the packets of the boards with index first, first+stride, etc.
+    void processRXslice(const eOipv4addr_t *ipv4addrs, uint64_t **data, const ssize_t *sizes, int num, bool collectStatistics, int first, int stride);
+    void processTXslice(int first, int stride);
+
     EthResource* getEthResource(eOipv4addr_t ipv4);
 
     IethResource* getInterface(eOipv4addr_t ipv4, eOprotID32_t id32);
@@ -245,6 +276,8 @@ private:
     bool lockRX(bool on);
     bool lockTXRX(bool on);
 
+    void dispatchRXpacket(eOipv4addr_t ipv4addr, uint64_t* data, ssize_t size, bool collectStatistics);
+
 
 private:
 
@@ -271,6 +304,10 @@ private:
     EthReceiver* receiver;
     ACE_SOCK_Dgram* UDP_socket;
 
+    // optional threads which process rx packets and tx packets of different boards in parallel (environment variable ETHMANAGER_WORKERS)
+    vector<EthWorker*> rxWorkers;
+    vector<EthWorker*> txWorkers;
+
 };
 
 
@@ -304,6 +341,8 @@ public:
 // -- class EthReceiver
 // -- it is a rate thread created by singleton TheEthManager.
 // -- it regularly wakes up to see if a packet is in its listening socket and it parses that with methods made available by TheEthManager.
+// -- on linux, if the environment variable ETHRECEIVER_BATCH_MODE is set to 1, it instead blocks on the socket and as soon as
+// -- packets arrive it drains them in batches with recvmmsg(), giving each batch to TheEthManager with a single rx lock.
 
 class EthReceiver : public yarp::os::RateThread
 {
@@ -314,10 +353,46 @@ private:
     TheEthManager                   *ethManager;
     double                          statPrintInterval;
 
+    bool                            batchMode;
+    volatile long                   stopRequested;     // written by onStop() and read by the rx thread only with atomic operations
+
+#if defined(__linux__)
+    // buffers used by recvmmsg(): one entry per packet of the batch
+    int                             batchSize;
+    std::vector<uint64_t>           batchData;
+    std::vector<struct mmsghdr>     batchMsgs;
+    std::vector<struct iovec>       batchIov;
+    std::vector<struct sockaddr_in> batchAddr;
+    std::vector<uint8_t>            batchCtrl;
+    std::vector<eOipv4addr_t>       batchIPv4;
+    std::vector<uint64_t*>          batchPkts;
+    std::vector<ssize_t>            batchSizes;
+
+    // statistics of the batch mode, printed every statPrintInterval seconds
+    struct BatchStatistics
+    {
+        uint64_t    packets;
+        uint64_t    batches;
+        uint64_t    fullBatches;        // batches which filled all the buffers
+        int         maxBatch;
+        uint32_t    kernelDrops;        // packets dropped by the kernel since the socket was opened (SO_RXQ_OVFL)
+        uint64_t    ageCount;
+        double      ageSum;             // age of the ropframes in excess of the minimum observed one (per board), in usec
+        double      ageMax;
+    };
+    BatchStatistics                 batchStats;
+    int64_t                         minFrameDelay[256];     // per board (last byte of ip), host time - ropframe age in usec
+
+    bool configBatchMode(void);
+    bool isStopRequested(void);
+    void runBatchMode(void);
+    void printBatchStatistics(void);
+#endif
 
 public:
 
     enum { EthReceiverDefaultRate = 5, EthReceiverMaxRate = 20 };
+    enum { EthReceiverDefaultBatchSize = 32, EthReceiverMaxBatchSize = 256 };
 
     EthReceiver(int rxrate);
     ~EthReceiver();
@@ -329,6 +404,44 @@ public:
 
 
 
+// -- class EthWorker
+// -- it is a thread created by singleton TheEthManager if the environment variable ETHMANAGER_WORKERS is > 0.
+// -- it serves the boards whose index modulo stride is equal to first, so that the packets of a board are always processed
+// -- in order by the same thread. the thread which triggers the workers serves the boards with first = 0.
+
+class EthWorker : public yarp::os::Thread
+{
+private:
+    enum { jobReception = 0, jobTransmission = 1 };
+
+    TheEthManager                   *ethManager;
+    int                             first;
+    int                             stride;
+
+    int                             job;
+    const eOipv4addr_t              *ipv4addrs;
+    uint64_t                        **data;
+    const ssize_t                   *sizes;
+    int                             num;
+    bool                            collectStatistics;
+
+    yarp::os::Semaphore             startSem;
+    yarp::os::Semaphore             doneSem;
+
+public:
+
+    enum { EthWorkerMaxNumber = 7 };
+
+    EthWorker(TheEthManager* _ethManager, int _first, int _stride);
+    ~EthWorker();
+    void triggerReception(const eOipv4addr_t *_ipv4addrs, uint64_t **_data, const ssize_t *_sizes, int _num, bool _collectStatistics);
+    void triggerTransmission(void);
+    void waitDone(void);
+    void run();
+    void onStop();
+};
+
+
 #endif
 
 // eof
@@ -879,9 +879,15 @@ void HostTransceiver::eoprot_override_mc(void)
             EO_INIT(.tag)           eoprot_tag_mc_joint_status_addinfo_multienc,
             EO_INIT(.init)          NULL,
             EO_INIT(.update)        eoprot_fun_UPDT_mc_joint_status_addinfo_multienc
-        }
+        },
         // motor
-        // nothing so far
+        {   // motor_status_basic: used to inform the motioncontrol device that a sig<> ROP about motor status has arrived. for .. updating its snapshot of the status
+            EO_INIT(.endpoint)      eoprot_endpoint_motioncontrol,
+            EO_INIT(.entity)        eoprot_entity_mc_motor,
+            EO_INIT(.tag)           eoprot_tag_mc_motor_status_basic,
+            EO_INIT(.init)          NULL,
+            EO_INIT(.update)        eoprot_fun_UPDT_mc_motor_status_basic
+        }
 
         // comment: the functions eoprot_fun_UPDT_mc_joint_status_core() and eoprot_fun_UPDT_mc_joint_status() update the same _encodersStamp[]
         // variables. only one of those two id32 variables are regularly sig<>-led.
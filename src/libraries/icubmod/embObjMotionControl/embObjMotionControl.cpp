@@ -409,6 +409,16 @@ bool embObjMotionControl::alloc(int nj)
 
     _angleToEncoder = allocAndCheck<double>(nj);
     _encodersStamp = allocAndCheck<double>(nj);
+    _statusJointPosition = allocAndCheck<double>(nj);
+    _statusJointVelocity = allocAndCheck<double>(nj);
+    _statusJointAcceleration = allocAndCheck<double>(nj);
+    _statusJointStamp = allocAndCheck<double>(nj);
+    _statusMotorPosition = allocAndCheck<double>(nj);
+    _statusMotorVelocity = allocAndCheck<double>(nj);
+    _statusMotorAcceleration = allocAndCheck<double>(nj);
+    _statusMotorCurrent = allocAndCheck<double>(nj);
+    _statusJointPublished = allocAndCheck<bool>(nj);
+    _statusMotorPublished = allocAndCheck<bool>(nj);
     _jointEncoderType = allocAndCheck<uint8_t>(nj);
     _rotorEncoderType = allocAndCheck<uint8_t>(nj);
     _jointEncoderRes = allocAndCheck<int>(nj);
@@ -460,6 +470,16 @@ bool embObjMotionControl::dealloc()
     checkAndDestroy(_axisMap);
     checkAndDestroy(_angleToEncoder);
     checkAndDestroy(_encodersStamp);
+    checkAndDestroy(_statusJointPosition);
+    checkAndDestroy(_statusJointVelocity);
+    checkAndDestroy(_statusJointAcceleration);
+    checkAndDestroy(_statusJointStamp);
+    checkAndDestroy(_statusMotorPosition);
+    checkAndDestroy(_statusMotorVelocity);
+    checkAndDestroy(_statusMotorAcceleration);
+    checkAndDestroy(_statusMotorCurrent);
+    checkAndDestroy(_statusJointPublished);
+    checkAndDestroy(_statusMotorPublished);
     checkAndDestroy(_jointEncoderRes);
     checkAndDestroy(_rotorEncoderRes);
     checkAndDestroy(_jointEncoderType);
@@ -551,6 +571,19 @@ embObjMotionControl::embObjMotionControl() :
     _njoints      = 0;
     _axisMap      = NULL;
     _encodersStamp = NULL;
+    _statusVersion = 0;
+    _statusJointPosition = NULL;
+    _statusJointVelocity = NULL;
+    _statusJointAcceleration = NULL;
+    _statusJointStamp = NULL;
+    _statusMotorPosition = NULL;
+    _statusMotorVelocity = NULL;
+    _statusMotorAcceleration = NULL;
+    _statusMotorCurrent = NULL;
+    _statusJointPublished = NULL;
+    _statusMotorPublished = NULL;
+    _statusJointsReady = 0;
+    _statusMotorsReady = 0;
     _angleToEncoder = NULL;
     _twofocinfo = NULL;
     _cacheImpedance   = NULL;
@@ -1742,6 +1775,16 @@ bool embObjMotionControl::update(eOprotID32_t id32, double timestamp, void *rxda
     // if the tag is eoprot_tag_mc_joint_status_basic, then rxdata is of type eOmc_joint_status_basic_t*
 
 
+    // the status of a motor is only published in the snapshot
+    if(eoprot_entity_mc_motor == eoprot_ID2entity(id32))
+    {
+        if((true == initialised()) && (eoprot_tag_mc_motor_status_basic == eoprot_ID2tag(id32)) && (NULL != rxdata))
+        {
+            publishMotorStatus(joint, (const eOmc_motor_status_basic_t*) rxdata);
+        }
+        return true;
+    }
+
     // for the case of id32 which contains an encoder value .... we refresh the timestamp of that encoder
 
     if(true == initialised())
@@ -1749,11 +1792,109 @@ bool embObjMotionControl::update(eOprotID32_t id32, double timestamp, void *rxda
         _mutex.wait();
         _encodersStamp[joint] = timestamp;
         _mutex.post();
+
+        if((eoprot_tag_mc_joint_status_core == eoprot_ID2tag(id32)) && (NULL != rxdata))
+        {
+            publishJointStatus(joint, (const eOmc_joint_status_core_t*) rxdata, timestamp);
+        }
     }
 
     return true;
 }
 
+
+// full memory barrier used by the seqlock of the status snapshot
+static inline void statusBarrier(void)
+{
+#if defined(_MSC_VER)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+
+void embObjMotionControl::publishJointStatus(int j, const eOmc_joint_status_core_t *core, double timestamp)
+{
+    // it is called only by the rx thread of the board, thus there is a single writer
+    if((j < 0) || (j >= _njoints))
+    {
+        return;
+    }
+
+    _statusVersion++;
+    statusBarrier();
+    _statusJointPosition[j] = (double) core->measures.meas_position;
+    _statusJointVelocity[j] = (double) core->measures.meas_velocity;
+    _statusJointAcceleration[j] = (double) core->measures.meas_acceleration;
+    _statusJointStamp[j] = timestamp;
+    if(false == _statusJointPublished[j])
+    {   // the counter is published within the seqlock, so that readers see it consistently with the arrays
+        _statusJointPublished[j] = true;
+        _statusJointsReady++;
+    }
+    statusBarrier();
+    _statusVersion++;
+}
+
+
+void embObjMotionControl::publishMotorStatus(int m, const eOmc_motor_status_basic_t *status)
+{
+    if((m < 0) || (m >= _njoints))
+    {
+        return;
+    }
+
+    _statusVersion++;
+    statusBarrier();
+    _statusMotorPosition[m] = (double) status->mot_position;
+    _statusMotorVelocity[m] = (double) status->mot_velocity;
+    _statusMotorAcceleration[m] = (double) status->mot_acceleration;
+    _statusMotorCurrent[m] = (double) status->mot_current;
+    if(false == _statusMotorPublished[m])
+    {
+        _statusMotorPublished[m] = true;
+        _statusMotorsReady++;
+    }
+    statusBarrier();
+    _statusVersion++;
+}
+
+
+bool embObjMotionControl::readStatusSnapshot(const volatile int *ready, const double *src1, double *dst1, const double *src2, double *dst2)
+{
+    // it copies one (or two) arrays of the snapshot of all the joints. it returns false if the snapshot is not ready yet
+    // or if it cannot be read consistently within a bounded number of attempts (e.g., the rx thread was preempted in
+    // the middle of a write): in both cases the caller falls back to the buffered values, which are read under lock.
+    const int maxAttempts = 64;
+
+    for(int attempt=0; attempt<maxAttempts; attempt++)
+    {
+        uint32_t version = _statusVersion;
+        if(0 != (version & 1))
+        {   // the rx thread is writing: it takes only a few instructions
+            continue;
+        }
+        statusBarrier();
+        if(*ready != _njoints)
+        {
+            return false;
+        }
+        memcpy(dst1, src1, _njoints*sizeof(double));
+        if(NULL != src2)
+        {
+            memcpy(dst2, src2, _njoints*sizeof(double));
+        }
+        statusBarrier();
+        if(version == _statusVersion)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 eoThreadFifo * embObjMotionControl::getFifo(uint32_t variableProgNum)
 {
     return requestQueue->getFifo(variableProgNum);
@@ -2936,6 +3077,11 @@ bool embObjMotionControl::getEncoderRaw(int j, double *value)
 
 bool embObjMotionControl::getEncodersRaw(double *encs)
 {
+    if(readStatusSnapshot(&_statusJointsReady, _statusJointPosition, encs))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -2962,6 +3108,11 @@ bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
 
 bool embObjMotionControl::getEncoderSpeedsRaw(double *spds)
 {
+    if(readStatusSnapshot(&_statusJointsReady, _statusJointVelocity, spds))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -2986,6 +3137,11 @@ bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
 
 bool embObjMotionControl::getEncoderAccelerationsRaw(double *accs)
 {
+    if(readStatusSnapshot(&_statusJointsReady, _statusJointAcceleration, accs))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -2998,6 +3154,12 @@ bool embObjMotionControl::getEncoderAccelerationsRaw(double *accs)
 
 bool embObjMotionControl::getEncodersTimedRaw(double *encs, double *stamps)
 {
+    // the snapshot gives positions and timestamps which are consistent with each other
+    if(readStatusSnapshot(&_statusJointsReady, _statusJointPosition, encs, _statusJointStamp, stamps))
+    {
+        return true;
+    }
+
     bool ret = getEncodersRaw(encs);
     _mutex.wait();
     for(int i=0; i<_njoints; i++)
@@ -3077,6 +3239,11 @@ bool embObjMotionControl::getMotorEncoderRaw(int m, double *value)
 
 bool embObjMotionControl::getMotorEncodersRaw(double *encs)
 {
+    if(readStatusSnapshot(&_statusMotorsReady, _statusMotorPosition, encs))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -3106,6 +3273,11 @@ bool embObjMotionControl::getMotorEncoderSpeedRaw(int m, double *sp)
 
 bool embObjMotionControl::getMotorEncoderSpeedsRaw(double *spds)
 {
+    if(readStatusSnapshot(&_statusMotorsReady, _statusMotorVelocity, spds))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -3134,6 +3306,11 @@ bool embObjMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
 
 bool embObjMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 {
+    if(readStatusSnapshot(&_statusMotorsReady, _statusMotorAcceleration, accs))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
@@ -3189,6 +3366,11 @@ bool embObjMotionControl::getCurrentRaw(int j, double *value)
 
 bool embObjMotionControl::getCurrentsRaw(double *vals)
 {
+    if(readStatusSnapshot(&_statusMotorsReady, _statusMotorCurrent, vals))
+    {
+        return true;
+    }
+
     bool ret = true;
     for(int j=0; j< _njoints; j++)
     {
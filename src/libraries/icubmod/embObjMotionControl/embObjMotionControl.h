@@ -303,6 +303,24 @@ private:
     double *_ampsToSensor;
     double *_dutycycleToPWM;
     double  *_encodersStamp;                    /** keep information about acquisition time for encoders read */
+
+    // snapshot of the status of joints and motors: the rx thread publishes it in update() and the bulk getters read it
+    // with a seqlock (the writer keeps _statusVersion odd while it changes the arrays). a snapshot is used only after
+    // all the joints (motors) have been published at least once, before that the getters read the buffered values.
+    // the ready counters are updated inside the write section and read inside the read section of the seqlock.
+    volatile uint32_t _statusVersion;
+    double  *_statusJointPosition;
+    double  *_statusJointVelocity;
+    double  *_statusJointAcceleration;
+    double  *_statusJointStamp;
+    double  *_statusMotorPosition;
+    double  *_statusMotorVelocity;
+    double  *_statusMotorAcceleration;
+    double  *_statusMotorCurrent;
+    bool    *_statusJointPublished;
+    bool    *_statusMotorPublished;
+    volatile int _statusJointsReady;
+    volatile int _statusMotorsReady;
     uint8_t *_jointEncoderType;                 /** joint encoder type*/
     uint8_t *_jointNumOfNoiseBits;              /** Num of error bits passable for joint encoder */
     int    *_jointEncoderRes;                   /** joint encoder resolution */
@@ -399,6 +417,10 @@ private:
     bool dealloc();
     bool isEpManagedByBoard();
 
+    void publishJointStatus(int j, const eOmc_joint_status_core_t *core, double timestamp);
+    void publishMotorStatus(int m, const eOmc_motor_status_basic_t *status);
+    bool readStatusSnapshot(const volatile int *ready, const double *src1, double *dst1, const double *src2=NULL, double *dst2=NULL);
+
     bool convertPosPid(eomcParser_pidInfo myPidInfo[]);
     bool convertTrqPid(eomcParser_trqPidInfo myPidInfo[]);
 
@@ -21,6 +21,8 @@
 
 #include <string>
 #include <sstream>
+#include <vector>
+#include <stdexcept>
 
 #include <yarp/sig/Vector.h>
 #include <yarp/os/IConfig.h>
@@ -130,6 +132,25 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output) = 0;
 
+    /**
+     * Provide the learning machine with a mini-batch of examples of the
+     * desired mapping. The default implementation feeds the samples one by
+     * one; learners that can update their model more cheaply for a whole
+     * batch override it.
+     *
+     * @param inputs the sample inputs
+     * @param outputs the corresponding outputs
+     */
+    virtual void feedSamples(const std::vector<yarp::sig::Vector>& inputs,
+                             const std::vector<yarp::sig::Vector>& outputs) {
+        if(inputs.size() != outputs.size()) {
+            throw std::runtime_error("Number of inputs and outputs in mini-batch do not match");
+        }
+        for(size_t i = 0; i < inputs.size(); i++) {
+            this->feedSample(inputs[i], outputs[i]);
+        }
+    }
+
     /**
      * Train the learning machine on the examples that have been supplied so
      * far. This method is primarily intended to be used for offline/batch
@@ -36,7 +36,11 @@ namespace learningmachine {
  *
  * Standard linear Bayesian regression or, equivalently, Gaussian Process
  * Regression with a linear covariance function. It uses a rank 1 update rule to
- * incrementally update the Cholesky factor of the covariance matrix.
+ * incrementally update the Cholesky factor of the covariance matrix. The
+ * weight matrix is updated in place as well, such that each sample costs
+ * O(d^2 + d*m) for d inputs and m outputs. A mini-batch of k > m samples is
+ * fed as a rank k update followed by a single solve for the weights, which
+ * costs O(k*d^2 + k*d*m + m*d^2).
  *
  * See:
  * Gaussian Processes for Machine Learning.
@@ -73,6 +77,11 @@ private:
      */
     yarp::sig::Matrix W;
 
+    /**
+     * Preallocated buffers for the in-place rank-1 updates.
+     */
+    yarp::sig::Vector xbuf, gbuf;
+
     /**
      * Signal noise.
      */
@@ -113,6 +122,12 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output);
 
+    /*
+     * Inherited from IMachineLearner.
+     */
+    virtual void feedSamples(const std::vector<yarp::sig::Vector>& inputs,
+                             const std::vector<yarp::sig::Vector>& outputs);
+
     /*
      * Inherited from IMachineLearner.
      */
@@ -188,6 +188,45 @@ void trsolve(const yarp::sig::Matrix& A, const yarp::sig::Vector& b, yarp::sig::
  */
 yarp::sig::Vector trsolve(const yarp::sig::Matrix& A, const yarp::sig::Vector& b, bool transa = false);
 
+/**
+ * Performs an in-place rank-1 update to an upper triangular Cholesky factor,
+ * such that R'*R becomes R'*R + x*x'. Unlike cholupdate, this operates
+ * directly on contiguous row-major buffers and does not allocate memory. Only
+ * the upper triangle of R is referenced and updated.
+ * @param R  pointer to the p x p upper triangular Cholesky factor
+ * @param p  the dimension of R
+ * @param x  pointer to the update vector, which is overwritten on output
+ */
+void cholupdate(double* R, int p, double* x);
+
+/**
+ * Solves a system A*x=b in-place using a precomputed upper triangular
+ * Cholesky factor R, i.e. A=R'*R. Unlike cholsolve, this operates directly on
+ * contiguous row-major buffers and does not allocate memory.
+ * @param R  pointer to the p x p upper triangular Cholesky factor
+ * @param p  the dimension of R
+ * @param x  pointer to the vector b on input and the solution x on output
+ */
+void cholsolve(const double* R, int p, double* x);
+
+/**
+ * Solves a linear system A*x=b in-place where A is upper triangular. Unlike
+ * trsolve, this operates directly on contiguous row-major buffers and does
+ * not allocate memory.
+ * @param A  pointer to the p x p upper triangular matrix A
+ * @param p  the dimension of A
+ * @param x  pointer to the vector b on input and the solution x on output
+ * @param transa whether A should be transposed
+ */
+void trsolve(const double* A, int p, double* x, bool transa = false);
+
+/**
+ * Copies the upper triangle of a square matrix into its lower triangle, as
+ * expected by the GSL based Cholesky routines.
+ * @param R  the matrix
+ */
+void reflectupper(yarp::sig::Matrix& R);
+
 /**
  * Fills an entire vector using the provided pseudo random number generator.
  *
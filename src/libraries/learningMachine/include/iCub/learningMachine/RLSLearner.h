@@ -33,7 +33,10 @@ namespace learningmachine {
  *
  * Recursive Regularized Least Squares (a.k.a. ridge regression) learner. It
  * uses a rank 1 update rule to update the Cholesky factor of the covariance
- * matrix.
+ * matrix. The weight matrix is updated in place as well, such that each sample
+ * costs O(d^2 + d*m) for d inputs and m outputs. A mini-batch of k > m samples
+ * is fed as a rank k update followed by a single solve for the weights, which
+ * costs O(k*d^2 + k*d*m + m*d^2).
  *
  * \see iCub::learningmachine::IMachineLearner
  * \see iCub::learningmachine::IFixedSizeLearner
@@ -60,6 +63,11 @@ private:
      */
     yarp::sig::Matrix W;
 
+    /**
+     * Preallocated buffers for the in-place rank-1 updates.
+     */
+    yarp::sig::Vector xbuf, gbuf;
+
     /**
      * Number of samples during last training routine
      */
@@ -100,6 +108,12 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output);
 
+    /*
+     * Inherited from IMachineLearner.
+     */
+    virtual void feedSamples(const std::vector<yarp::sig::Vector>& inputs,
+                             const std::vector<yarp::sig::Vector>& outputs);
+
     /*
      * Inherited from IMachineLearner.
      */
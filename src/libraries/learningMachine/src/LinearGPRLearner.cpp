@@ -19,6 +19,7 @@
 #include <cassert>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 #include <iostream>
 
@@ -51,7 +52,7 @@ LinearGPRLearner::LinearGPRLearner(unsigned int dom, unsigned int cod, double si
 
 LinearGPRLearner::LinearGPRLearner(const LinearGPRLearner& other)
   : IFixedSizeLearner(other), sampleCount(other.sampleCount), R(other.R),
-    B(other.B), W(other.W), sigma(other.sigma) {
+    B(other.B), W(other.W), xbuf(other.xbuf), gbuf(other.gbuf), sigma(other.sigma) {
 }
 
 LinearGPRLearner::~LinearGPRLearner() {
@@ -66,6 +67,8 @@ LinearGPRLearner& LinearGPRLearner::operator=(const LinearGPRLearner& other) {
     this->R = other.R;
     this->B = other.B;
     this->W = other.W;
+    this->xbuf = other.xbuf;
+    this->gbuf = other.gbuf;
     this->sigma = other.sigma;
 
     return *this;
@@ -74,16 +77,83 @@ LinearGPRLearner& LinearGPRLearner::operator=(const LinearGPRLearner& other) {
 void LinearGPRLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output) {
     this->IFixedSizeLearner::feedSample(input, output);
 
-    // update R
-    cholupdate(this->R, input);
+    int d = this->getDomainSize();
+    int m = this->getCoDomainSize();
+    const double* x = input.data();
+    const double* y = output.data();
+
+    // update R in place, R'*R <- R'*R + x*x'
+    std::copy(x, x + d, this->xbuf.data());
+    cholupdate(this->R.data(), d, this->xbuf.data());
+
+    // g = (R'*R)^-1 * x
+    std::copy(x, x + d, this->gbuf.data());
+    cholsolve(this->R.data(), d, this->gbuf.data());
+    const double* g = this->gbuf.data();
+
+    // update B and W, where W <- W + (y - W*x)*g' preserves W*R'*R = B
+    // without solving for all outputs
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W.data() + r * d;
+        double* Br = this->B.data() + r * d;
+        double e = y[r];
+        for(int c = 0; c < d; c++) {
+            e -= Wr[c] * x[c];
+        }
+        for(int c = 0; c < d; c++) {
+            Wr[c] += e * g[c];
+            Br[c] += y[r] * x[c];
+        }
+    }
 
-    // update B
-    this->B = this->B + outerprod(output, input);
+    this->sampleCount++;
+}
 
-    // update W
-    cholsolve(this->R, this->B, this->W);
+void LinearGPRLearner::feedSamples(const std::vector<yarp::sig::Vector>& inputs,
+                         const std::vector<yarp::sig::Vector>& outputs) {
+    if(inputs.size() != outputs.size()) {
+        throw std::runtime_error("Number of inputs and outputs in mini-batch do not match");
+    }
 
-    this->sampleCount++;
+    int d = this->getDomainSize();
+    int m = this->getCoDomainSize();
+    int k = int(inputs.size());
+
+    // a batch update pays one solve per output, so it only pays off when
+    // there are more samples than outputs
+    if(k <= m) {
+        this->IMachineLearner::feedSamples(inputs, outputs);
+        return;
+    }
+
+    // validate the whole batch before touching the model
+    for(int i = 0; i < k; i++) {
+        this->IFixedSizeLearner::feedSample(inputs[i], outputs[i]);
+    }
+
+    // rank k update of R, R'*R <- R'*R + X'*X, and of B <- B + Y'*X
+    for(int i = 0; i < k; i++) {
+        const double* x = inputs[i].data();
+        const double* y = outputs[i].data();
+        std::copy(x, x + d, this->xbuf.data());
+        cholupdate(this->R.data(), d, this->xbuf.data());
+        for(int r = 0; r < m; r++) {
+            double* Br = this->B.data() + r * d;
+            for(int c = 0; c < d; c++) {
+                Br[c] += y[r] * x[c];
+            }
+        }
+    }
+
+    // W = B * (R'*R)^-1, one solve per output for the whole batch
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W.data() + r * d;
+        const double* Br = this->B.data() + r * d;
+        std::copy(Br, Br + d, Wr);
+        cholsolve(this->R.data(), d, Wr);
+    }
+
+    this->sampleCount += k;
 }
 
 void LinearGPRLearner::train() {
@@ -97,7 +167,8 @@ Prediction LinearGPRLearner::predict(const yarp::sig::Vector& input) {
 
     // note that all output dimensions share the same hyperparameters and input samples,
     // the predicted variance is therefore identical
-    yarp::sig::Vector v = trsolve(this->R, input, true);
+    yarp::sig::Vector v = input;
+    trsolve(this->R.data(), this->getDomainSize(), v.data(), true);
     yarp::sig::Vector std(output.size());
     std = this->sigma * sqrt(1. + dot(v,v));
 
@@ -109,6 +180,8 @@ void LinearGPRLearner::reset() {
     this->R = eye(this->getDomainSize(), this->getDomainSize()) * this->sigma;
     this->B = zeros(this->getCoDomainSize(), this->getDomainSize());
     this->W = zeros(this->getCoDomainSize(), this->getDomainSize());
+    this->xbuf.resize(this->getDomainSize());
+    this->gbuf.resize(this->getDomainSize());
 }
 
 std::string LinearGPRLearner::getInfo() {
@@ -132,6 +205,8 @@ std::string LinearGPRLearner::getConfigHelp() {
 }
 
 void LinearGPRLearner::writeBottle(yarp::os::Bottle& bot) {
+    // the in-place updates only maintain the upper triangle of R
+    reflectupper(this->R);
     bot << this->R << this->B << this->W << this->sigma << this->sampleCount;
     // make sure to call the superclass's method
     this->IFixedSizeLearner::writeBottle(bot);
@@ -141,6 +216,8 @@ void LinearGPRLearner::readBottle(yarp::os::Bottle& bot) {
     // make sure to call the superclass's method
     this->IFixedSizeLearner::readBottle(bot);
     bot >> this->sampleCount >> this->sigma >> this->W >> this->B >> this->R;
+    this->xbuf.resize(this->getDomainSize());
+    this->gbuf.resize(this->getDomainSize());
 }
 
 void LinearGPRLearner::setDomainSize(unsigned int size) {
@@ -246,6 +246,40 @@ yarp::sig::Vector trsolve(const yarp::sig::Matrix& A, const yarp::sig::Vector& b
     return x;
 }
 
+void cholupdate(double* R, int p, double* x) {
+    double c, s;
+    double* rrow;
+
+    for(int i = 0; i < p; i++) {
+        rrow = R + i * p;
+        // compute and apply the givens rotation zeroing x(i)
+        cblas_drotg(rrow + i, x + i, &c, &s);
+        if(i < p - 1) {
+            cblas_drot(p - i - 1, rrow + i + 1, 1, x + i + 1, 1, c, s);
+        }
+    }
+}
+
+void trsolve(const double* A, int p, double* x, bool transa) {
+    CBLAS_TRANSPOSE trans = transa ? CblasTrans : CblasNoTrans;
+    cblas_dtrsv(CblasRowMajor, CblasUpper, trans, CblasNonUnit, p, A, p, x, 1);
+}
+
+void cholsolve(const double* R, int p, double* x) {
+    // R'*y = b, followed by R*x = y
+    trsolve(R, p, x, true);
+    trsolve(R, p, x, false);
+}
+
+void reflectupper(yarp::sig::Matrix& R) {
+    assert(R.rows() == R.cols());
+    for(int r = 1; r < R.rows(); r++) {
+        for(int c = 0; c < r; c++) {
+            R(r, c) = R(c, r);
+        }
+    }
+}
+
 void fillrandom(yarp::sig::Vector& v, yarp::math::RandScalar& prng) {
     size_t i;
     for(i = 0; i < v.size(); i++) {
@@ -19,6 +19,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 #include <yarp/math/Math.h>
 
@@ -47,7 +48,7 @@ RLSLearner::RLSLearner(unsigned int dom, unsigned int cod, double lambda) {
 
 RLSLearner::RLSLearner(const RLSLearner& other)
   : IFixedSizeLearner(other), sampleCount(other.sampleCount), R(other.R),
-    B(other.B), W(other.W), lambda(other.lambda) {
+    B(other.B), W(other.W), xbuf(other.xbuf), gbuf(other.gbuf), lambda(other.lambda) {
 }
 
 RLSLearner::~RLSLearner() {
@@ -62,6 +63,8 @@ RLSLearner& RLSLearner::operator=(const RLSLearner& other) {
     this->R = other.R;
     this->B = other.B;
     this->W = other.W;
+    this->xbuf = other.xbuf;
+    this->gbuf = other.gbuf;
     this->lambda = other.lambda;
 
     return *this;
@@ -70,16 +73,83 @@ RLSLearner& RLSLearner::operator=(const RLSLearner& other) {
 void RLSLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output) {
     this->IFixedSizeLearner::feedSample(input, output);
 
-    // update R
-    cholupdate(this->R, input);
+    int d = this->getDomainSize();
+    int m = this->getCoDomainSize();
+    const double* x = input.data();
+    const double* y = output.data();
+
+    // update R in place, R'*R <- R'*R + x*x'
+    std::copy(x, x + d, this->xbuf.data());
+    cholupdate(this->R.data(), d, this->xbuf.data());
+
+    // g = (R'*R)^-1 * x
+    std::copy(x, x + d, this->gbuf.data());
+    cholsolve(this->R.data(), d, this->gbuf.data());
+    const double* g = this->gbuf.data();
+
+    // update B and W, where W <- W + (y - W*x)*g' preserves W*R'*R = B
+    // without solving for all outputs
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W.data() + r * d;
+        double* Br = this->B.data() + r * d;
+        double e = y[r];
+        for(int c = 0; c < d; c++) {
+            e -= Wr[c] * x[c];
+        }
+        for(int c = 0; c < d; c++) {
+            Wr[c] += e * g[c];
+            Br[c] += y[r] * x[c];
+        }
+    }
 
-    // update B
-    this->B = this->B + outerprod(output, input);
+    this->sampleCount++;
+}
 
-    // update W
-    cholsolve(this->R, this->B, this->W);
+void RLSLearner::feedSamples(const std::vector<yarp::sig::Vector>& inputs,
+                         const std::vector<yarp::sig::Vector>& outputs) {
+    if(inputs.size() != outputs.size()) {
+        throw std::runtime_error("Number of inputs and outputs in mini-batch do not match");
+    }
 
-    this->sampleCount++;
+    int d = this->getDomainSize();
+    int m = this->getCoDomainSize();
+    int k = int(inputs.size());
+
+    // a batch update pays one solve per output, so it only pays off when
+    // there are more samples than outputs
+    if(k <= m) {
+        this->IMachineLearner::feedSamples(inputs, outputs);
+        return;
+    }
+
+    // validate the whole batch before touching the model
+    for(int i = 0; i < k; i++) {
+        this->IFixedSizeLearner::feedSample(inputs[i], outputs[i]);
+    }
+
+    // rank k update of R, R'*R <- R'*R + X'*X, and of B <- B + Y'*X
+    for(int i = 0; i < k; i++) {
+        const double* x = inputs[i].data();
+        const double* y = outputs[i].data();
+        std::copy(x, x + d, this->xbuf.data());
+        cholupdate(this->R.data(), d, this->xbuf.data());
+        for(int r = 0; r < m; r++) {
+            double* Br = this->B.data() + r * d;
+            for(int c = 0; c < d; c++) {
+                Br[c] += y[r] * x[c];
+            }
+        }
+    }
+
+    // W = B * (R'*R)^-1, one solve per output for the whole batch
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W.data() + r * d;
+        const double* Br = this->B.data() + r * d;
+        std::copy(Br, Br + d, Wr);
+        cholsolve(this->R.data(), d, Wr);
+    }
+
+    this->sampleCount += k;
 }
 
 void RLSLearner::train() {
@@ -99,6 +169,8 @@ void RLSLearner::reset() {
     this->R = eye(this->getDomainSize(), this->getDomainSize()) * sqrt(this->lambda);
     this->B = zeros(this->getCoDomainSize(), this->getDomainSize());
     this->W = zeros(this->getCoDomainSize(), this->getDomainSize());
+    this->xbuf.resize(this->getDomainSize());
+    this->gbuf.resize(this->getDomainSize());
 }
 
 std::string RLSLearner::getInfo() {
@@ -122,6 +194,8 @@ std::string RLSLearner::getConfigHelp() {
 }
 
 void RLSLearner::writeBottle(yarp::os::Bottle& bot) {
+    // the in-place updates only maintain the upper triangle of R
+    reflectupper(this->R);
     bot << this->R << this->B << this->W << this->lambda << this->sampleCount;
     // make sure to call the superclass's method
     this->IFixedSizeLearner::writeBottle(bot);
@@ -131,6 +205,8 @@ void RLSLearner::readBottle(yarp::os::Bottle& bot) {
     // make sure to call the superclass's method
     this->IFixedSizeLearner::readBottle(bot);
     bot >> this->sampleCount >> this->lambda >> this->W >> this->B >> this->R;
+    this->xbuf.resize(this->getDomainSize());
+    this->gbuf.resize(this->getDomainSize());
 }
 
 void RLSLearner::setDomainSize(unsigned int size) {
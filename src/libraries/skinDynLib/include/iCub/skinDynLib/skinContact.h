@@ -255,6 +255,35 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection);
 
+    /**
+    * Append the compact binary representation of this skinContact to a buffer
+    * (see skinContactList::setCompactSerialization). All the values are little-endian:
+    * - uint32 contactId, uint8 bodyPart, uint8 skinPart, uint8 linkNumber
+    * - uint8 taxel encoding (same as base, raw list, ranges or bitmap)
+    * - 16 float32, i.e. CoP, force, moment, geometric center, normal direction, pressure
+    * - the taxel ids, either as a raw list, as a list of ranges or as a bitmap,
+    *   whichever is smaller, or nothing if they are equal to baseTaxels
+    * @param buffer the buffer to append the contact to
+    * @param baseTaxels taxel list of the corresponding contact in the previous
+    *        frame (delta encoding), or NULL to always send the taxel ids
+    */
+    void appendCompact(std::vector<unsigned char> &buffer, const std::vector<unsigned int> *baseTaxels=NULL) const;
+
+    /**
+    * Read this skinContact from its compact binary representation.
+    * @param data pointer to the data, on success it is moved past the contact
+    * @param end pointer past the last byte of available data
+    * @param baseTaxels taxel list of the corresponding contact in the previous
+    *        frame, needed if the contact has been delta encoded
+    * @return true iff a skinContact was read correctly
+    */
+    bool readCompact(const unsigned char *&data, const unsigned char *end, const std::vector<unsigned int> *baseTaxels=NULL);
+
+    /**
+    * Get the list of active taxels without copying it.
+    */
+    const std::vector<unsigned int>& getTaxelListRef() const{ return taxelList; }
+
     /**
     * Convert this skinContact to a vector. The size of the vector is 21 plus
     * the number of active taxels. The vector contains this data, in this order:
@@ -28,6 +28,7 @@
 #include <vector>
 #include <map>
 #include <yarp/os/Portable.h>
+#include <yarp/os/Semaphore.h>
 #include "iCub/skinDynLib/skinContact.h"
 #include "iCub/skinDynLib/dynContactList.h"
 
@@ -36,6 +37,51 @@ namespace iCub
 namespace skinDynLib
 {
 
+/**
+* @ingroup skinDynLib
+*
+* State of a delta encoded stream of skinContactList's (see
+* skinContactList::setCompactSerialization): the last frame written and
+* the last two frames read. Every writer and every reader of a stream owns
+* its own object, so that different streams never share their base frames.
+*/
+class skinContactListDelta
+{
+    friend class skinContactList;
+
+    struct Frame
+    {
+        unsigned int seq;
+        std::vector<std::vector<unsigned int> > taxels;
+    };
+
+    unsigned int stream;        // id written in the frames of this writer
+    Frame written;              // last frame written
+    unsigned int readStream;    // id of the stream the frames read come from
+    Frame read[2];              // last two frames read
+    yarp::os::Semaphore mutex;
+
+    skinContactListDelta(const skinContactListDelta&);
+    skinContactListDelta& operator=(const skinContactListDelta&);
+
+public:
+    /**
+    * @param stream id of the stream (not zero), written in each frame so that
+    *        a reader notices when the frames it receives come from another writer
+    */
+    skinContactListDelta(unsigned int stream=1);
+
+    /**
+    * Forget the frames written and read, so that the next frame written is a full one.
+    */
+    void reset();
+
+    /**
+    * @return the id of the stream
+    */
+    unsigned int getStream() const { return stream; }
+};
+
 /** 
 * @ingroup skinDynLib 
 *  
@@ -44,7 +90,16 @@ namespace skinDynLib
 class skinContactList  : public std::vector<skinContact>, public yarp::os::Portable
 {
 protected:
-    
+    // if true write() uses the compact binary format
+    bool compact;
+    // state of the delta encoded stream written or read (NULL means no delta encoding)
+    skinContactListDelta *delta;
+    // buffer used to compose the compact binary representation
+    std::vector<unsigned char> compactBuffer;
+
+    bool readCompact(yarp::os::ConnectionReader& connection);
+    bool writeCompact(yarp::os::ConnectionWriter& connection);
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
     //   CONSTRUCTORS
@@ -52,6 +107,18 @@ public:
     skinContactList();
     skinContactList(const size_type &n, const skinContact& value = skinContact());
 
+    /**
+    * Copy the contacts and the format, but not the delta state, which belongs
+    * to a single stream.
+    */
+    skinContactList(const skinContactList &l);
+
+    /**
+    * Copy the contacts only, leaving the serialization settings of this list
+    * untouched (e.g. a list prepared on a port keeps writing its own stream).
+    */
+    skinContactList& operator=(const skinContactList &l);
+
     /**
     * Select all the contacts that have the specified body part.
     * @param bp the interested body part
@@ -73,6 +140,42 @@ public:
     //~~~~~~~~~~~~~~~~~~~~~~~~~
     //   SERIALIZATION methods
     //~~~~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Select the format used by write(). By default the list is written as a
+    * Bottle of skinContact's, which any reader can parse. The compact format
+    * packs the whole list in a single blob (see skinContact::appendCompact),
+    * using float32 values and ranges/bitmaps for the taxel ids; read() detects
+    * the format automatically, whereas readers built before its introduction
+    * just reject the message.
+    * @param compact if true use the compact binary format
+    * @param delta if not NULL, the taxel ids of each contact are omitted
+    *        when they are equal to those of the contact with the same index in
+    *        the previous list written through the same delta object; a full frame
+    *        is sent periodically. The object is not owned by the list and must
+    *        outlive the writes (e.g. a member of the thread that fills the list).
+    *        The reader can decode a delta frame only if it received the previous
+    *        one through a delta object of its own (see setDeltaDecoding), so use it
+    *        only on lossless connections (e.g. non-strict writes on a BufferedPort
+    *        can drop messages) towards readers that enable the delta decoding.
+    *        Every write() encodes a new frame, hence a delta encoded list must be
+    *        written to a single connection.
+    */
+    void setCompactSerialization(bool compact, skinContactListDelta *delta=NULL);
+
+    /**
+    * Enable the decoding of delta encoded frames in read(). A delta frame can be
+    * decoded only by a list that read the previous frames of the stream through the
+    * same delta object, e.g. a list read repeatedly from a Port; without it read()
+    * rejects delta frames with a warning, but it still decodes full frames.
+    * @param delta the state of the stream read, not owned by the list
+    */
+    void setDeltaDecoding(skinContactListDelta *delta) { this->delta = delta; }
+
+    /**
+    * @return true iff write() uses the compact binary format
+    */
+    bool getCompactSerialization() const { return compact; }
+
     /*
     * Read skinContactList from a connection.
     * return true iff a skinContactList was read correctly
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 #include <yarp/math/Math.h>
 #include "iCub/skinDynLib/skinContact.h"
 
@@ -17,6 +18,37 @@ using namespace yarp::sig;
 using namespace yarp::os;
 using namespace std;
 
+// taxel id encodings of the compact serialization
+#define COMPACT_TAXELS_SAME     0   // same taxels of the corresponding contact in the base frame
+#define COMPACT_TAXELS_RAW      1   // uint32 count, count x uint32 id
+#define COMPACT_TAXELS_RANGES   2   // uint32 count, uint16 nRanges, nRanges x (uint16 first, uint16 length)
+#define COMPACT_TAXELS_BITMAP   3   // uint32 count, uint16 first, uint16 nBits, ceil(nBits/8) bytes
+
+// little-endian helpers for the compact serialization
+static inline void putU8(vector<unsigned char> &b, unsigned int v){ b.push_back((unsigned char)v); }
+static inline void putU16(vector<unsigned char> &b, unsigned int v){
+    b.push_back((unsigned char)(v&0xFF)); b.push_back((unsigned char)((v>>8)&0xFF));
+}
+static inline void putU32(vector<unsigned char> &b, unsigned int v){
+    putU16(b, v&0xFFFF); putU16(b, v>>16);
+}
+static inline void putF32(vector<unsigned char> &b, double d){
+    float f = (float)d;
+    unsigned int v;
+    memcpy(&v, &f, 4);
+    putU32(b, v);
+}
+static inline unsigned int getU16(const unsigned char *p){ return p[0] | (p[1]<<8); }
+static inline unsigned int getU32(const unsigned char *p){
+    return p[0] | (p[1]<<8) | (p[2]<<16) | ((unsigned int)p[3]<<24);
+}
+static inline double getF32(const unsigned char *p){
+    unsigned int v = getU32(p);
+    float f;
+    memcpy(&f, &v, 4);
+    return f;
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~
@@ -213,6 +245,170 @@ bool skinContact::read(ConnectionReader& connection){
 
     return !connection.isError();
 }
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContact::appendCompact(vector<unsigned char> &buffer, const vector<unsigned int> *baseTaxels) const{
+    putU32(buffer, contactId);
+    putU8(buffer, bodyPart);
+    putU8(buffer, skinPart);
+    putU8(buffer, linkNumber);
+
+    // choose the smallest encoding of the taxel ids: ranges and bitmap
+    // need strictly increasing ids that fit in 16 bits
+    unsigned int n = taxelList.size();
+    int encoding = COMPACT_TAXELS_RAW;
+    unsigned int nRanges = 0, nBits = 0;
+    if(baseTaxels!=NULL && *baseTaxels==taxelList)
+        encoding = COMPACT_TAXELS_SAME;
+    else if(n>0 && taxelList[n-1]<=0xFFFF)
+    {
+        bool sorted = true;
+        nRanges = 1;
+        for(unsigned int i=1; i<n && sorted; i++)
+        {
+            if(taxelList[i]<=taxelList[i-1])
+                sorted = false;
+            else if(taxelList[i]!=taxelList[i-1]+1)
+                nRanges++;
+        }
+        if(sorted)
+        {
+            nBits = taxelList[n-1]-taxelList[0]+1;
+            unsigned int rawSize    = 4*n;
+            unsigned int rangesSize = 2+4*nRanges;
+            unsigned int bitmapSize = 4+(nBits+7)/8;
+            if(nBits>0xFFFF)
+                encoding = COMPACT_TAXELS_RAW;
+            else if(rangesSize<rawSize && rangesSize<=bitmapSize)
+                encoding = COMPACT_TAXELS_RANGES;
+            else if(bitmapSize<rawSize)
+                encoding = COMPACT_TAXELS_BITMAP;
+        }
+    }
+    putU8(buffer, encoding);
+
+    for(int i=0;i<3;i++) putF32(buffer, CoP[i]);
+    for(int i=0;i<3;i++) putF32(buffer, F[i]);
+    for(int i=0;i<3;i++) putF32(buffer, Mu[i]);
+    for(int i=0;i<3;i++) putF32(buffer, geoCenter[i]);
+    for(int i=0;i<3;i++) putF32(buffer, normalDir[i]);
+    putF32(buffer, pressure);
+
+    if(encoding==COMPACT_TAXELS_SAME)
+        return;
+    putU32(buffer, n);
+    if(encoding==COMPACT_TAXELS_RAW)
+    {
+        for(unsigned int i=0;i<n;i++)
+            putU32(buffer, taxelList[i]);
+    }
+    else if(encoding==COMPACT_TAXELS_RANGES)
+    {
+        putU16(buffer, nRanges);
+        unsigned int first = 0;
+        for(unsigned int i=1;i<=n;i++)
+            if(i==n || taxelList[i]!=taxelList[i-1]+1)
+            {
+                putU16(buffer, taxelList[first]);
+                putU16(buffer, i-first);
+                first = i;
+            }
+    }
+    else
+    {
+        putU16(buffer, taxelList[0]);
+        putU16(buffer, nBits);
+        size_t offset = buffer.size();
+        buffer.resize(offset+(nBits+7)/8, 0);
+        for(unsigned int i=0;i<n;i++)
+        {
+            unsigned int bit = taxelList[i]-taxelList[0];
+            buffer[offset+(bit>>3)] |= (unsigned char)(1<<(bit&7));
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContact::readCompact(const unsigned char *&data, const unsigned char *end, const vector<unsigned int> *baseTaxels){
+    const unsigned char *p = data;
+    if(end-p < 8+16*4)
+        return false;
+    contactId   = getU32(p);
+    bodyPart    = (BodyPart) p[4];
+    skinPart    = (SkinPart) p[5];
+    linkNumber  = p[6];
+    int encoding = p[7];
+    p += 8;
+
+    for(int i=0;i<3;i++, p+=4) CoP[i]       = getF32(p);
+    for(int i=0;i<3;i++, p+=4) F[i]         = getF32(p);
+    setForce(F);
+    for(int i=0;i<3;i++, p+=4) Mu[i]        = getF32(p);
+    for(int i=0;i<3;i++, p+=4) geoCenter[i] = getF32(p);
+    for(int i=0;i<3;i++, p+=4) normalDir[i] = getF32(p);
+    pressure = getF32(p);   p+=4;
+
+    if(encoding==COMPACT_TAXELS_SAME)
+    {
+        if(baseTaxels==NULL)
+            return false;
+        taxelList = *baseTaxels;
+    }
+    else
+    {
+        if(end-p < 4)
+            return false;
+        unsigned int n = getU32(p);     p+=4;
+        if(encoding==COMPACT_TAXELS_RAW)
+        {
+            if((size_t)(end-p) < 4*(size_t)n)
+                return false;
+            taxelList.resize(n);
+            for(unsigned int i=0;i<n;i++, p+=4)
+                taxelList[i] = getU32(p);
+        }
+        else if(encoding==COMPACT_TAXELS_RANGES)
+        {
+            if(end-p < 2)
+                return false;
+            unsigned int nRanges = getU16(p);   p+=2;
+            if(end-p < 4*(int)nRanges)
+                return false;
+            taxelList.clear();
+            taxelList.reserve(n);
+            for(unsigned int r=0;r<nRanges;r++, p+=4)
+            {
+                unsigned int first = getU16(p), length = getU16(p+2);
+                for(unsigned int i=0;i<length;i++)
+                    taxelList.push_back(first+i);
+            }
+            if(taxelList.size()!=n)
+                return false;
+        }
+        else if(encoding==COMPACT_TAXELS_BITMAP)
+        {
+            if(end-p < 4)
+                return false;
+            unsigned int first = getU16(p), nBits = getU16(p+2);
+            p += 4;
+            unsigned int nBytes = (nBits+7)/8;
+            if(end-p < (int)nBytes)
+                return false;
+            taxelList.clear();
+            taxelList.reserve(n);
+            for(unsigned int bit=0;bit<nBits;bit++)
+                if(p[bit>>3] & (1<<(bit&7)))
+                    taxelList.push_back(first+bit);
+            p += nBytes;
+            if(taxelList.size()!=n)
+                return false;
+        }
+        else
+            return false;
+    }
+    activeTaxels = taxelList.size();
+
+    data = p;
+    return true;
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector skinContact::toVector() const{
     Vector v(activeTaxels+21);
@@ -10,6 +10,8 @@
 #include <iomanip>
 #include <string>
 
+#include <yarp/os/Log.h>
+#include <yarp/os/Semaphore.h>
 #include "iCub/skinDynLib/skinContactList.h"
 #include <iCub/ctrl/math.h>
 
@@ -17,15 +19,67 @@ using namespace std;
 using namespace yarp::os;
 using namespace iCub::skinDynLib;
 
+// header of the compact serialization: magic, version, flags, reserved, uint32 contact number
+// and, if delta encoded, uint32 stream id, uint32 sequence number, uint32 base sequence number
+#define COMPACT_MAGIC           0x53
+#define COMPACT_VERSION         1
+#define COMPACT_FLAG_DELTA      0x01
+#define COMPACT_HEADER_SIZE     8
+#define COMPACT_DELTA_SIZE      12
+#define COMPACT_NO_BASE         0xFFFFFFFF
+// number of frames between two consecutive full frames of a delta encoded stream
+#define COMPACT_KEYFRAME_PERIOD 25
+
+// smallest encoding of a contact: ids, parts, link, taxel encoding and 16 float32 values
+// (see skinContact::readCompact)
+#define COMPACT_CONTACT_MIN_SIZE (8+16*4)
+
+namespace
+{
+    inline unsigned int getU32(const unsigned char *p){
+        return p[0] | (p[1]<<8) | (p[2]<<16) | ((unsigned int)p[3]<<24);
+    }
+    inline void setU32(unsigned char *p, unsigned int v){
+        p[0]=v&0xFF; p[1]=(v>>8)&0xFF; p[2]=(v>>16)&0xFF; p[3]=(v>>24)&0xFF;
+    }
+}
+
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactListDelta::skinContactListDelta(unsigned int _stream)
+:stream(_stream), mutex(1)
+{
+    reset();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContactListDelta::reset()
+{
+    written.seq = COMPACT_NO_BASE;
+    written.taxels.clear();
+    readStream = COMPACT_NO_BASE;
+    for(int k=0; k<2; k++)
+    {
+        read[k].seq = COMPACT_NO_BASE;
+        read[k].taxels.clear();
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList()
-:vector<skinContact>(){}
+:vector<skinContact>(), compact(false), delta(NULL){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList(const size_type &n, const skinContact& value)
-:vector<skinContact>(n, value){}
+:vector<skinContact>(n, value), compact(false), delta(NULL){}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactList::skinContactList(const skinContactList &l)
+:vector<skinContact>(l), Portable(), compact(l.compact), delta(NULL){}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactList& skinContactList::operator=(const skinContactList &l)
+{
+    vector<skinContact>::operator=(l);
+    return *this;
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList skinContactList::filterBodyPart(const BodyPart &bp)
 {
@@ -54,11 +108,21 @@ map<SkinPart, skinContactList> skinContactList::splitPerSkinPart()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //   SERIALIZATION methods
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContactList::setCompactSerialization(bool _compact, skinContactListDelta *_delta)
+{
+    compact     = _compact;
+    delta       = _compact ? _delta : NULL;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::read(ConnectionReader& connection)
 {
     // A skinContactList is represented as a list of list
-    // where each list is a skinContact
-    if(connection.expectInt()!=BOTTLE_TAG_LIST)
+    // where each list is a skinContact, or as a list containing
+    // a single blob in the compact format
+    int tag = connection.expectInt();
+    if(tag==BOTTLE_TAG_LIST+BOTTLE_TAG_BLOB)
+        return readCompact(connection);
+    if(tag!=BOTTLE_TAG_LIST)
         return false;
 
     int listLength = connection.expectInt();
@@ -76,6 +140,9 @@ bool skinContactList::read(ConnectionReader& connection)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::write(ConnectionWriter& connection)
 {
+    if(compact)
+        return writeCompact(connection);
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
     connection.appendInt(BOTTLE_TAG_LIST);
@@ -88,6 +155,154 @@ bool skinContactList::write(ConnectionWriter& connection)
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::readCompact(ConnectionReader& connection)
+{
+    // the list tag has already been read
+    if(connection.expectInt()!=1)
+        return false;
+    int len = connection.expectInt();
+    if(len<COMPACT_HEADER_SIZE)
+        return false;
+    compactBuffer.resize(len);
+    if(!connection.expectBlock((char*)&compactBuffer[0], len))
+        return false;
+
+    const unsigned char *p   = &compactBuffer[0];
+    const unsigned char *dataEnd = p+len;
+    if(p[0]!=COMPACT_MAGIC || p[1]!=COMPACT_VERSION)
+        return false;
+    bool isDelta = (p[2]&COMPACT_FLAG_DELTA)!=0;
+    unsigned int n = getU32(p+4);
+    p += COMPACT_HEADER_SIZE;
+
+    unsigned int stream=0, seq=0, baseSeq=COMPACT_NO_BASE;
+    if(isDelta)
+    {
+        if(dataEnd-p < COMPACT_DELTA_SIZE)
+            return false;
+        stream  = getU32(p);
+        seq     = getU32(p+4);
+        baseSeq = getU32(p+8);
+        p += COMPACT_DELTA_SIZE;
+    }
+    // a corrupted contact number must not make us allocate before the bounds checks
+    if(n > (unsigned int)(dataEnd-p)/COMPACT_CONTACT_MIN_SIZE)
+        return false;
+
+    if(!isDelta)
+    {
+        resize(n);
+        for(iterator it=begin(); it!=end(); it++)
+            if(!it->readCompact(p, dataEnd))
+                return false;
+        return p==dataEnd;
+    }
+
+    // full frames of a delta stream can be decoded without the state of the stream
+    if(delta==NULL)
+    {
+        if(baseSeq!=COMPACT_NO_BASE)
+        {
+            yWarning("[skinContactList::read] delta encoded frame received without delta decoding state (see setDeltaDecoding), frame dropped");
+            return false;
+        }
+        resize(n);
+        for(iterator it=begin(); it!=end(); it++)
+            if(!it->readCompact(p, dataEnd))
+                return false;
+        return p==dataEnd;
+    }
+
+    delta->mutex.wait();
+    skinContactListDelta::Frame *frames = delta->read;
+    if(delta->readStream!=stream)
+    {
+        // another writer: its frames cannot be based on those read so far
+        frames[0].seq = frames[1].seq = COMPACT_NO_BASE;
+        delta->readStream = stream;
+    }
+    const skinContactListDelta::Frame *base = NULL;
+    if(baseSeq!=COMPACT_NO_BASE)
+    {
+        for(int k=0; k<2; k++)
+            if(frames[k].seq==baseSeq)
+                base = &frames[k];
+        if(base==NULL)
+        {
+            // the base frame has been lost, wait for the next full frame
+            delta->mutex.post();
+            return false;
+        }
+    }
+
+    resize(n);
+    bool ok = true;
+    for(unsigned int i=0; i<n && ok; i++)
+        ok = operator[](i).readCompact(p, dataEnd, (base!=NULL && i<base->taxels.size()) ? &base->taxels[i] : NULL);
+    ok = ok && p==dataEnd;
+
+    // store the frame, unless it has already been read (e.g. it was resent)
+    if(ok && frames[0].seq!=seq && frames[1].seq!=seq)
+    {
+        skinContactListDelta::Frame &slot = (&frames[0]==base) ? frames[1] : frames[0];
+        slot.seq = seq;
+        slot.taxels.resize(n);
+        for(unsigned int i=0; i<n; i++)
+            slot.taxels[i] = operator[](i).getTaxelListRef();
+    }
+    delta->mutex.post();
+
+    return ok;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::writeCompact(ConnectionWriter& connection)
+{
+    compactBuffer.clear();
+    compactBuffer.resize(COMPACT_HEADER_SIZE, 0);
+    compactBuffer[0] = COMPACT_MAGIC;
+    compactBuffer[1] = COMPACT_VERSION;
+    compactBuffer[2] = delta!=NULL ? COMPACT_FLAG_DELTA : 0;
+    setU32(&compactBuffer[4], size());
+
+    if(delta==NULL)
+    {
+        for(const_iterator it=begin(); it!=end(); it++)
+            it->appendCompact(compactBuffer);
+    }
+    else
+    {
+        delta->mutex.wait();
+        skinContactListDelta::Frame &last = delta->written;
+        unsigned int seq = (last.seq==COMPACT_NO_BASE) ? 0 : last.seq+1;
+        if(seq==COMPACT_NO_BASE)
+            seq = 0;
+        bool keyFrame = last.seq==COMPACT_NO_BASE || seq%COMPACT_KEYFRAME_PERIOD==0;
+
+        compactBuffer.resize(COMPACT_HEADER_SIZE+COMPACT_DELTA_SIZE);
+        setU32(&compactBuffer[COMPACT_HEADER_SIZE],   delta->stream);
+        setU32(&compactBuffer[COMPACT_HEADER_SIZE+4], seq);
+        setU32(&compactBuffer[COMPACT_HEADER_SIZE+8], keyFrame ? COMPACT_NO_BASE : last.seq);
+
+        unsigned int n = size();
+        for(unsigned int i=0; i<n; i++)
+            operator[](i).appendCompact(compactBuffer, (!keyFrame && i<last.taxels.size()) ? &last.taxels[i] : NULL);
+
+        last.seq = seq;
+        last.taxels.resize(n);
+        for(unsigned int i=0; i<n; i++)
+            last.taxels[i] = operator[](i).getTaxelListRef();
+        delta->mutex.post();
+    }
+
+    // a list containing a single blob
+    connection.appendInt(BOTTLE_TAG_LIST+BOTTLE_TAG_BLOB);
+    connection.appendInt(1);
+    connection.appendInt(compactBuffer.size());
+    connection.appendBlock((const char*)&compactBuffer[0], compactBuffer.size());
+
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 dynContactList skinContactList::toDynContactList() const
 {
     dynContactList res(this->size());
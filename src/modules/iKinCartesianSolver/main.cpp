@@ -54,6 +54,14 @@ See \ref iKinSlv "Cartesian Solver" for documentation.
 - allow specifying a different configuration file from the 
   default one which is \e cartesianSolver.ini.
  
+--bench-calls \e N [optional]
+- run off-line a benchmark of the forward kinematics and 
+  Jacobians of iCubArm and iCubEye over \e N calls, each on a
+  new joints configuration, comparing the generic products of 
+  the links' matrices, the standard methods and their 
+  allocation-free fast*() counterparts, then quit. No YARP 
+  server is required.
+ 
 \section portsa_sec Ports Accessed
  
 All ports which allow the access to motor interface shall be 
@@ -124,19 +132,31 @@ Windows, Linux
 \author Ugo Pattacini
 */ 
 
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <sstream>
+#include <deque>
 
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Network.h>
 #include <yarp/os/RFModule.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
 
+#include <yarp/math/Math.h>
+#include <iCub/ctrl/math.h>
 #include <iCub/iKin/iKinSlv.h>
 
 using namespace std;
 using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
 using namespace iCub::iKin;
 
 static string pathToCustomKinFile;
@@ -348,21 +368,284 @@ public:
 
 
 /************************************************************************/
-int main(int argc, char *argv[])
+double maxAbsDiff(const Matrix &A, const Matrix &B)
 {
-    Network yarp;
-    if (!yarp.checkNetwork())
+    double d=0.0;
+    for (int r=0; r<A.rows(); r++)
+        for (int c=0; c<A.cols(); c++)
+            d=std::max(d,fabs(A(r,c)-B(r,c)));
+
+    return d;
+}
+
+
+/************************************************************************/
+double maxAbsDiff(const Vector &a, const Vector &b)
+{
+    double d=0.0;
+    for (size_t i=0; i<a.length(); i++)
+        d=std::max(d,fabs(a[i]-b[i]));
+
+    return d;
+}
+
+
+/************************************************************************/
+// Generic computations as carried out by iKinChain before the
+// fixed-size kernels and the forward kinematics cache were
+// introduced: they multiply the yarp matrices returned by each
+// link. All the links of the chain are assumed to be released.
+Matrix genericGetH(iKinChain &chain)
+{
+    Matrix H=chain.getH0();
+    for (unsigned int i=0; i<chain.getN(); i++)
+        H*=chain[i].getH();
+
+    return H*chain.getHN();
+}
+
+
+/************************************************************************/
+Vector genericEndEffPose(iKinChain &chain)
+{
+    Matrix H=genericGetH(chain);
+    Vector r=dcm2axis(H);
+    Vector v(7);
+    v[0]=H(0,3);
+    v[1]=H(1,3);
+    v[2]=H(2,3);
+    v[3]=r[0];
+    v[4]=r[1];
+    v[5]=r[2];
+    v[6]=r[3];
+
+    return v;
+}
+
+
+/************************************************************************/
+Matrix genericAnaJacobian(iKinChain &chain)
+{
+    unsigned int n=chain.getN();
+    Matrix J(6,n);
+    Matrix H,dH,_H;
+
+    for (unsigned int i=0; i<n; i++)
     {
-        yError()<<"YARP server not available!";
-        return 1;
+        H=dH=chain.getH0();
+        for (unsigned int j=0; j<n; j++)
+        {
+            _H=chain[j].getH();
+            H*=_H;
+
+            if (j==i)
+                dH*=chain[j].getDnH();
+            else
+                dH*=_H;
+        }
+
+        H*=chain.getHN();
+        dH*=chain.getHN();
+
+        J(0,i)=dH(0,3);
+        J(1,i)=dH(1,3);
+        J(2,i)=dH(2,3);
+        J(3,i)=(H(2,1)*dH(2,2)-H(2,2)*dH(2,1))/(H(2,1)*H(2,1)+H(2,2)*H(2,2));
+        J(4,i)=dH(2,0)/sqrt(fabs(1.0-H(2,0)*H(2,0)));
+        J(5,i)=(H(1,0)*dH(0,0)-H(0,0)*dH(1,0))/(H(1,0)*H(1,0)+H(0,0)*H(0,0));
+    }
+
+    return J;
+}
+
+
+/************************************************************************/
+Matrix genericGeoJacobian(iKinChain &chain)
+{
+    unsigned int n=chain.getN();
+    Matrix J(6,n);
+
+    deque<Matrix> intH;
+    intH.push_back(chain.getH0());
+    for (unsigned int i=0; i<n; i++)
+        intH.push_back(intH[i]*chain[i].getH(true));
+
+    Matrix PN=intH[n]*chain.getHN();
+    for (unsigned int i=0; i<n; i++)
+    {
+        Matrix &Z=intH[i];
+        Vector w=cross(Z,2,PN-Z,3);
+
+        J(0,i)=w[0];
+        J(1,i)=w[1];
+        J(2,i)=w[2];
+        J(3,i)=Z(0,2);
+        J(4,i)=Z(1,2);
+        J(5,i)=Z(2,2);
+    }
+
+    return J;
+}
+
+
+/************************************************************************/
+double maxAbsDiff(const Matrix &A, const Matrix &B)
+{
+    double d=0.0;
+    for (int r=0; r<A.rows(); r++)
+        for (int c=0; c<A.cols(); c++)
+            d=std::max(d,fabs(A(r,c)-B(r,c)));
+
+    return d;
+}
+
+
+/************************************************************************/
+double maxAbsDiff(const Vector &a, const Vector &b)
+{
+    double d=0.0;
+    for (size_t i=0; i<a.length(); i++)
+        d=std::max(d,fabs(a[i]-b[i]));
+
+    return d;
+}
+
+
+/************************************************************************/
+int runBenchmark(ResourceFinder &rf)
+{
+    int nCalls=std::max(rf.find("bench-calls").asInt(),1);
+    const int nConfigs=64;
+
+    iCubArm arm("right");
+    iCubEye eye("right");
+    iKinLimb *limbs[]={&arm,&eye};
+    const char *names[]={"iCubArm","iCubEye"};
+    const char *methods[]={"getH","EndEffPose","AnaJacobian","GeoJacobian"};
+    const char *paths[]={"generic","standard","fast"};
+
+    yInfo()<<"benchmarking "<<nCalls<<" calls per method, each on a new configuration ...";
+    bool ok=true;
+    srand(0);
+    for (int l=0; l<2; l++)
+    {
+        iKinChain &chain=*limbs[l]->asChain();
+        for (unsigned int i=0; i<chain.getN(); i++)
+            chain.releaseLink(i);
+
+        // consecutive calls use different configurations, so that
+        // every call has to recompute the kinematics of the whole chain
+        deque<Vector> qs;
+        for (int k=0; k<nConfigs; k++)
+        {
+            Vector q(chain.getDOF());
+            for (size_t i=0; i<q.length(); i++)
+                q[i]=0.2*(rand()/(double)RAND_MAX-0.5);
+            qs.push_back(q);
+        }
+
+        // cost of the configuration update, common to all the paths
+        double t0=Time::now();
+        for (int i=0; i<nCalls; i++)
+            chain.setAng(qs[i%nConfigs]);
+        double tSetAng=Time::now()-t0;
+
+        Matrix H[3],Ja[3],Jg[3];
+        Vector x[3];
+        double t[4][3];
+        for (int m=0; m<4; m++)
+        {
+            for (int p=0; p<3; p++)
+            {
+                t0=Time::now();
+                for (int i=0; i<nCalls; i++)
+                {
+                    chain.setAng(qs[i%nConfigs]);
+                    switch (m)
+                    {
+                    case 0:
+                        if (p==0)
+                            H[p]=genericGetH(chain);
+                        else if (p==1)
+                            H[p]=chain.getH();
+                        else
+                            chain.fastGetH(H[p]);
+                        break;
+                    case 1:
+                        if (p==0)
+                            x[p]=genericEndEffPose(chain);
+                        else if (p==1)
+                            x[p]=chain.EndEffPose();
+                        else
+                            chain.fastEndEffPose(x[p]);
+                        break;
+                    case 2:
+                        if (p==0)
+                            Ja[p]=genericAnaJacobian(chain);
+                        else if (p==1)
+                            Ja[p]=chain.AnaJacobian();
+                        else
+                            chain.fastAnaJacobian(Ja[p]);
+                        break;
+                    default:
+                        if (p==0)
+                            Jg[p]=genericGeoJacobian(chain);
+                        else if (p==1)
+                            Jg[p]=chain.GeoJacobian();
+                        else
+                            chain.fastGeoJacobian(Jg[p]);
+                    }
+                }
+                t[m][p]=std::max(Time::now()-t0-tSetAng,0.0);
+            }
+
+            ostringstream str;
+            str<<names[l]<<" "<<methods[m]<<" [ns/call, net of setAng]:";
+            for (int p=0; p<3; p++)
+                str<<" "<<paths[p]<<" "<<1e9*t[m][p]/nCalls<<";";
+            str<<" speed-up fast vs generic "<<(t[m][2]>0.0?t[m][0]/t[m][2]:0.0);
+            yInfo()<<str.str();
+        }
+
+        // all the paths ended with the same configuration
+        double err=0.0;
+        for (int p=1; p<3; p++)
+        {
+            err=std::max(err,std::max(maxAbsDiff(H[0],H[p]),maxAbsDiff(x[0],x[p])));
+            err=std::max(err,std::max(maxAbsDiff(Ja[0],Ja[p]),maxAbsDiff(Jg[0],Jg[p])));
+        }
+
+        if (err>1e-9)
+        {
+            yError()<<names[l]<<": the paths return results that differ by "<<err;
+            ok=false;
+        }
     }
 
+    return (ok?0:1);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Network yarp;
+
     ResourceFinder rf;
     rf.setVerbose(true);
     rf.setDefaultContext("cartesianSolver");
     rf.setDefaultConfigFile("cartesianSolver.ini");
     rf.configure(argc,argv);
 
+    if (rf.check("bench-calls"))
+        return runBenchmark(rf);
+
+    if (!yarp.checkNetwork())
+    {
+        yError()<<"YARP server not available!";
+        return 1;
+    }
+
     SolverModule mod;
     return mod.runModule(rf);
 }
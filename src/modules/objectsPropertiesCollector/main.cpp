@@ -42,6 +42,9 @@ with but ideally any kind of objects you can think of.
 The user can set, get, add, remove items and make queries 
 to the database. \n 
 Importantly, the module is capable of running in real-time.
+Requests that only read the database (e.g. get, ask, dump) are 
+served concurrently, while the ones that modify it are given 
+priority over newly incoming readers. 
 
 \section proto_sec Protocol
  
@@ -203,6 +206,32 @@ to (cond1)&&(cond2) || (cond1)&&(cond3).
 --stats 
 - Enable statistics printouts.
  
+--index "(<prop0> <prop1> ...)" 
+- Maintain secondary indexes on the given properties so that 
+  [ask] requests involving them do not need to scan the whole
+  database. Conditions such as equality on strings and numbers
+  and relational operators on numbers are served by the indexes,
+  whereas "!=" always requires a check on the items.
+ 
+--journal 
+- Keep an append-only binary journal of the changes, named 
+  after the database file with the suffix ".journal" and stored
+  in the same context. At startup the journal is replayed in 
+  place of the database file, if present and not older than 
+  the database file. Saving the database without this option 
+  discards the journal, as it no longer reflects the content. 
+  The journal is periodically compacted into a snapshot of the content, so that
+  the persistence cost depends on the amount of changes rather 
+  than on the database size. 
+ 
+--bench-items <N> 
+- Run off-line a benchmark of mixed set/ask traffic on \e N
+  items (10000 by default) with and without indexes, then quit.
+  The option --bench-requests <M> specifies the number of
+  requests to issue (10000 by default). The benchmark also
+  checks that a snapshot replayed from the journal reproduces
+  the items.
+ 
 \section portsa_sec Ports Accessed
 None.
 
@@ -256,9 +285,18 @@ reply: [ack] (id (1))
 */ 
 
 #include <cstdio>
+#include <cstdlib>
+#include <cmath>
 #include <cstdarg>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <sstream>
 #include <string>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <set>
 #include <map>
 #include <deque>
 
@@ -296,6 +334,18 @@ using namespace yarp::os;
 #define BCTAG_EMPTY                     ("empty")
 #define BCTAG_SYNC                      ("sync")
 #define BCTAG_ASYNC                     ("async")
+                                        
+#define DB_MAX_PLANS                    256
+#define DB_WHEEL_SLOTS                  512
+#define DB_WHEEL_RES                    0.1
+#define DB_JOURNAL_MIN_SIZE             (1<<20)
+#define DB_JOURNAL_RATIO                2
+                                        
+#define JOURNAL_PUT                     1
+#define JOURNAL_SET                     2
+#define JOURNAL_UNPUT                   3
+#define JOURNAL_DEL                     4
+#define JOURNAL_CLEAR                   5
 
 
 namespace relationalOperators
@@ -394,6 +444,317 @@ bool notEqual(Value &a, Value &b)
 }
 
 
+/************************************************************************/
+class TimerWheel
+{
+protected:
+    /************************************************************************/
+    struct Timer
+    {
+        double expiry;
+        int    tick;
+        int    id;
+    };
+
+    double t0;
+    int    tick;
+    vector<deque<Timer> > slots;
+
+public:
+    /************************************************************************/
+    TimerWheel() : t0(Time::now()), tick(0), slots(DB_WHEEL_SLOTS) { }
+
+    /************************************************************************/
+    void schedule(const int id, const double expiry)
+    {
+        // NaN life-timers never expire
+        if (expiry!=expiry)
+            return;
+
+        // round up so that timers never fire in advance
+        // (far expiries are saturated and then rescheduled)
+        Timer timer;
+        timer.expiry=expiry;
+        timer.tick=std::max((int)std::min(ceil((expiry-t0)/DB_WHEEL_RES),1e9),tick+1);
+        timer.id=id;
+
+        slots[timer.tick%slots.size()].push_back(timer);
+    }
+
+    /************************************************************************/
+    void advance(const double now, deque<pair<double,int> > &fired)
+    {
+        int target=(int)floor((now-t0)/DB_WHEEL_RES);
+        int steps=std::min(target-tick,(int)slots.size());
+
+        deque<Timer> pending;
+        for (int i=1; i<=steps; i++)
+        {
+            // timers belonging to future rounds stay in the slot
+            deque<Timer> &slot=slots[(tick+i)%slots.size()];
+            for (size_t j=0; j<slot.size(); j++)
+            {
+                if (slot[j].tick<=target)
+                    fired.push_back(pair<double,int>(slot[j].expiry,slot[j].id));
+                else
+                    pending.push_back(slot[j]);
+            }
+
+            slot.swap(pending);
+            pending.clear();
+        }
+
+        tick=std::max(tick,target);
+    }
+
+    /************************************************************************/
+    void clear()
+    {
+        for (size_t i=0; i<slots.size(); i++)
+            slots[i].clear();
+    }
+};
+
+
+/************************************************************************/
+class Journal
+{
+protected:
+    string fileName;
+    FILE  *fout;
+    FILE  *fsnap;
+    size_t size;
+    size_t snapshotSize;
+
+    /************************************************************************/
+    static size_t writeRecord(FILE *stream, const int op, const int id,
+                              const double stamp, Bottle *payload)
+    {
+        size_t len=0;
+        const char *buf=(payload!=NULL)?payload->toBinary(&len):NULL;
+
+        unsigned char code=(unsigned char)op;
+        unsigned int  length=(unsigned int)len;
+        bool ok=(fwrite(&code,sizeof(code),1,stream)==1) &&
+                (fwrite(&id,sizeof(id),1,stream)==1) &&
+                (fwrite(&stamp,sizeof(stamp),1,stream)==1) &&
+                (fwrite(&length,sizeof(length),1,stream)==1);
+        if (ok && (length>0))
+            ok=(fwrite(buf,1,length,stream)==length);
+
+        if (!ok)
+        {
+            yError("unable to write on the journal!");
+            return 0;
+        }
+
+        return sizeof(code)+sizeof(id)+sizeof(stamp)+sizeof(length)+length;
+    }
+
+public:
+    /************************************************************************/
+    Journal() : fout(NULL), fsnap(NULL), size(0), snapshotSize(0) { }
+
+    /************************************************************************/
+    ~Journal()
+    {
+        close();
+    }
+
+    /************************************************************************/
+    bool open(const string &fileName)
+    {
+        close();
+        this->fileName=fileName;
+        fout=fopen(fileName.c_str(),"ab");
+        if (fout==NULL)
+        {
+            yError("unable to open the journal %s!",fileName.c_str());
+            return false;
+        }
+
+        fseek(fout,0,SEEK_END);
+        size=snapshotSize=(size_t)ftell(fout);
+        return true;
+    }
+
+    /************************************************************************/
+    void close()
+    {
+        if (fsnap!=NULL)
+        {
+            fclose(fsnap);
+            fsnap=NULL;
+        }
+
+        if (fout!=NULL)
+        {
+            fclose(fout);
+            fout=NULL;
+        }
+    }
+
+    /************************************************************************/
+    bool isOpen() const
+    {
+        return (fout!=NULL);
+    }
+
+    /************************************************************************/
+    void append(const int op, const int id, const double stamp, Bottle *payload=NULL)
+    {
+        if (fout!=NULL)
+        {
+            size+=writeRecord(fout,op,id,stamp,payload);
+            fflush(fout);
+        }
+    }
+
+    /************************************************************************/
+    bool needsCompaction() const
+    {
+        return (size>std::max((size_t)DB_JOURNAL_MIN_SIZE,DB_JOURNAL_RATIO*snapshotSize));
+    }
+
+    /************************************************************************/
+    bool beginSnapshot()
+    {
+        if (fout==NULL)
+            return false;
+
+        fsnap=fopen((fileName+".tmp").c_str(),"wb");
+        return (fsnap!=NULL);
+    }
+
+    /************************************************************************/
+    void appendSnapshot(const int id, const double stamp, Bottle &payload)
+    {
+        if (fsnap!=NULL)
+            writeRecord(fsnap,JOURNAL_PUT,id,stamp,&payload);
+    }
+
+    /************************************************************************/
+    bool commitSnapshot()
+    {
+        if (fsnap==NULL)
+            return false;
+
+        fclose(fsnap);
+        fsnap=NULL;
+        fclose(fout);
+        fout=NULL;
+
+        // the snapshot replaces the whole journal
+        string tmpName=fileName+".tmp";
+        ::remove(fileName.c_str());
+        if (rename(tmpName.c_str(),fileName.c_str())!=0)
+            yError("unable to replace the journal %s!",fileName.c_str());
+
+        return open(fileName);
+    }
+
+    /************************************************************************/
+    static bool readRecord(FILE *stream, int &op, int &id, double &stamp,
+                           Bottle &payload, vector<char> &buf)
+    {
+        unsigned char code;
+        unsigned int  length;
+        if ((fread(&code,sizeof(code),1,stream)!=1) ||
+            (fread(&id,sizeof(id),1,stream)!=1) ||
+            (fread(&stamp,sizeof(stamp),1,stream)!=1) ||
+            (fread(&length,sizeof(length),1,stream)!=1))
+            return false;
+
+        op=code;
+        payload.clear();
+        if (length>0)
+        {
+            buf.resize(length);
+            if (fread(&buf[0],1,length,stream)!=length)
+                return false;
+
+            payload.fromBinary(&buf[0],(int)length);
+        }
+
+        return true;
+    }
+};
+
+
+/************************************************************************/
+class RWLock
+{
+protected:
+    Mutex     readersMutex;
+    Semaphore turnstile;
+    Semaphore roomEmpty;
+    int       readers;
+
+public:
+    /************************************************************************/
+    RWLock() : turnstile(1), roomEmpty(1), readers(0) { }
+
+    /************************************************************************/
+    void lockRead()
+    {
+        // a waiting writer holds the turnstile,
+        // thus preventing new readers from coming in
+        turnstile.wait();
+        turnstile.post();
+
+        readersMutex.lock();
+        if (++readers==1)
+            roomEmpty.wait();
+        readersMutex.unlock();
+    }
+
+    /************************************************************************/
+    void unlockRead()
+    {
+        readersMutex.lock();
+        if (--readers==0)
+            roomEmpty.post();
+        readersMutex.unlock();
+    }
+
+    /************************************************************************/
+    void lockWrite()
+    {
+        turnstile.wait();
+        roomEmpty.wait();
+    }
+
+    /************************************************************************/
+    void unlockWrite()
+    {
+        turnstile.post();
+        roomEmpty.post();
+    }
+};
+
+
+/************************************************************************/
+class ReadGuard
+{
+    RWLock &rwLock;
+
+public:
+    ReadGuard(RWLock &rwLock) : rwLock(rwLock) { rwLock.lockRead();   }
+    ~ReadGuard()                               { rwLock.unlockRead(); }
+};
+
+
+/************************************************************************/
+class WriteGuard
+{
+    RWLock &rwLock;
+
+public:
+    WriteGuard(RWLock &rwLock) : rwLock(rwLock) { rwLock.lockWrite();   }
+    ~WriteGuard()                               { rwLock.unlockWrite(); }
+};
+
+
 /************************************************************************/
 class DataBase : public RateThread
 {
@@ -403,10 +764,12 @@ protected:
     {
         Property *prop;
         double    lastUpdate;
+        double    expiry;
         string    owner;
 
         Item() : prop(NULL),
                  lastUpdate(OPT_DISABLED),
+                 expiry(OPT_DISABLED),
                  owner(OPT_OWNERSHIP_ALL) { }
     };
 
@@ -414,13 +777,49 @@ protected:
     struct Condition
     {
         string prop;
+        string operation;
         bool (*compare)(Value&,Value&);
         Value val;
+        bool indexed;
+        bool lifeTimer;
+
+        Condition() : compare(NULL), indexed(false), lifeTimer(false) { }
+    };
+
+    /************************************************************************/
+    struct Index
+    {
+        std::set<int> all;
+        map<string,std::set<int> > strings;
+        multimap<int,int>     ints;
+        multimap<double,int>  doubles;
+    };
+
+    /************************************************************************/
+    struct Term     // conditions connected by "&&"
+    {
+        deque<Condition>    condList;
+        deque<unsigned int> indexed;
+    };
+
+    /************************************************************************/
+    struct QueryPlan
+    {
+        deque<Term> terms;
+        bool scan;
+
+        QueryPlan() : scan(false) { }
     };
 
     ResourceFinder *rf;
     map<int,Item> itemsMap;
-    Mutex mutex;
+    map<string,Index> indexes;
+    map<string,QueryPlan> plans;
+    TimerWheel wheel;
+    Journal journal;
+    RWLock rwLock;
+    Mutex  planMutex;
+    Mutex  bcMutex;
     int  idCnt;
     bool initialized;
     bool nosavedb;
@@ -436,70 +835,518 @@ protected:
             delete it->second.prop;
 
         itemsMap.clear();
+        wheel.clear();
+
+        for (map<string,Index>::iterator it=indexes.begin(); it!=indexes.end(); it++)
+            it->second=Index();
+    }
+
+    /************************************************************************/
+    void setLifeTimer(const int id, Item &item, const double stamp)
+    {
+        // the expiry is kept as absolute time, while the
+        // property shows the remaining time only when read
+        if (item.prop->check(PROP_LIFETIMER))
+        {
+            item.expiry=stamp+item.prop->find(PROP_LIFETIMER).asDouble();
+            wheel.schedule(id,item.expiry);
+        }
+        else
+            item.expiry=OPT_DISABLED;
+    }
+
+    /************************************************************************/
+    double getLifeTimer(const Item &item) const
+    {
+        return std::max(item.expiry-Time::now(),0.0);
+    }
+
+    /************************************************************************/
+    void readItem(Item &item, Bottle &bottle)
+    {
+        if (item.expiry<0.0)
+        {
+            bottle.read(*item.prop);
+            return;
+        }
+
+        Bottle props;
+        props.read(*item.prop);
+        for (int i=0; i<props.size(); i++)
+        {
+            Bottle *b=props.get(i).asList();
+            if ((b!=NULL) && (b->get(0).asString()==PROP_LIFETIMER))
+            {
+                Bottle &lifeTimer=bottle.addList();
+                lifeTimer.addString(PROP_LIFETIMER);
+                lifeTimer.addDouble(getLifeTimer(item));
+            }
+            else
+                bottle.add(props.get(i));
+        }
+    }
+
+    /************************************************************************/
+    bool replay(const string &fileName)
+    {
+        FILE *fin=fopen(fileName.c_str(),"rb");
+        if (fin==NULL)
+            return false;
+
+        yInfo("replaying journal %s ...",fileName.c_str());
+
+        WriteGuard wg(rwLock);
+        clear();
+        idCnt=0;
+
+        int op,id,cnt=0;
+        long last=0;
+        double stamp;
+        Bottle payload;
+        vector<char> buf;
+        while (Journal::readRecord(fin,op,id,stamp,payload,buf))
+        {
+            last=ftell(fin);
+            cnt++;
+            if (op==JOURNAL_CLEAR)
+            {
+                clear();
+                continue;
+            }
+
+            map<int,Item>::iterator it=itemsMap.find(id);
+            if (op==JOURNAL_PUT)
+            {
+                if (it!=itemsMap.end())
+                    eraseItem(it);
+
+                // built as in add(), so that multi-value properties are retained
+                Item &item=itemsMap[id];
+                item.prop=new Property(payload.toString().c_str());
+                indexItem(id,item.prop);
+                setLifeTimer(id,item,stamp);
+
+                if (idCnt<=id)
+                    idCnt=id+1;
+            }
+            else if (it==itemsMap.end())
+                continue;
+            else if (op==JOURNAL_SET)
+            {
+                Property *pProp=it->second.prop;
+                for (int i=0; i<payload.size(); i++)
+                {
+                    if (Bottle *option=payload.get(i).asList())
+                    {
+                        string prop=option->get(0).asString().c_str();
+                        unindexProp(id,prop,pProp);
+                        pProp->unput(prop.c_str());
+                        pProp->put(prop.c_str(),option->get(1));
+                        indexProp(id,prop,pProp);
+
+                        if (prop==PROP_LIFETIMER)
+                            setLifeTimer(id,it->second,stamp);
+                    }
+                }
+            }
+            else if (op==JOURNAL_UNPUT)
+            {
+                for (int i=0; i<payload.size(); i++)
+                {
+                    string prop=payload.get(i).asString().c_str();
+                    unindexProp(id,prop,it->second.prop);
+                    it->second.prop->unput(prop.c_str());
+
+                    if (prop==PROP_LIFETIMER)
+                        it->second.expiry=OPT_DISABLED;
+                }
+            }
+            else if (op==JOURNAL_DEL)
+                eraseItem(it);
+        }
+
+        // a truncated record may be found after a crash
+        fseek(fin,0,SEEK_END);
+        if (ftell(fin)!=last)
+            yWarning("journal truncated after %d records!",cnt);
+
+        fclose(fin);
+        yInfo("journal replayed: %d records, %d items",cnt,(int)itemsMap.size());
+        return true;
     }
 
     /************************************************************************/
     void eraseItem(map<int,Item>::iterator &it)
     {
+        unindexItem(it->first,it->second.prop);
         delete it->second.prop;
         itemsMap.erase(it);
     }
 
+    /************************************************************************/
+    template<typename T>
+    void eraseFromIndex(multimap<T,int> &index, const T &key, const int id)
+    {
+        typename multimap<T,int>::iterator it=index.lower_bound(key);
+        typename multimap<T,int>::iterator last=index.upper_bound(key);
+        for (; it!=last; it++)
+        {
+            if (it->second==id)
+            {
+                index.erase(it);
+                break;
+            }
+        }
+    }
+
+    /************************************************************************/
+    void indexProp(const int id, const string &name, Property *pProp)
+    {
+        map<string,Index>::iterator idx=indexes.find(name);
+        if ((idx==indexes.end()) || !pProp->check(name.c_str()))
+            return;
+
+        Index &index=idx->second;
+        Value &val=pProp->find(name.c_str());
+        index.all.insert(id);
+
+        if (val.isDouble())
+        {
+            // NaN never satisfies any relational operator
+            double key=val.asDouble();
+            if (key==key)
+                index.doubles.insert(pair<double,int>(key,id));
+        }
+        else if (val.isInt())
+            index.ints.insert(pair<int,int>(val.asInt(),id));
+        else if (val.isString())
+            index.strings[val.asString().c_str()].insert(id);
+    }
+
+    /************************************************************************/
+    void unindexProp(const int id, const string &name, Property *pProp)
+    {
+        map<string,Index>::iterator idx=indexes.find(name);
+        if ((idx==indexes.end()) || !pProp->check(name.c_str()))
+            return;
+
+        Index &index=idx->second;
+        Value &val=pProp->find(name.c_str());
+        index.all.erase(id);
+
+        if (val.isDouble())
+            eraseFromIndex(index.doubles,val.asDouble(),id);
+        else if (val.isInt())
+            eraseFromIndex(index.ints,val.asInt(),id);
+        else if (val.isString())
+        {
+            map<string,std::set<int> >::iterator it=index.strings.find(val.asString().c_str());
+            if (it!=index.strings.end())
+            {
+                it->second.erase(id);
+                if (it->second.empty())
+                    index.strings.erase(it);
+            }
+        }
+    }
+
+    /************************************************************************/
+    void indexItem(const int id, Property *pProp)
+    {
+        for (map<string,Index>::iterator it=indexes.begin(); it!=indexes.end(); it++)
+            indexProp(id,it->first,pProp);
+    }
+
+    /************************************************************************/
+    void unindexItem(const int id, Property *pProp)
+    {
+        for (map<string,Index>::iterator it=indexes.begin(); it!=indexes.end(); it++)
+            unindexProp(id,it->first,pProp);
+    }
+
+    /************************************************************************/
+    template<typename T>
+    void lookUpRange(const multimap<T,int> &index, const string &operation,
+                     const T &key, vector<int> &ids)
+    {
+        typename multimap<T,int>::const_iterator first=index.begin();
+        typename multimap<T,int>::const_iterator last=index.end();
+
+        if (operation==">")
+            first=index.upper_bound(key);
+        else if (operation==">=")
+            first=index.lower_bound(key);
+        else if (operation=="<")
+            last=index.lower_bound(key);
+        else if (operation=="<=")
+            last=index.upper_bound(key);
+        else
+        {
+            first=index.lower_bound(key);
+            last=index.upper_bound(key);
+        }
+
+        for (; first!=last; first++)
+            ids.push_back(first->second);
+    }
+
+    /************************************************************************/
+    void lookUpIndex(const Index &index, Condition &condition, vector<int> &ids)
+    {
+        // existence of the property
+        if (condition.operation.empty())
+        {
+            ids.assign(index.all.begin(),index.all.end());
+            return;
+        }
+
+        // comparisons are not defined for the remaining types
+        Value &val=condition.val;
+        if (val.isDouble())
+        {
+            double key=val.asDouble();
+            if (key==key)
+                lookUpRange(index.doubles,condition.operation,key,ids);
+        }
+        else if (val.isInt())
+            lookUpRange(index.ints,condition.operation,val.asInt(),ids);
+        else if (val.isString() && (condition.operation=="=="))
+        {
+            map<string,std::set<int> >::const_iterator it=index.strings.find(val.asString().c_str());
+            if (it!=index.strings.end())
+                ids.assign(it->second.begin(),it->second.end());
+        }
+    }
+
     /************************************************************************/
     void write(FILE *stream)
     {
         int i=0;
         for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        {
+            string content;
+            if (it->second.expiry<0.0)
+                content=it->second.prop->toString().c_str();
+            else
+            {
+                Bottle item;
+                readItem(it->second,item);
+                content=item.toString().c_str();
+            }
+
             fprintf(stream,"item_%d (%s %d) (%s)\n",
-                    i++,PROP_ID,it->first,it->second.prop->toString().c_str());
+                    i++,PROP_ID,it->first,content.c_str());
+        }
     }
 
     /************************************************************************/
-    bool recursiveCheck(Property *item, deque<Condition> &condList,
-                        deque<string> &opList, const unsigned int i=0)
+    bool checkTerm(Item &item, Term &term, const bool residual=false)
     {
-        bool result;
-        if (item->check(condList[i].prop.c_str()))
+        Property *pProp=item.prop;
+        for (unsigned int i=0; i<term.condList.size(); i++)
         {
+            Condition &condition=term.condList[i];
+            if (residual && condition.indexed)
+                continue;
+
+            if (!pProp->check(condition.prop.c_str()))
+                return false;
+
+            if (condition.lifeTimer && (item.expiry>=0.0))
+            {
+                Value lifeTimer(getLifeTimer(item));
+                if (!(*condition.compare)(lifeTimer,condition.val))
+                    return false;
+
+                continue;
+            }
+
             // take the current value of the item's property under test
-            Value &val=item->find(condList[i].prop.c_str());
+            // and compute the condition over it
+            Value &val=pProp->find(condition.prop.c_str());
+            if (!(*condition.compare)(val,condition.val))
+                return false;
+        }
+
+        return true;
+    }
+
+    /************************************************************************/
+    bool compile(Bottle *content, QueryPlan &plan)
+    {
+        // we cannot accept a conditions string ending with
+        // a boolean operator
+        if (!(content->size()&0x01))
+        {
+            yWarning("uncorrect conditions received!");
+            return false;
+        }
+
+        // parse the received conditions; "&&" takes precedence
+        // over "||", hence the plan is a disjunction of terms
+        plan.terms.push_back(Term());
+        for (int i=0; i<content->size(); i+=2)
+        {
+            if (Bottle *b=content->get(i).asList())
+            {
+                Condition condition;
+                string operation;
+
+                if (b->size()==1)
+                {
+                    condition.prop=b->get(0).asString().c_str();
+                    condition.compare=&relationalOperators::alwaysTrue;
+                }
+                else if (b->size()>2)
+                {
+                    condition.prop=b->get(0).asString().c_str();
+                    operation=b->get(1).asString().c_str();
+                    condition.val=b->get(2);
+
+                    if (operation==">")
+                        condition.compare=&relationalOperators::greater;
+                    else if (operation==">=")
+                        condition.compare=&relationalOperators::greaterEqual;
+                    else if (operation=="<")
+                        condition.compare=&relationalOperators::lower;
+                    else if (operation=="<=")
+                        condition.compare=&relationalOperators::lowerEqual;
+                    else if (operation=="==")
+                        condition.compare=&relationalOperators::equal;
+                    else if (operation=="!=")
+                        condition.compare=&relationalOperators::notEqual;
+                    else
+                    {
+                        yWarning("unknown relational operator '%s'!",operation.c_str());
+                        return false;
+                    }
+                }
+                else
+                {
+                    yWarning("wrong condition given!");
+                    return false;
+                }
+
+                condition.operation=operation;
+                condition.lifeTimer=(condition.prop==PROP_LIFETIMER);
+
+                Term &term=plan.terms.back();
+                if ((operation!="!=") && (indexes.find(condition.prop)!=indexes.end()))
+                {
+                    condition.indexed=true;
+                    term.indexed.push_back((unsigned int)term.condList.size());
+                }
+
+                term.condList.push_back(condition);
+
+                if ((i+1)<content->size())
+                {
+                    operation=content->get(i+1).asString().c_str();
+                    if (operation=="||")
+                        plan.terms.push_back(Term());
+                    else if (operation!="&&")
+                    {
+                        yWarning("unknown boolean operator '%s'!",operation.c_str());
+                        return false;
+                    }
+                }
+            }
+            else
+            {
+                yWarning("wrong condition given!");
+                return false;
+            }
+        }
+
+        // a term that cannot be served by indexes
+        // requires scanning the whole database
+        for (unsigned int i=0; i<plan.terms.size(); i++)
+            if (plan.terms[i].indexed.empty())
+                plan.scan=true;
+
+        return true;
+    }
+
+    /************************************************************************/
+    void execute(QueryPlan &plan, Bottle &response)
+    {
+        if (plan.scan)
+        {
+            for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+            {
+                // keep only the item that satisfies
+                // at least one of the terms
+                for (unsigned int i=0; i<plan.terms.size(); i++)
+                {
+                    if (checkTerm(it->second,plan.terms[i]))
+                    {
+                        response.addInt(it->first);
+                        break;
+                    }
+                }
+            }
 
-            // compute the condition over the current value
-            result=(*condList[i].compare)(val,condList[i].val);
+            return;
         }
-        else
-            result=false;
 
-        if ((i+1)>=condList.size())
-            return result;
-        else if (opList[i]=="||")
-            return (result||recursiveCheck(item,condList,opList,i+1));
-        else    // at this point we know we deal with "&&" operations
+        std::set<int> ids;
+        vector<int> candidates,matches;
+        vector<vector<int> > ranges;
+        deque<pair<size_t,unsigned int> > order;
+        for (unsigned int i=0; i<plan.terms.size(); i++)
         {
-            unsigned int j;
-            for (j=i+1; j<condList.size(); j++)
+            Term &term=plan.terms[i];
+
+            // retrieve each range from the indexes only once
+            // and intersect them starting from the smallest ones
+            ranges.resize(term.indexed.size());
+            order.clear();
+            for (unsigned int j=0; j<term.indexed.size(); j++)
+            {
+                Condition &condition=term.condList[term.indexed[j]];
+                ranges[j].clear();
+                lookUpIndex(indexes.find(condition.prop)->second,condition,ranges[j]);
+                order.push_back(pair<size_t,unsigned int>(ranges[j].size(),j));
+            }
+            sort(order.begin(),order.end());
+
+            matches.clear();
+            for (unsigned int j=0; j<order.size(); j++)
             {
-                if (result)
+                vector<int> &range=ranges[order[j].second];
+                sort(range.begin(),range.end());
+
+                if (j==0)
+                    matches.swap(range);
+                else
                 {
-                    if (item->check(condList[j].prop.c_str()))
-                    {
-                        Value &val=item->find(condList[j].prop.c_str());
-                        result=result&&(*condList[j].compare)(val,condList[j].val);
-                    }
-                    else
-                        result=false;
+                    candidates.swap(matches);
+                    matches.clear();
+                    set_intersection(candidates.begin(),candidates.end(),
+                                     range.begin(),range.end(),back_inserter(matches));
                 }
 
-                if (j<opList.size())
-                    if (opList[j]=="||")
-                        break;
+                if (matches.empty())
+                    break;
             }
 
-            if (j>=condList.size())
-                return result;
-            else
-                return (result||recursiveCheck(item,condList,opList,j+1));
+            // check the remaining conditions only over the matches
+            bool residual=(term.indexed.size()<term.condList.size());
+            for (size_t j=0; j<matches.size(); j++)
+            {
+                if (residual)
+                {
+                    map<int,Item>::iterator it=itemsMap.find(matches[j]);
+                    if ((it==itemsMap.end()) || !checkTerm(it->second,term,true))
+                        continue;
+                }
+
+                ids.insert(matches[j]);
+            }
         }
+
+        for (std::set<int>::iterator it=ids.begin(); it!=ids.end(); it++)
+            response.addInt(*it);
     }
 
     /************************************************************************/
@@ -527,6 +1374,12 @@ public:
             stop();
 
         save();
+        if (journal.isOpen())
+        {
+            compact();
+            journal.close();
+        }
+
         clear();
     }
 
@@ -541,9 +1394,43 @@ public:
         }
 
         nosavedb=rf.check("no-save-db");
-        if (!rf.check("no-load-db"))
+        if (rf.check("index"))
+        {
+            if (Bottle *props=rf.find("index").asList())
+                setIndexes(*props);
+            else
+                yWarning("wrong list of properties to index!");
+        }
+
+        // a journal older than the database file has been superseded
+        // by a save done without journaling and must not be replayed
+        bool loaded=false;
+        bool staleJournal=false;
+        string journalName=getJournalName();
+        time_t journalTime,dbTime;
+        if (getModificationTime(journalName,journalTime))
+        {
+            staleJournal=getModificationTime(getHomeDbName(),dbTime) &&
+                         (journalTime<dbTime);
+            if (staleJournal)
+                yWarning("journal %s is older than the database, ignoring it",
+                         journalName.c_str());
+            else if (!rf.check("no-load-db"))
+                loaded=replay(journalName);
+        }
+
+        if (!rf.check("no-load-db") && !loaded)
             load();
 
+        // start the journal from a snapshot of the current content
+        if (rf.check("journal"))
+        {
+            if (journal.open(journalName))
+                compact();
+        }
+        else if (staleJournal)
+            ::remove(journalName.c_str());
+
         dump();
         initialized=true;
         yInfo("database ready ...");
@@ -557,6 +1444,72 @@ public:
         asyncBroadcast=rf.check("async-bc");
     }
 
+    /************************************************************************/
+    void setIndexes(const Bottle &props)
+    {
+        WriteGuard wg(rwLock);
+        indexes.clear();
+        plans.clear();
+
+        for (int i=0; i<props.size(); i++)
+        {
+            string name=props.get(i).asString().c_str();
+            if (name.empty() || (name==PROP_ID))
+                continue;
+
+            if (name==PROP_LIFETIMER)
+            {
+                yWarning("property \"%s\" cannot be indexed!",PROP_LIFETIMER);
+                continue;
+            }
+
+            indexes[name]=Index();
+            yInfo("indexing property \"%s\"",name.c_str());
+        }
+
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+            indexItem(it->first,it->second.prop);
+    }
+
+    /************************************************************************/
+    void disableSave()
+    {
+        nosavedb=true;
+    }
+
+    /************************************************************************/
+    bool checkJournal(const string &fileName)
+    {
+        // take a snapshot of the content in a journal
+        // and verify that its replay yields the same items
+        if (journal.isOpen() || !journal.open(fileName))
+            return false;
+
+        compact();
+        journal.close();
+
+        DataBase replica;
+        replica.disableSave();
+        bool ok=replica.replay(fileName);
+        ::remove(fileName.c_str());
+
+        ReadGuard rg(rwLock);
+        ok=ok && (replica.itemsMap.size()==itemsMap.size());
+        for (map<int,Item>::iterator it=itemsMap.begin(); ok && (it!=itemsMap.end()); it++)
+        {
+            Bottle request,original,replayed;
+            Bottle &id=request.addList();
+            id.addString(PROP_ID);
+            id.addInt(it->first);
+
+            readItem(it->second,original);
+            ok=replica.get(&request,replayed) &&
+               (replayed.toString()==original.toString());
+        }
+
+        return ok;
+    }
+
     /************************************************************************/
     void setBroadcastPort(BufferedPort<Bottle> &broadcastPort)
     {
@@ -575,7 +1528,7 @@ public:
 
         yInfo("loading database from %s ...",dbFileName.c_str());
 
-        LockGuard lg(mutex);
+        WriteGuard wg(rwLock);
         clear();
         idCnt=0;
 
@@ -614,6 +1567,8 @@ public:
 
             int id=b2->get(1).asInt();
             itemsMap[id].prop=new Property(b3->toString().c_str());
+            indexItem(id,itemsMap[id].prop);
+            setLifeTimer(id,itemsMap[id],Time::now());
 
             if (idCnt<=id)
                 idCnt=id+1;
@@ -628,23 +1583,57 @@ public:
         if (nosavedb)
             return;
 
-        LockGuard lg(mutex);
-        string dbFileName=rf->getHomeContextPath().c_str();
-        dbFileName+="/";
-        dbFileName+=rf->find("db").asString().c_str();
+        ReadGuard rg(rwLock);
+        string dbFileName=getHomeDbName();
         yInfo("saving database in %s ...",dbFileName.c_str());
 
         FILE *fout=fopen(dbFileName.c_str(),"w");
+        if (fout==NULL)
+        {
+            yError("unable to save the database in %s!",dbFileName.c_str());
+            return;
+        }
         write(fout);
         fclose(fout);
 
+        // without journaling, a journal left by a previous run
+        // no longer reflects the content and is discarded
+        if (!journal.isOpen())
+            ::remove(getJournalName().c_str());
+
         yInfo("database stored");
     }
 
+    /************************************************************************/
+    string getHomeDbName() const
+    {
+        string dbFileName=rf->getHomeContextPath().c_str();
+        dbFileName+="/";
+        dbFileName+=rf->find("db").asString().c_str();
+        return dbFileName;
+    }
+
+    /************************************************************************/
+    string getJournalName() const
+    {
+        return getHomeDbName()+".journal";
+    }
+
+    /************************************************************************/
+    static bool getModificationTime(const string &fileName, time_t &t)
+    {
+        struct stat st;
+        if (stat(fileName.c_str(),&st)!=0)
+            return false;
+
+        t=st.st_mtime;
+        return true;
+    }
+
     /************************************************************************/
     void dump()
     {
-        LockGuard lg(mutex);
+        ReadGuard rg(rwLock);
         yInfo("dumping database content ...");
 
         if (itemsMap.size()==0)
@@ -660,11 +1649,15 @@ public:
         {
             if (pBroadcastPort->getOutputCount()>0)
             {
-                LockGuard lg(mutex);
+                LockGuard lg(bcMutex);
                 Bottle &bottle=pBroadcastPort->prepare();
                 bottle.clear();
 
                 bottle.addString(type.c_str());
+
+                // serialize a snapshot of the content under the shared
+                // lock, while the transmission does not hold writers
+                rwLock.lockRead();
                 if (itemsMap.empty())
                     bottle.addString(BCTAG_EMPTY);
                 else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
@@ -673,8 +1666,9 @@ public:
                     Bottle &idList=item.addList();
                     idList.addString(PROP_ID);
                     idList.addInt(it->first);
-                    item.read(*it->second.prop);
+                    readItem(it->second,item);
                 }
+                rwLock.unlockRead();
 
                 pBroadcastPort->writeStrict();
             }
@@ -682,7 +1676,7 @@ public:
     }
 
     /************************************************************************/
-    bool add(Bottle *content)
+    bool add(Bottle *content, int &id)
     {
         if (content==NULL)
             return false;
@@ -693,9 +1687,14 @@ public:
             return false;
         }
 
-        LockGuard lg(mutex);
-        itemsMap[idCnt].prop=new Property(content->toString().c_str());
-        itemsMap[idCnt].lastUpdate=Time::now();
+        WriteGuard wg(rwLock);
+        id=idCnt++;
+        Item &item=itemsMap[id];
+        item.prop=new Property(content->toString().c_str());
+        item.lastUpdate=Time::now();
+        indexItem(id,item.prop);
+        setLifeTimer(id,item,item.lastUpdate);
+        journal.append(JOURNAL_PUT,id,item.lastUpdate,content);
 
         return true;
     }
@@ -712,8 +1711,9 @@ public:
             {
                 if (content->get(0).asVocab()==OPT_ALL)
                 {
-                    LockGuard lg(mutex);
+                    WriteGuard wg(rwLock);
                     clear();
+                    journal.append(JOURNAL_CLEAR,0,Time::now());
                     yInfo("database cleared");
                     return true;
                 }
@@ -728,7 +1728,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        WriteGuard wg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -736,12 +1736,23 @@ public:
             if (propSet!=NULL)
             {
                 for (int i=0; i<propSet->size(); i++)
-                    it->second.prop->unput(propSet->get(i).asString().c_str());
+                {
+                    string prop=propSet->get(i).asString().c_str();
+                    unindexProp(id,prop,it->second.prop);
+                    it->second.prop->unput(prop.c_str());
+
+                    if (prop==PROP_LIFETIMER)
+                        it->second.expiry=OPT_DISABLED;
+                }
 
                 it->second.lastUpdate=Time::now();
+                journal.append(JOURNAL_UNPUT,id,it->second.lastUpdate,propSet);
             }
             else
+            {
                 eraseItem(it);
+                journal.append(JOURNAL_DEL,id,Time::now());
+            }
 
             return true;
         }
@@ -763,7 +1774,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        ReadGuard rg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -778,13 +1789,18 @@ public:
                 {
                     string propName=propSet->get(i).asString().c_str();
                     if (pProp->check(propName.c_str()))
-                        prop.put(propName.c_str(),pProp->find(propName.c_str()));
+                    {
+                        if ((propName==PROP_LIFETIMER) && (it->second.expiry>=0.0))
+                            prop.put(propName.c_str(),getLifeTimer(it->second));
+                        else
+                            prop.put(propName.c_str(),pProp->find(propName.c_str()));
+                    }
                 }
 
                 response.read(prop);
             }
             else
-                response.read(*pProp);
+                readItem(it->second,response);
 
             return true;
         }
@@ -806,7 +1822,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        WriteGuard wg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -814,6 +1830,8 @@ public:
             if ((owner==OPT_OWNERSHIP_ALL) || (owner==agent))
             {
                 Property *pProp=it->second.prop;
+                double now=Time::now();
+                Bottle delta;
                 for (int i=0; i<content->size(); i++)
                 {
                     if (Bottle *option=content->get(i).asList())
@@ -827,14 +1845,23 @@ public:
                         if (prop==PROP_ID)
                             continue;
 
+                        unindexProp(id,prop,pProp);
                         pProp->unput(prop.c_str());
                         pProp->put(prop.c_str(),val);
+                        indexProp(id,prop,pProp);
+
+                        if (prop==PROP_LIFETIMER)
+                            setLifeTimer(id,it->second,now);
+
+                        if (journal.isOpen())
+                            delta.addList()=*option;
                     }
                     else
                         continue;
                 }
 
-                it->second.lastUpdate=Time::now();
+                it->second.lastUpdate=now;
+                journal.append(JOURNAL_SET,id,now,&delta);
                 return true;
             }
         }
@@ -856,7 +1883,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        WriteGuard wg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -885,7 +1912,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        WriteGuard wg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -914,7 +1941,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        ReadGuard rg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -941,7 +1968,7 @@ public:
 
         int id=content->find(PROP_ID).asInt();
 
-        LockGuard lg(mutex);
+        ReadGuard rg(rwLock);
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
@@ -965,7 +1992,7 @@ public:
         if (content==NULL)
             return false;
 
-        LockGuard lg(mutex);
+        ReadGuard rg(rwLock);
         if (content->size()==1)
         {
             if (content->get(0).isVocab() || content->get(0).isString())
@@ -982,125 +2009,106 @@ public:
             }
         }
 
-        deque<Condition> condList;
-        deque<string>    opList;
-
-        // we cannot accept a conditions string ending with
-        // a boolean operator
-        if (!(content->size()&0x01))
-        {
-            yWarning("uncorrect conditions received!");
-            return false;
-        }
+        // compile the conditions once and reuse the plan
+        // whenever the same request is received again
+        // (concurrent readers share the cache, hence the plan is copied)
+        string key=content->toString().c_str();
+        QueryPlan plan;
 
-        // parse the received conditions and build the lists
-        for (int i=0; i<content->size(); i+=2)
+        planMutex.lock();
+        map<string,QueryPlan>::iterator it=plans.find(key);
+        if (it!=plans.end())
+            plan=it->second;
+        else
         {
-            if (Bottle *b=content->get(i).asList())
-            {
-                Condition condition;
-                string operation;
-
-                if (b->size()==1)
-                {
-                    condition.prop=b->get(0).asString().c_str();
-                    condition.compare=&relationalOperators::alwaysTrue;
-                }
-                else if (b->size()>2)
-                {
-                    condition.prop=b->get(0).asString().c_str();
-                    operation=b->get(1).asString().c_str();
-                    condition.val=b->get(2);
-
-                    if (operation==">")
-                        condition.compare=&relationalOperators::greater;
-                    else if (operation==">=")
-                        condition.compare=&relationalOperators::greaterEqual;
-                    else if (operation=="<")
-                        condition.compare=&relationalOperators::lower;
-                    else if (operation=="<=")
-                        condition.compare=&relationalOperators::lowerEqual;
-                    else if (operation=="==")
-                        condition.compare=&relationalOperators::equal;
-                    else if (operation=="!=")
-                        condition.compare=&relationalOperators::notEqual;
-                    else
-                    {
-                        yWarning("unknown relational operator '%s'!",operation.c_str());
-                        return false;
-                    }
-                }
-                else
-                {
-                    yWarning("wrong condition given!");
-                    return false;
-                }
-
-                condList.push_back(condition);
-
-                if ((i+1)<content->size())
-                {
-                    operation=content->get(i+1).asString().c_str();
-                    if ((operation!="||") && (operation!="&&"))
-                    {
-                        yWarning("unknown boolean operator '%s'!",operation.c_str());
-                        return false;
-                    }
-                    else
-                        opList.push_back(operation);
-                }
-            }
-            else
+            if (!compile(content,plan))
             {
-                yWarning("wrong condition given!");
+                planMutex.unlock();
                 return false;
             }
-        }
 
-        response.clear();
+            if (plans.size()>=DB_MAX_PLANS)
+                plans.clear();
 
-        // apply the conditions to each item
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
-        {
-            // do recursion and keep only the item that
-            // satisfies the whole list of conditions
-            if (recursiveCheck(it->second.prop,condList,opList))
-                response.addInt(it->first);
+            plans[key]=plan;
         }
+        planMutex.unlock();
+
+        response.clear();
+        execute(plan,response);
 
         return true;
     }
 
     /************************************************************************/
-    void periodicHandler(const double dt)   // manage the items life-timers
+    void periodicHandler()      // manage the items life-timers
     {
-        mutex.lock();
+        rwLock.lockWrite();
+        double now=Time::now();
+        deque<pair<double,int> > fired;
+        wheel.advance(now,fired);
+
+        // timers of erased items or whose life-timer
+        // has been changed in the meanwhile are discarded
         bool erased=false;
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        for (size_t i=0; i<fired.size(); i++)
         {
-            Property *pProp=it->second.prop;
-            if (pProp->check(PROP_LIFETIMER))
+            map<int,Item>::iterator it=itemsMap.find(fired[i].second);
+            if (it!=itemsMap.end())
             {
-                double lifeTimer=pProp->find(PROP_LIFETIMER).asDouble()-dt;
-                if (lifeTimer<=0.0)
-                {
-                    eraseItem(it);
-                    erased=true;
-                    break;
-                }
-                else
+                if (it->second.expiry==fired[i].first)
                 {
-                    pProp->unput(PROP_LIFETIMER);
-                    pProp->put(PROP_LIFETIMER,lifeTimer);
+                    if (it->second.expiry>now)
+                        wheel.schedule(it->first,it->second.expiry);
+                    else
+                    {
+                        eraseItem(it);
+                        journal.append(JOURNAL_DEL,fired[i].second,now);
+                        erased=true;
+                    }
                 }
             }
         }
-        mutex.unlock();
+        rwLock.unlockWrite();
+
+        if (journal.isOpen())
+            compact(false);
 
         if (asyncBroadcast && erased)
             broadcast(BCTAG_ASYNC);
     }
 
+    /************************************************************************/
+    void compact(const bool force=true)
+    {
+        // writers are kept out while the snapshot is taken
+        ReadGuard rg(rwLock);
+        if (!force && !journal.needsCompaction())
+            return;
+
+        if (!journal.beginSnapshot())
+        {
+            yError("unable to compact the journal!");
+            return;
+        }
+
+        double now=Time::now();
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        {
+            Bottle item;
+            readItem(it->second,item);
+            journal.appendSnapshot(it->first,now,item);
+        }
+
+        journal.commitSnapshot();
+    }
+
+    /************************************************************************/
+    bool isJournaling() const
+    {
+        return journal.isOpen();
+    }
+
     /************************************************************************/
     bool isQuitting() const
     {
@@ -1130,14 +2138,14 @@ public:
                     break;
                 }
 
+                int id;
                 Bottle *content=command.get(1).asList();
-                if (add(content))
+                if (add(content,id))
                 {
                     reply.addVocab(REP_ACK);
                     Bottle &b=reply.addList();
                     b.addString(PROP_ID);
-                    b.addInt(idCnt);
-                    idCnt++;
+                    b.addInt(id);
 
                     if (asyncBroadcast)
                         broadcast(BCTAG_ASYNC);
@@ -1415,9 +2423,12 @@ public:
         if ((type!=BCTAG_EMPTY) && (type!=BCTAG_SYNC) && (type!=BCTAG_ASYNC))
             return false;
 
-        mutex.lock();
+        rwLock.lockWrite();
         clear();
 
+        double now=Time::now();
+        journal.append(JOURNAL_CLEAR,0,now);
+
         if (type!=BCTAG_EMPTY)
         {
             idCnt=0;
@@ -1432,7 +2443,11 @@ public:
                             if (idList->get(0).asString()==PROP_ID)
                             {
                                 int id=idList->get(1).asInt();
-                                itemsMap[id].prop=new Property(item->tail().toString().c_str());
+                                Bottle content=item->tail();
+                                itemsMap[id].prop=new Property(content.toString().c_str());
+                                indexItem(id,itemsMap[id].prop);
+                                setLifeTimer(id,itemsMap[id],now);
+                                journal.append(JOURNAL_PUT,id,now,&content);
 
                                 if (idCnt<=id)
                                     idCnt=id+1;
@@ -1443,7 +2458,7 @@ public:
             }
         }
 
-        mutex.unlock();
+        rwLock.unlockWrite();
 
         if (asyncBroadcast)
             broadcast(BCTAG_ASYNC);
@@ -1460,6 +2475,7 @@ protected:
     DataBase *pDataBase;
     unsigned int nCalls;
     double cumTime;
+    Mutex mutex;
 
     /************************************************************************/
     bool read(ConnectionReader &connection)
@@ -1471,8 +2487,13 @@ protected:
         Bottle reply;
         double t0=Time::now();
         pDataBase->respond(connection,command,reply);
-        cumTime+=Time::now()-t0;
+        double dt=Time::now()-t0;
+
+        // each connection is served by its own thread
+        mutex.lock();
+        cumTime+=dt;
         nCalls++;
+        mutex.unlock();
 
         if (ConnectionWriter *writer=connection.getWriter())
             reply.write(*writer);
@@ -1496,8 +2517,9 @@ public:
     }
 
     /************************************************************************/
-    void getStats(unsigned int &nCalls, double &cumTime) const
+    void getStats(unsigned int &nCalls, double &cumTime)
     {
+        LockGuard lg(mutex);
         nCalls=this->nCalls;
         cumTime=this->cumTime;
     }
@@ -1591,10 +2613,11 @@ public:
     /************************************************************************/
     bool updateModule()
     {
-        dataBase.periodicHandler(getPeriod());
+        dataBase.periodicHandler();
 
         // back-up straightaway the database each 15 minutes
-        if ((++cnt)*getPeriod()>(15.0*60.0))
+        // unless the changes are already kept by the journal
+        if (!dataBase.isJournaling() && ((++cnt)*getPeriod()>(15.0*60.0)))
         {
             dataBase.save();
             cnt=0;
@@ -1625,6 +2648,104 @@ public:
 };
 
 
+/************************************************************************/
+int runBenchmark(ResourceFinder &rf)
+{
+    int nItems=rf.check("bench-items",Value(10000)).asInt();
+    int nRequests=rf.check("bench-requests",Value(10000)).asInt();
+    const char *entities[]={"object","hand","table","agent"};
+
+    Bottle query;
+    query.fromString("(entity == object) && (x < 0.3)");
+
+    Bottle indexedProps;
+    indexedProps.addString("entity");
+    indexedProps.addString("x");
+
+    yInfo("benchmarking %d items with %d mixed set/ask requests ...",nItems,nRequests);
+    int matches[2];
+    for (int pass=0; pass<2; pass++)
+    {
+        DataBase dataBase;
+        dataBase.disableSave();
+        if (pass>0)
+            dataBase.setIndexes(indexedProps);
+
+        // same traffic in both passes
+        srand(0);
+        for (int i=0; i<nItems; i++)
+        {
+            Bottle content;
+            Bottle &entity=content.addList();
+            entity.addString("entity");
+            entity.addString(entities[i%4]);
+            Bottle &x=content.addList();
+            x.addString("x");
+            x.addDouble(rand()/(double)RAND_MAX);
+            Bottle &y=content.addList();
+            y.addString("y");
+            y.addDouble(rand()/(double)RAND_MAX);
+            Bottle &position=content.addList();
+            position.addString("position_3d");
+            for (int j=0; j<3; j++)
+                position.addDouble(rand()/(double)RAND_MAX);
+
+            int id;
+            dataBase.add(&content,id);
+        }
+
+        int nSet=0,nAsk=0;
+        double tSet=0.0,tAsk=0.0;
+        matches[pass]=0;
+        for (int i=0; i<nRequests; i++)
+        {
+            if (rand()%5==0)
+            {
+                Bottle response;
+                double t0=Time::now();
+                dataBase.ask(&query,response);
+                tAsk+=Time::now()-t0;
+                matches[pass]+=response.size();
+                nAsk++;
+            }
+            else
+            {
+                Bottle content;
+                Bottle &id=content.addList();
+                id.addString(PROP_ID);
+                id.addInt(rand()%nItems);
+                Bottle &x=content.addList();
+                x.addString("x");
+                x.addDouble(rand()/(double)RAND_MAX);
+
+                double t0=Time::now();
+                dataBase.set(&content,OPT_OWNERSHIP_ALL);
+                tSet+=Time::now()-t0;
+                nSet++;
+            }
+        }
+
+        yInfo("%s: %g [us/set] on %d requests; %g [us/ask] on %d requests",
+              pass>0?"indexes":"scan",nSet>0?1e6*tSet/nSet:0.0,nSet,
+              nAsk>0?1e6*tAsk/nAsk:0.0,nAsk);
+
+        if ((pass==0) && !dataBase.checkJournal("objectsPropertiesCollector-bench.journal"))
+        {
+            yError("the journal does not reproduce the database content!");
+            return 1;
+        }
+    }
+
+    if (matches[0]!=matches[1])
+    {
+        yError("indexed and scanned queries returned different results!");
+        return 1;
+    }
+
+    return 0;
+}
+
+
 /************************************************************************/
 int main(int argc, char *argv[])
 {
@@ -1647,10 +2768,17 @@ int main(int argc, char *argv[])
         printf("\t--sync-bc        <T>: broadcast the database content each T seconds\n");
         printf("\t--async-bc          : broadcast the database content whenever a change occurs\n");
         printf("\t--stats             : enable statistics printouts\n");
+        printf("\t--index \"(<p0> ...)\": maintain secondary indexes on the given properties\n");
+        printf("\t--journal           : keep an append-only journal of the changes\n");
+        printf("\t--bench-items    <N>: run the set/ask benchmark on N items and quit\n");
+        printf("\t--bench-requests <M>: number of requests issued by the benchmark\n");
         printf("\n");
         return 0;
     }
 
+    if (rf.check("bench-items"))
+        return runBenchmark(rf);
+
     if (!yarp.checkNetwork())
     {
         yError("YARP server not available!");
@@ -28,6 +28,7 @@
 #include <yarp/sig/Vector.h>
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/RateThread.h>
+#include <yarp/os/Thread.h>
 #include <yarp/os/ResourceFinder.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/dev/IAnalogSensor.h>
@@ -46,6 +47,32 @@ namespace iCub{
 
 namespace skinManager{
 
+/**
+* Worker thread compensating a subset of the skin ports (one every stride ports, starting from first)
+* in parallel with the compensation thread.
+*/
+class CompensationWorker : public Thread
+{
+public:
+    CompensationWorker(vector<Compensator*> &_compensators, vector<bool> &_compWorking, unsigned int _first, unsigned int _stride)
+        : compensators(_compensators), compWorking(_compWorking), first(_first), stride(_stride), startSem(0), doneSem(0) {}
+
+    void trigger()  { startSem.post(); }    // start processing the ports
+    void waitDone() { doneSem.wait(); }     // wait until the ports have been processed
+    void onStop()   { startSem.post(); }
+    void run();
+
+    static void compensatePorts(vector<Compensator*> &compensators, vector<bool> &compWorking, unsigned int first, unsigned int stride);
+
+private:
+    vector<Compensator*> &compensators;
+    vector<bool> &compWorking;
+    unsigned int first;
+    unsigned int stride;
+    Semaphore startSem;
+    Semaphore doneSem;
+};
+
 class CompensationThread : public RateThread
 {
 public:
@@ -136,9 +163,11 @@ private:
     vector<bool> compEnable;            // true if the related compensator is enabled, false otherwise
     vector<bool> compWorking;           // true if the related compensator is working, false otherwise
     unsigned int compensatorCounter;    // count the number of compensators that are working 
+    vector<CompensationWorker*> workers;    // threads compensating the ports in parallel (empty: serial compensation)
 
     // SKIN EVENTS
     bool skinEventsOn;
+    bool skinEventsCompact;         // if true the skin events are written in the compact format
 
     /* ports */
     BufferedPort<skinContactList> skinEventsPort;   // skin events output port
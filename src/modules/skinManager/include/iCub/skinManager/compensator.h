@@ -61,6 +61,7 @@ private:
     static const int MIN_TOUCH_THR = 1;         // min value assigned to the touch thresholds (i.e. the 95% percentile)
     static const double BIN_TOUCH;              // output value of the binarization filter when touch is detected
     static const double BIN_NO_TOUCH;           // output value of the binarization filter when no touch is detected
+    static const long long NO_CELL = -1;        // grid cell of the taxels without a finite position
     
     // INIT
     unsigned int skinDim;                       // number of taxels (for the hand it is 192)
@@ -71,13 +72,28 @@ private:
     unsigned int linkNum;                       // number of the link
 
     // SKIN CONTACTS
-    vector< list<int> >     neighborsXtaxel;    // list of neighbors for each taxel    
+    vector<int>             neighOffsets;       // neighbors of taxel i are neighIds[neighOffsets[i]] ... neighIds[neighOffsets[i+1]-1]
+    vector<int>             neighIds;           // neighbors of all the taxels, stored contiguously (CSR format)
+    vector< pair<long long,int> > taxelCells;   // (grid cell, taxel id) couples sorted by grid cell
+    vector<long long>       cellXtaxel;         // grid cell of each taxel (NO_CELL if its position is not finite)
+    bool                    neighborsAll;       // true if every taxel is neighbor with all the other taxels (the CSR arrays are empty)
+    bool                    neighborsDirty;     // true if the CSR arrays must be rebuilt from the grid before being used
+    double                  cellSize;           // size of the grid cells used to look for neighbors
     vector<Vector>          taxelPos;           // taxel positions {xPos, yPos, zPos}
     vector<Vector>          taxelOri;           // taxel normals {xOri, yOri, zOri}
     Vector                  taxelPoseConfidence;// taxels pose estimation confidence
     double                  maxNeighDist;       // max distance between two neighbor taxels
     Semaphore               poseSem;            // mutex to access taxel poses
 
+    // CONTACT CLUSTERING (scratch buffers, preallocated to avoid allocations at every cycle)
+    vector<int>             activeTaxelList;    // ids of the active taxels, in ascending order
+    vector<int>             ufParent;           // union-find parent of each active taxel
+    vector<int>             contactXroot;       // contact id of each union-find root
+    vector<int>             contactOffsets;     // taxels of contact k are contactTaxels[contactOffsets[k]] ... contactTaxels[contactOffsets[k+1]-1]
+    vector<int>             contactTaxels;      // taxels of all the contacts, stored contiguously
+    vector<double>          contactSums;        // per-contact accumulators (see CONTACT_SUM_* offsets)
+    vector<unsigned int>    taxelList;          // taxel list of the contact under construction
+
     // COMPENSATION
     vector<bool> touchDetected;                 // true if touch has been detected in the last read of the taxel
     vector<bool> touchDetectedFilt;             // true if touch has been detected after applying the filtering
@@ -90,6 +106,7 @@ private:
     Vector compensatedData;                     // compensated tactile data (that is rawData-touchThreshold)
     Vector compensatedDataOld;                  // compensated tactile data of the previous step (used for smoothing filter)
     Vector compensatedDataFilt;                 // compensated tactile data after smooth filter
+    Vector driftGains;                          // gain of the baseline drift compensation of each taxel in the last read
     
     // CALIBRATION
     int calibrationRead;                        // count the calibration reads
@@ -119,6 +136,7 @@ private:
     /* ports */
     BufferedPort<Vector> compensatedTactileDataPort;    // output port
     BufferedPort<Bottle>* infoPort;                     // info output port
+    static Semaphore infoPortSem;                       // mutex to access the info port (shared by all the compensators)
     BufferedPort<Vector> inputPort;
     Stamp timestamp;                                    // timestamp of last data read from inputPort
 
@@ -129,6 +147,11 @@ private:
     void sendInfoMsg(string msg);
     void computeNeighbors();
     void updateNeighbors(unsigned int taxelId);
+    void buildNeighbors(int *minNeighbors=NULL, int *maxNeighbors=NULL);
+    void buildGrid();
+    int findContactRoot(int i);
+    long long computeCell(const Vector &pos, int dx=0, int dy=0, int dz=0) const;
+    void getNeighborsFromGrid(unsigned int taxelId, vector<int> &neighbors) const;
 
     /* class methods */
 public:
@@ -103,6 +103,9 @@ The following key-value pairs can be specified as command-line parameters by pre
     \t- y(t) = (1-alpha)*x(t) + alpha*y(t-1)
  - \c smoothFactor \c [0.5] \n
    alpha value of the smoothing filter, in [0, 1] where 0 is no smoothing at all and 1 is the max smoothing possible.
+ - \c compensationWorkers \c [0] \n
+   number of additional threads used to compensate the input ports in parallel (at most the number of ports minus one); 
+   with 0 all the ports are compensated serially by the compensation thread.
 .
 An optional section called SKIN_EVENTS may be specified in the configuration file.
 These are the parameters of this section:
@@ -125,6 +128,9 @@ These are the parameters of this section:
     missing calibration procedure for that skin part).
  - \c maxNeighborDist \c 0.015 \n
     maximum distance between two neighbor tactile sensors (in meters).
+ - \c compactFormat \c [false] \n
+    if true the skinContactList is written in the compact binary format (see iCub::skinDynLib::skinContactList),
+    which is smaller and faster to serialize, but it can be read only by recent versions of skinDynLib.
  
 
 \section portsa_sec Ports Accessed
@@ -31,6 +31,27 @@ using namespace yarp::math;
 using namespace iCub::skinManager;
 
 
+void CompensationWorker::compensatePorts(vector<Compensator*> &compensators, vector<bool> &compWorking, unsigned int first, unsigned int stride){
+    for(unsigned int i=first; i<compensators.size(); i+=stride){
+        if(compWorking[i]){
+            if(compensators[i]->readRawAndWriteCompensatedData()){
+                //If the read succeeded, update the baseline
+                compensators[i]->updateBaseline();
+            }
+        }
+    }
+}
+
+void CompensationWorker::run(){
+    while(true){
+        startSem.wait();
+        if(isStopping())
+            break;
+        compensatePorts(compensators, compWorking, first, stride);
+        doneSem.post();
+    }
+}
+
 CompensationThread::CompensationThread(string name, ResourceFinder* rf, string robotName, double _compensationGain, double _contactCompensationGain, 
                                        int addThreshold, float minBaseline, bool zeroUpRawData, 
                                        int period, bool binarization, bool smoothFilter, float smoothFactor)
@@ -135,6 +156,7 @@ bool CompensationThread::threadInit()
 
     // configure the SKIN_EVENT if the corresponding section exists
     skinEventsOn = false;
+    skinEventsCompact = false;
     Bottle &skinEventsConf = rf->findGroup("SKIN_EVENTS");
     if(!skinEventsConf.isNull()){
         yDebug("SKIN_EVENTS section found");
@@ -144,6 +166,13 @@ bool CompensationThread::threadInit()
         else
             skinEventsOn = true;
 
+        skinEventsCompact = skinEventsConf.check("compactFormat", Value(false)).asBool();
+        // the readers of the skin events (e.g. wholeBodyDynamics) do not keep the state of a delta encoded stream
+        if(skinEventsConf.check("deltaEncoding"))
+            yWarning("SKIN_EVENTS deltaEncoding is not supported by the skin event readers, option ignored");
+        if(skinEventsCompact)
+            sendDebugMsg("Skin events in compact format.");
+
         if(skinEventsConf.check("skinParts")){
             Bottle* skinPartList = skinEventsConf.find("skinParts").asList();
             if(skinPartList->size() != portNum){
@@ -185,6 +214,18 @@ bool CompensationThread::threadInit()
             }
         }
     }
+    // the ports are compensated in parallel by the thread and by the workers (if any)
+    int workerNum = rf->check("compensationWorkers", Value(0)).asInt();
+    workerNum = workerNum<(int)portNum-1 ? workerNum : (int)portNum-1;
+    for(int w=0; w<workerNum; w++){
+        workers.push_back(new CompensationWorker(compensators, compWorking, w+1, workerNum+1));
+        workers.back()->start();
+    }
+    if(workerNum>0){
+        stringstream msg; msg<< "Compensating the ports on "<< workerNum+1<< " threads.";
+        sendDebugMsg(msg.str());
+    }
+
     if(skinEventsOn)
         sendDebugMsg("Skin events ENABLED.");
     else
@@ -209,14 +250,11 @@ void CompensationThread::run(){
     if( state == compensation){
         // It reads the raw data, computes the difference between the read values and the baseline 
         // and outputs these values
-        FOR_ALL_PORTS(i){
-            if(compWorking[i]){
-                if(compensators[i]->readRawAndWriteCompensatedData()){
-                    //If the read succeeded, update the baseline
-                    compensators[i]->updateBaseline();
-                }
-            }
-        }
+        for(size_t w=0; w<workers.size(); w++)
+            workers[w]->trigger();
+        CompensationWorker::compensatePorts(compensators, compWorking, 0, workers.size()+1);
+        for(size_t w=0; w<workers.size(); w++)
+            workers[w]->waitDone();
 
         if(skinEventsOn){
             sendSkinEvents();
@@ -252,6 +290,7 @@ void CompensationThread::run(){
 void CompensationThread::sendSkinEvents(){
     skinContactList &skinEvents = skinEventsPort.prepare();
     skinEvents.clear();
+    skinEvents.setCompactSerialization(skinEventsCompact);
 
     skinContactList temp;
     Stamp timestamp;
@@ -269,7 +308,8 @@ void CompensationThread::sendSkinEvents(){
 #endif
     
     skinEventsPort.setEnvelope(timestamp);
-    skinEventsPort.write();     // send something anyway (if there is no contact the bottle is empty)
+    // send something anyway (if there is no contact the bottle is empty)
+    skinEventsPort.write();
 }
 
 void CompensationThread::checkErrors(){
@@ -318,6 +358,12 @@ bool CompensationThread::doesBaselineExceed(unsigned int &compInd, unsigned int
 
 void CompensationThread::threadRelease() 
 {
+    for(size_t w=0; w<workers.size(); w++){
+        workers[w]->stop();
+        delete workers[w];
+    }
+    workers.clear();
+
     FOR_ALL_PORTS(i){
         delete compensators[i];
     }
@@ -32,6 +32,7 @@ using namespace iCub::skinDynLib;
 
 const double Compensator::BIN_TOUCH     = 100.0;
 const double Compensator::BIN_NO_TOUCH  = 0.0;
+Semaphore Compensator::infoPortSem(1);
 
 Compensator::Compensator(string _name, string _robotName, string outputPortName, string inputPortName, BufferedPort<Bottle>* _infoPort, 
                          double _compensationGain, double _contactCompensationGain, int addThreshold, float _minBaseline, bool _zeroUpRawData, 
@@ -133,12 +134,13 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
     taxelOri.resize(skinDim, zeros(3));
     taxelPoseConfidence.resize(skinDim,0.0);
     maxNeighDist = MAX_NEIGHBOR_DISTANCE;
-    // by default every taxel is neighbor with all the other taxels
-    list<int> defaultNeighbors(skinDim);
-    int i=0;
-    for(list<int>::iterator it=defaultNeighbors.begin();it!=defaultNeighbors.end();it++, i++) 
-        *it = i;
-    neighborsXtaxel.resize(skinDim, defaultNeighbors);
+    // by default every taxel is neighbor with all the other taxels: this is
+    // flagged rather than stored, so that no skinDim^2 neighbor ids are allocated
+    neighborsAll = true;
+    neighborsDirty = false;
+    neighOffsets.assign(skinDim+1, 0);
+    neighIds.clear();
+    buildGrid();
 
     // test read to check if the skin is broken (all taxel output is 0)
     if(robotName!="icubSim" && readInputData(compensatedData)){
@@ -344,37 +346,71 @@ bool Compensator::readRawAndWriteCompensatedData(){
     Vector& compensatedData2Send = compensatedTactileDataPort.prepare();
     compensatedData2Send.resize(skinDim);   // local variable with data to send
     compensatedData.resize(skinDim);        // global variable with data to store
-    
-    double d;
-    for(unsigned int i=0; i<skinDim; i++){
-        // baseline compensation
-        d =  (double)( zeroUpRawData ? rawData(i)-baselines[i] : MAX_SKIN-rawData(i)-baselines[i] );
-        d =   min<double>( MAX_SKIN, d);
-        compensatedData[i] = d;     // save the data before applying filtering
+    driftGains.resize(skinDim);
 
-        // detect touch (before applying filtering, so the compensation algorithm is not affected by the filters)
-        touchDetected[i] = (d > touchThresholds[i] + addThreshold);
-        
-        // detect subtouch
-        subTouchDetected[i] = (d < -touchThresholds[i] - addThreshold);
-        
-        // smooth filter
-        if(smoothFilter){
-            smoothFactorSem.wait();
-            d = (1-smoothFactor)*d + smoothFactor*compensatedDataOld(i);
-            smoothFactorSem.post();
-            compensatedDataOld(i) = d;    // update old value
+    // snapshot of the filter parameters, taken once per cycle
+    smoothFactorSem.wait();
+    const double alpha = smoothFactor;
+    smoothFactorSem.post();
+    const bool smooth = smoothFilter;
+    const bool binarize = binarization;
+    const double addThr = addThreshold;
+    const double gainNoTouch = compensationGain*0.02;
+    const double gainTouch = contactCompensationGain*0.02;
+
+    // the per-taxel passes below are branch-free over plain arrays, so that
+    // the compiler can vectorize them
+    const int n = skinDim;
+    const double *raw = rawData.data();
+    const double *base = baselines.data();
+    const double *thr = touchThresholds.data();
+    double *comp = compensatedData.data();
+    double *filt = compensatedDataFilt.data();
+    double *old = compensatedDataOld.data();
+    double *out = compensatedData2Send.data();
+
+    // baseline compensation
+    const double sign = zeroUpRawData ? 1.0 : -1.0;
+    const double offset = zeroUpRawData ? 0.0 : (double)MAX_SKIN;
+    for(int i=0; i<n; i++){
+        double d = offset + sign*raw[i] - base[i];
+        comp[i] = d<MAX_SKIN ? d : MAX_SKIN;   // save the data before applying filtering
+    }
+
+    // smooth filter
+    if(smooth){
+        for(int i=0; i<n; i++){
+            filt[i] = (1.0-alpha)*comp[i] + alpha*old[i];
+            old[i] = filt[i];    // update old value
         }
-        compensatedDataFilt[i] = d;
-
-        // binarization filter
-        // here we don't use the touchDetected array because, if the smooth filter is on,
-        // we want to use the filtered values
-        touchDetectedFilt[i] = (d > touchThresholds[i] + addThreshold);
-        if(binarization)
-            d = ( touchDetectedFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
-        
-        compensatedData2Send[i] = max<double>(0.0, d); // trim only data to send because you need negative values for update baseline
+    }
+    else{
+        for(int i=0; i<n; i++)
+            filt[i] = comp[i];
+    }
+
+    // binarization filter
+    // here we don't use the touchDetected array because, if the smooth filter is on,
+    // we want to use the filtered values;
+    // trim only data to send because you need negative values for update baseline
+    if(binarize){
+        for(int i=0; i<n; i++)
+            out[i] = filt[i]>thr[i]+addThr ? BIN_TOUCH : BIN_NO_TOUCH;
+    }
+    else{
+        for(int i=0; i<n; i++)
+            out[i] = filt[i]>0.0 ? filt[i] : 0.0;
+    }
+
+    // detect touch (before applying filtering, so the compensation algorithm is not affected by the filters),
+    // subtouch and touch after filtering; select the gain of the baseline drift compensation
+    double *gains = driftGains.data();
+    for(int i=0; i<n; i++){
+        double t = thr[i]+addThr;
+        touchDetected[i] = (comp[i] > t);
+        subTouchDetected[i] = (comp[i] < -t);
+        touchDetectedFilt[i] = (filt[i] > t);
+        gains[i] = (comp[i] > t) ? gainTouch : gainNoTouch;
     }
 
     compensatedTactileDataPort.write();
@@ -382,53 +418,29 @@ bool Compensator::readRawAndWriteCompensatedData(){
 }
 
 void Compensator::updateBaseline(){
-    double mean_change = 0, change, gain;
-    unsigned int non_touching_taxels = 0;
-    double d; 
-
-    for(unsigned int j=0; j<skinDim; j++) {
-        // *** Algorithm 1
-        /*if(!touchDetected[j]){
-            if(d > 0.5) {
-                baselines[j]        += compensationGain;
-                mean_change            += compensationGain;                //for changing the taxels where we detected touch
-            }else if(d < -0.5) {
-                baselines[j]        -= compensationGain;
-                mean_change            -= compensationGain;                //for changing the taxels where we detected touch
-            }
-        }*/
-
-        // *** Algorithm 2
-        /*if(!(touchDetected[j] || subTouchDetected[j])){
-            non_touching_taxels++;                                        //for changing the taxels where we detected touch
-            d = compensatedData(j);
-            if(fabs(d)>0.5){
-                change          = (compensationGain/50)*d/touchThresholds[j];
-                baselines[j]    += change;
-                mean_change     += change;
+    // the gain of each taxel has been selected by readRawAndWriteCompensatedData()
+    // according to touch detection (contactCompensationGain or compensationGain)
+    const int n = skinDim;
+    const double *comp = compensatedData.data();
+    const double *thr = touchThresholds.data();
+    const double *gains = driftGains.data();
+    double *base = baselines.data();
+    bool negative = false;
+    for(int j=0; j<n; j++){
+        base[j] += gains[j]*comp[j]/thr[j];
+        negative |= (base[j]<0.0);
+    }
+
+    if(negative){
+        for(int j=0; j<n; j++){
+            if(baselines[j]<0){
+                double change = gains[j]*comp[j]/thr[j];
+                char temp[300];
+                sprintf(temp, "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
+                    SkinPart_s[skinPart].c_str(), j, baselines[j], gains[j], comp[j], rawData[j], change, touchThresholds[j]);
+                sendInfoMsg(temp);
             }
-        }*/
-    
-        d = compensatedData(j);
-        if(touchDetected[j]){
-            gain            = contactCompensationGain*0.02;                
-        }else{
-            gain            = compensationGain*0.02;
-            non_touching_taxels++;
         }
-        change          = gain*d/touchThresholds[j];
-        baselines[j]    += change;
-        mean_change     += change;
-
-    //        if(j<5)
-    //        printf("%d touch detected %s, change %.6f, gain: %.3f\n", j, touchDetected[j]?"yes":"no", change, touchDetected[j]?contactCompensationGain:compensationGain);
-
-        if(baselines[j]<0){
-            char* temp = new char[300];
-            sprintf(temp, "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
-                SkinPart_s[skinPart].c_str(), j, baselines[j], gain, d, rawData[j], change, touchThresholds[j]);
-            sendInfoMsg(temp);
-        }      
     }
     
     //for compensating the taxels where we detected touch
@@ -465,97 +477,146 @@ bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline,
     return false;
 }
 
-skinContactList Compensator::getContacts(){    
-    vector<int>         contactXtaxel(skinDim, -1);     // contact for each taxel (-1 means no contact)
-    deque<deque<int> >  taxelsXcontact;                 // taxels for each contact
-    int                 contactId = 0;                  // id of the next contact to create
-    int                 neighCont;                      // id of the contact of the current neighbor
+// layout of the per-contact accumulators
+#define CONTACT_SUM_COP         0   // sum of pressure-weighted positions (3)
+#define CONTACT_SUM_GEO         3   // sum of positions (3)
+#define CONTACT_SUM_NORMAL      6   // sum of pressure-weighted normals (3)
+#define CONTACT_SUM_PRESS       9   // sum of pressures
+#define CONTACT_SUM_PRESS_COP   10  // sum of pressures of taxels with a position
+#define CONTACT_SUM_PRESS_NRM   11  // sum of pressures of taxels with a normal
+#define CONTACT_SUM_GEO_NUM     12  // number of taxels with a position
+#define CONTACT_SUM_SIZE        13
+
+int Compensator::findContactRoot(int i){
+    // path halving
+    while(ufParent[i]!=i){
+        ufParent[i] = ufParent[ufParent[i]];
+        i = ufParent[i];
+    }
+    return i;
+}
+
+skinContactList Compensator::getContacts(){
+    skinContactList contactList;
+
+    // no-ops after the first call
+    ufParent.resize(skinDim);
+    contactXroot.resize(skinDim);
+    contactTaxels.resize(skinDim);
+    contactOffsets.resize(skinDim+1);
+    contactSums.resize(CONTACT_SUM_SIZE*skinDim);
+    activeTaxelList.reserve(skinDim);
+    taxelList.reserve(skinDim);
+
+    activeTaxelList.clear();
+    for(unsigned int i=0; i<skinDim; i++)
+        if(touchDetectedFilt[i])
+            activeTaxelList.push_back(i);
+    if(activeTaxelList.empty())
+        return contactList;
 
     poseSem.wait();
     {
-        for(unsigned int i=0; i<skinDim; i++){
-            if(touchDetectedFilt[i] ){ // && contactXtaxel[i]<0 (second condition should always be true)
-                list<int> *neighbors = &(neighborsXtaxel[i]);
-                //printf("Taxel %d active. Going to check its %d neighbors\n", i, neighbors->size());
-                for(list<int>::iterator it=neighbors->begin(); it!=neighbors->end(); it++){
-                    neighCont = contactXtaxel[(*it)];
-                    if(neighCont >= 0){                                     // ** if neighbor belongs to a contact
-                        if(contactXtaxel[i]<0){                             // ** add taxel to pre-existing contact
-                            contactXtaxel[i] = neighCont;
-                            taxelsXcontact[neighCont].push_back(i);
-                            //printf("Add taxel to pre existing contact %d (neighbor %d)\n", neighCont, (*neighbors)[n]);
-                        }else if(contactXtaxel[i]!=neighCont){              // ** merge 2 contacts
-                            //mergeContacts(contactXtaxel[i], neighCont);
-                            int newId = min(contactXtaxel[i], neighCont);
-                            int oldId = max(contactXtaxel[i], neighCont);
-                            deque<int> tax2move = taxelsXcontact[oldId];
-                            for(deque<int>::iterator it=tax2move.begin(); it!=tax2move.end(); it++){
-                                contactXtaxel[(*it)] = newId;               // assign new contact id
-                                taxelsXcontact[newId].push_back((*it));     // add taxel ids to contact
-                            }
-                            taxelsXcontact[oldId].clear();      // clear the list of taxels belonging to the merged contact
-                            //printf("Merge two contacts: %d and %d\n", oldId, newId);
-                        }
-                    }
-
-                }
-                if(contactXtaxel[i]<0){            // ** if no neighbor belongs to a contact -> create new contact
-                    contactXtaxel[i] = contactId;
-                    taxelsXcontact.resize(contactId+1);
-                    taxelsXcontact[contactId].push_back(i);
-                    contactId++;
-                    //printf("New contact created: %d\n", contactId-1);
+        // the taxel positions changed since the last call
+        if(neighborsDirty)
+            buildNeighbors();
+
+        // union-find over the active taxels: two active neighbors belong to
+        // the same contact; the root of each set is its smallest taxel
+        for(size_t a=0; a<activeTaxelList.size(); a++)
+            ufParent[activeTaxelList[a]] = neighborsAll ? activeTaxelList[0] : activeTaxelList[a];
+        for(size_t a=0; a<activeTaxelList.size() && !neighborsAll; a++){
+            int i = activeTaxelList[a];
+            for(int n=neighOffsets[i]; n<neighOffsets[i+1]; n++){
+                int j = neighIds[n];
+                if(j<i && touchDetectedFilt[j]){
+                    int ri = findContactRoot(i);
+                    int rj = findContactRoot(j);
+                    if(ri<rj)       ufParent[rj] = ri;
+                    else if(rj<ri)  ufParent[ri] = rj;
                 }
             }
         }
-    }
-    poseSem.post();
 
-    skinContactList contactList;
-    Vector CoP(3), geoCenter(3), normal(3);
-    double pressure, pressureCoP, pressureNormal, out;
-    int activeTaxels, activeTaxelsGeo;
-    vector<unsigned int> taxelList;
-    for( deque<deque<int> >::iterator it=taxelsXcontact.begin(); it!=taxelsXcontact.end(); it++){
-        activeTaxels = it->size();
-        if(activeTaxels==0) continue;
-        
-        taxelList.resize(activeTaxels);
-        CoP.zero();
-        geoCenter.zero();
-        normal.zero();
-        pressure = pressureCoP = pressureNormal = 0.0;
-        activeTaxelsGeo = 0;
-        int i=0;
-        for( deque<int>::iterator tax=it->begin(); tax!=it->end(); tax++, i++){
-            out         = max(compensatedDataFilt[(*tax)], 0.0);
-            if(norm(taxelPos[(*tax)])!=0.0){  // if the taxel position estimate exists
-                CoP         += taxelPos[(*tax)] * out;
-                pressureCoP += out;
-                activeTaxelsGeo++;
-                geoCenter   += taxelPos[(*tax)];
+        // number the contacts in order of their smallest taxel and count their taxels
+        int contactNum = 0;
+        for(size_t a=0; a<activeTaxelList.size(); a++){
+            int i = activeTaxelList[a];
+            int r = findContactRoot(i);
+            if(r==i){
+                contactXroot[i] = contactNum;
+                contactOffsets[contactNum+1] = 0;
+                contactNum++;
+            }
+            contactOffsets[contactXroot[r]+1]++;
+        }
+        contactOffsets[0] = 0;
+        for(int k=0; k<contactNum; k++)
+            contactOffsets[k+1] += contactOffsets[k];
+
+        // single pass over the active taxels: fill the contacts and accumulate
+        // CoP, geometric center and normal of each contact
+        double *sums = &contactSums[0];
+        for(int j=0; j<CONTACT_SUM_SIZE*contactNum; j++)
+            sums[j] = 0.0;
+        for(size_t a=0; a<activeTaxelList.size(); a++){
+            int i = activeTaxelList[a];
+            int k = contactXroot[findContactRoot(i)];
+            contactTaxels[contactOffsets[k]++] = i;     // offsets are shifted back below
+            double *sum = sums+CONTACT_SUM_SIZE*k;
+            double out = max(compensatedDataFilt[i], 0.0);
+            const double *pos = taxelPos[i].data();
+            const double *ori = taxelOri[i].data();
+            if(pos[0]!=0.0 || pos[1]!=0.0 || pos[2]!=0.0){  // if the taxel position estimate exists
+                sum[CONTACT_SUM_COP]   += pos[0]*out;
+                sum[CONTACT_SUM_COP+1] += pos[1]*out;
+                sum[CONTACT_SUM_COP+2] += pos[2]*out;
+                sum[CONTACT_SUM_GEO]   += pos[0];
+                sum[CONTACT_SUM_GEO+1] += pos[1];
+                sum[CONTACT_SUM_GEO+2] += pos[2];
+                sum[CONTACT_SUM_PRESS_COP] += out;
+                sum[CONTACT_SUM_GEO_NUM] += 1.0;
             }
-            if(norm(taxelOri[(*tax)])!=0.0){  // if the taxel orientation estimate exists
-                normal          += taxelOri[(*tax)] * out;
-                pressureNormal  += out;
+            if(ori[0]!=0.0 || ori[1]!=0.0 || ori[2]!=0.0){  // if the taxel orientation estimate exists
+                sum[CONTACT_SUM_NORMAL]   += ori[0]*out;
+                sum[CONTACT_SUM_NORMAL+1] += ori[1]*out;
+                sum[CONTACT_SUM_NORMAL+2] += ori[2]*out;
+                sum[CONTACT_SUM_PRESS_NRM] += out;
             }
-            pressure    += out;
-            taxelList[i] = *tax;
+            sum[CONTACT_SUM_PRESS] += out;
+        }
+        for(int k=contactNum-1; k>0; k--)
+            contactOffsets[k] = contactOffsets[k-1];
+        contactOffsets[0] = 0;
+
+        Vector CoP(3), geoCenter(3), normal(3);
+        for(int k=0; k<contactNum; k++){
+            const double *sum = sums+CONTACT_SUM_SIZE*k;
+            int activeTaxels = contactOffsets[k+1]-contactOffsets[k];
+            int activeTaxelsGeo = (int)sum[CONTACT_SUM_GEO_NUM];
+            // if this is not the only contact and no taxel in this contact has a position => discard it
+            if(contactNum>1 && activeTaxelsGeo==0)
+                continue;
+
+            double pressureCoP = sum[CONTACT_SUM_PRESS_COP];
+            double pressureNormal = sum[CONTACT_SUM_PRESS_NRM];
+            for(int j=0; j<3; j++){
+                CoP[j]       = pressureCoP!=0.0     ? sum[CONTACT_SUM_COP+j]/pressureCoP       : sum[CONTACT_SUM_COP+j];
+                normal[j]    = pressureNormal!=0.0  ? sum[CONTACT_SUM_NORMAL+j]/pressureNormal : sum[CONTACT_SUM_NORMAL+j];
+                geoCenter[j] = activeTaxelsGeo!=0   ? sum[CONTACT_SUM_GEO+j]/activeTaxelsGeo   : sum[CONTACT_SUM_GEO+j];
+            }
+            double pressure = sum[CONTACT_SUM_PRESS]/activeTaxels;
+            taxelList.assign(contactTaxels.begin()+contactOffsets[k], contactTaxels.begin()+contactOffsets[k+1]);
+
+            skinContact c(bodyPart, skinPart, linkNum, CoP, geoCenter, taxelList, pressure, normal);
+            // set an estimate of the force that is with normal direction and intensity equal to the pressure
+            c.setForce(-0.05*activeTaxels*pressure*normal);
+            contactList.push_back(c);
         }
-        // if this is not the only contact and no taxel in this contact has a position => discard it
-        if(taxelsXcontact.size()>1 && activeTaxelsGeo==0)
-            continue;
-        if(pressureCoP!=0.0)        CoP         /= pressureCoP;
-        if(pressureNormal!=0.0)     normal      /= pressureNormal;
-        if(activeTaxelsGeo!=0)      geoCenter   /= activeTaxelsGeo;
-        pressure    /= activeTaxels;
-        skinContact c(bodyPart, skinPart, linkNum, CoP, geoCenter, taxelList, pressure, normal);
-        // set an estimate of the force that is with normal direction and intensity equal to the pressure
-        c.setForce(-0.05*activeTaxels*pressure*normal);
-        contactList.push_back(c);
     }
+    poseSem.post();
     //printf("ContactList: %s\n", contactList.toString().c_str());
-    
+
     return contactList;
 }
 
@@ -873,59 +934,148 @@ bool Compensator::setTaxelOrientation(unsigned int taxelId, const Vector &orient
     poseSem.post();
     return true;
 }
-void Compensator::computeNeighbors(){
-    neighborsXtaxel.clear();
-    neighborsXtaxel.resize(skinDim, list<int>(0));
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
+static bool isFinitePosition(const Vector &pos){
+    // x-x is NaN if x is either NaN or infinite
+    for(int k=0; k<3; k++)
+        if(!(pos[k]-pos[k]==0.0))
+            return false;
+    return true;
+}
+void Compensator::buildGrid(){
+    // the cells must not be smaller than the neighborhood radius,
+    // so that all the neighbors of a taxel lie in the 27 cells around it
+    cellSize = maxNeighDist>0.0 ? maxNeighDist : 1.0;
+    taxelCells.clear();
+    taxelCells.reserve(skinDim);
+    cellXtaxel.resize(skinDim);
+    int invalid = 0;
     for(unsigned int i=0; i<skinDim; i++){
-        for(unsigned int j=i+1; j<skinDim; j++){
-            //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-            v = taxelPos[i]-taxelPos[j];
-            if( dot(v,v) <= d2){
-                neighborsXtaxel[i].push_back(j);
-                neighborsXtaxel[j].push_back(i);
-                //printf("Taxels %d (%s) and %d (%s) are neighbors\n", i, taxelPos[i].toString().c_str(), j, taxelPos[j].toString().c_str());
-            }
-            //}
+        // taxels with a non-finite position are left out of the grid: they have no neighbors
+        if(!isFinitePosition(taxelPos[i])){
+            cellXtaxel[i] = NO_CELL;
+            invalid++;
+            continue;
         }
+        cellXtaxel[i] = computeCell(taxelPos[i]);
+        taxelCells.push_back(make_pair(cellXtaxel[i], (int)i));
     }
+    sort(taxelCells.begin(), taxelCells.end());
 
-    int minNeighbors=skinDim, maxNeighbors=0, ns;
+    if(invalid>0){
+        stringstream ss;
+        ss<<"WARNING: "<<invalid<<" taxels have a non-finite position and will have no neighbors";
+        sendInfoMsg(ss.str());
+    }
+}
+long long Compensator::computeCell(const Vector &pos, int dx, int dy, int dz) const{
+    // 21 bits per axis; far away cells are clamped together, which only adds candidates
+    const long long half = 1LL<<20;
+    long long c[3];
+    int d[3] = {dx, dy, dz};
+    for(int k=0; k<3; k++){
+        double f = floor(pos[k]/cellSize);
+        c[k] = f<-half ? -half : (f>half-1 ? half-1 : (long long)f);
+        c[k] += d[k];
+        c[k] = c[k]<-half ? -half : (c[k]>half-1 ? half-1 : c[k]);
+        c[k] += half;
+    }
+    return (c[0]<<42) | (c[1]<<21) | c[2];
+}
+void Compensator::getNeighborsFromGrid(unsigned int taxelId, vector<int> &neighbors) const{
+    neighbors.clear();
+    if(cellXtaxel[taxelId]==NO_CELL)
+        return;
+    const Vector &p = taxelPos[taxelId];
+    double d2 = maxNeighDist*maxNeighDist;
+
+    // the 27 cells around the taxel (duplicates may arise from clamping)
+    long long cells[27];
+    int nc = 0;
+    for(int dx=-1; dx<=1; dx++)
+        for(int dy=-1; dy<=1; dy++)
+            for(int dz=-1; dz<=1; dz++)
+                cells[nc++] = computeCell(p, dx, dy, dz);
+    sort(cells, cells+nc);
+    nc = unique(cells, cells+nc) - cells;
+
+    for(int c=0; c<nc; c++){
+        vector< pair<long long,int> >::const_iterator it = lower_bound(taxelCells.begin(), taxelCells.end(), make_pair(cells[c], -1));
+        for(; it!=taxelCells.end() && it->first==cells[c]; it++){
+            if(it->second==(int)taxelId)
+                continue;
+            const Vector &q = taxelPos[it->second];
+            double dx=p[0]-q[0], dy=p[1]-q[1], dz=p[2]-q[2];
+            if(dx*dx+dy*dy+dz*dz <= d2)
+                neighbors.push_back(it->second);
+        }
+    }
+    sort(neighbors.begin(), neighbors.end());
+}
+void Compensator::buildNeighbors(int *minNeighbors, int *maxNeighbors){
+    // the ids are collected in a new array, so that its capacity
+    // matches the actual number of neighbors
+    vector<int> offsets(skinDim+1), ids;
+    vector<int> neighbors;
+    int minN=skinDim, maxN=0, ns;
     for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        ns = neighborsXtaxel[i].size();
-        if(ns>maxNeighbors) maxNeighbors = ns;
-        if(ns<minNeighbors) minNeighbors = ns;
+        offsets[i] = ids.size();
+        getNeighborsFromGrid(i, neighbors);
+        ids.insert(ids.end(), neighbors.begin(), neighbors.end());
+        ns = neighbors.size();
+        if(ns>maxN) maxN = ns;
+        if(ns<minN) minN = ns;
     }
+    offsets[skinDim] = ids.size();
+
+    neighOffsets.swap(offsets);
+    vector<int>(ids.begin(), ids.end()).swap(neighIds);
+    neighborsAll = false;
+    neighborsDirty = false;
+
+    if(minNeighbors) *minNeighbors = minN;
+    if(maxNeighbors) *maxNeighbors = maxN;
+}
+void Compensator::computeNeighbors(){
+    double t0 = Time::now();
+    buildGrid();
+    int minNeighbors, maxNeighbors;
+    buildNeighbors(&minNeighbors, &maxNeighbors);
+
     stringstream ss;
-    ss<<"Neighbors computed. Min neighbors: "<<minNeighbors<<"; max neighbors: "<<maxNeighbors;
+    ss<<"Neighbors computed in "<<1e3*(Time::now()-t0)<<" ms. Min neighbors: "<<minNeighbors<<"; max neighbors: "<<maxNeighbors;
     sendInfoMsg(ss.str());
 }
 void Compensator::updateNeighbors(unsigned int taxelId){
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    // remove all the neighbors of the taxel with id=taxelId
-    neighborsXtaxel[taxelId].clear();
+    // move the taxel to its new cell; the neighbor lists are rebuilt only
+    // once they are needed, so that a batch of single taxel updates costs
+    // a single rebuild
+    long long cell = NO_CELL;
+    if(isFinitePosition(taxelPos[taxelId]))
+        cell = computeCell(taxelPos[taxelId]);
+    else{
+        stringstream ss;
+        ss<<"WARNING: taxel "<<taxelId<<" has a non-finite position and will have no neighbors";
+        sendInfoMsg(ss.str());
+    }
 
-    for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        // remove taxelId from the neighbor list (if there is)
-        neighborsXtaxel[i].remove(taxelId);
-        // check whether they are neighbors
-        v = taxelPos[i]-taxelPos[taxelId];
-        if( dot(v,v) <= d2){
-            neighborsXtaxel[i].push_back(taxelId);
-            neighborsXtaxel[taxelId].push_back(i);
-        }
+    if(cell!=cellXtaxel[taxelId]){
+        if(cellXtaxel[taxelId]!=NO_CELL)
+            taxelCells.erase(lower_bound(taxelCells.begin(), taxelCells.end(), make_pair(cellXtaxel[taxelId], (int)taxelId)));
+        if(cell!=NO_CELL)
+            taxelCells.insert(lower_bound(taxelCells.begin(), taxelCells.end(), make_pair(cell, (int)taxelId)), make_pair(cell, (int)taxelId));
+        cellXtaxel[taxelId] = cell;
     }
+    neighborsDirty = true;
 }
 
 void Compensator::sendInfoMsg(string msg){
     yInfo("[%s]: %s", getInputPortName().c_str(), msg.c_str());
+    // the info port is shared among the compensators, which may run on different threads
+    infoPortSem.wait();
     Bottle& b = infoPort->prepare();
     b.clear();
     b.addString(getInputPortName().c_str());
     b.addString((": " + msg).c_str());
     infoPort->write(true);
+    infoPortSem.post();
 }
@@ -40,6 +40,7 @@
 #include <iostream>
 #include <iomanip>
 #include <deque>
+#include <vector>
 
 #include <cv.h>
 #include <highgui.h>
@@ -52,6 +53,7 @@
 #define NH 10
 #define NS 10
 #define NV 10
+#define NBINS (NH*NS + NV)
 /* low thresholds on saturation and value for histogramming */
 #define S_THRESH 0.1
 #define V_THRESH 0.2
@@ -69,6 +71,8 @@
 #define pfot_B0  1.0000f
 /* distribution parameter */
 #define LAMBDA 10
+/* default number of threads evaluating the particles */
+#define PARTICLE_WORKERS 2
 
 /* templates list parameters */
 #define TEMP_LIST_SIZE                  10
@@ -84,13 +88,31 @@ typedef struct TemplateStruct
 
 int particle_cmp( const void* p1, const void* p2 );
 
+class PARTICLEThread;
+
+class PARTICLEWorker : public yarp::os::Thread
+{
+private:
+    PARTICLEThread      *owner;
+    yarp::os::Semaphore job;
+    yarp::os::Semaphore &done;
+    int first, last;
+
+public:
+    PARTICLEWorker(PARTICLEThread *owner, yarp::os::Semaphore &done);
+
+    void evaluate(int first, int last);
+    void run();
+    void onStop();
+};
+
 
 class PARTICLEThread : public yarp::os::Thread 
 {
 public:
     typedef struct histogram 
     {
-        float histo[NH*NS + NV];  /* histogram array */
+        float histo[NBINS];       /* histogram array */
         int n;                    /* length of histogram array */
     } histogram;
 
@@ -135,7 +157,6 @@ private:
     IplImage* frame, *frame_blob;
     int width, height, tpl_width, tpl_height, res_width, res_height;
     double scale;
-	IplImage* img_hsv;
 	gsl_rng* rng;
 	bool firstFrame;
   	CvScalar color;
@@ -172,27 +193,40 @@ private:
 	histogram** ref_histos;
 	particle* particles, * new_particles;    
 
+    /* per-frame quantized bins and integral histogram: counters are
+       stored modulo 2^16 and are exact for regions up to 65535 pixels */
+    IplImage* img_hsv8;
+    std::vector<unsigned char>  bins;
+    std::vector<unsigned short> integral;
+    int lut_h[256], lut_s[256], lut_v[256];
+    int v_thresh8;
+
+    /* pool of threads evaluating the particles */
+    int num_workers;
+    std::deque<PARTICLEWorker*> workers;
+    yarp::os::Semaphore workersDone;
+
+    friend class PARTICLEWorker;
+
     void free_histos( histogram** histo, int n );
     void free_regions( CvRect** regions, int n);
 
-    histogram** compute_ref_histos( IplImage* img, CvRect* rect, int n );
-	histogram* calc_histogram( IplImage** imgs, int n );
+    histogram** compute_ref_histos( CvRect* rect, int n );
+    void init_bin_luts();
+    void compute_integral_histogram( IplImage* bgr );
+    bool region_histogram( int x, int y, int w, int h, histogram* histo );
 	particle transition( const particle &p, int w, int h, gsl_rng* rng );
 	particle* init_distribution( CvRect* regions, histogram** histos, int n, int p);
-	IplImage* bgr2hsv( IplImage* bgr );
-	float likelihood( IplImage* img, int r, int c, int w, int h, histogram* ref_histo );
+	float likelihood( int r, int c, int w, int h, histogram* ref_histo );
+    void evaluate_particles( int first, int last );
 	void normalize_weights( particle* particles, int n );
 	float histo_dist_sq( histogram* h1, histogram* h2 );
-	int histo_bin( float h, float s, float v );
-	float pixval32f(IplImage* img, int r, int c);
-	void setpix32f(IplImage* img, int r, int c, float val);
 	int get_regions( IplImage* frame, CvRect** regions );
     int get_regionsImage( IplImage* frame, CvRect** regions );
-	particle* resample( particle* particles, int n );
+	void resample( particle* particles, particle* new_particles, int n );
 	void display_particle( IplImage* img, const particle &p, CvScalar color, yarp::sig::Vector& target );
     void display_particleBlob( IplImage* img, const particle &p, yarp::sig::Vector& target );
     void trace_template( IplImage* img, const particle &p );
-    void normalize_histogram( histogram* histo );
     void initAll();
     void runAll(IplImage *img);
    
@@ -206,6 +240,7 @@ public:
     void threadRelease();
     void run(); 
     void setName(std::string module);
+    void setParams(int particles, int workers);
     void setTemplate(yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl);
     void pushTarget(yarp::sig::Vector &target, yarp::os::Stamp &stamp);
     float getAverage();
@@ -230,6 +265,7 @@ private:
 
     yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl;
     std::string moduleName;
+    int numParticles, numWorkers;
     
 
 public:
@@ -238,6 +274,7 @@ public:
     bool            shouldSend;
 
     void setName(std::string module);
+    void setParams(int particles, int workers);
     bool threadInit();     
     void threadRelease();
     void run(); 
@@ -48,6 +48,12 @@ The following key-value pairs can be specified as parameters in the configuratio
 (they can also be specified as command-line parameters if you so wish). 
 The value part can be changed to suit your needs; the default values are shown below. 
   
+- \c particles \c 1000 \n    
+  specifies the number of particles used by each camera
+
+- \c workers \c 2 \n    
+  specifies the number of threads evaluating the particles of each camera
+
 - \c inputPortNameTemp \c /templatePFTracker/template/image:i \n    
   specifies the input port name (this string will be prefixed by \c /templatePFTracker 
   or whatever else is specifed by the name parameter
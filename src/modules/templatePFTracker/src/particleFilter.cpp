@@ -38,6 +38,37 @@ int particle_cmp( const void* p1, const void* p2 )
     return 0;
 }
 /**********************************************************/
+PARTICLEWorker::PARTICLEWorker(PARTICLEThread *owner, Semaphore &done) :
+                               owner(owner), job(0), done(done)
+{
+    first = last = 0;
+}
+/**********************************************************/
+void PARTICLEWorker::evaluate(int first, int last)
+{
+    this->first = first;
+    this->last = last;
+    job.post();
+}
+/**********************************************************/
+void PARTICLEWorker::run()
+{
+    while (true)
+    {
+        job.wait();
+        if (isStopping())
+            break;
+
+        owner->evaluate_particles(first, last);
+        done.post();
+    }
+}
+/**********************************************************/
+void PARTICLEWorker::onStop()
+{
+    job.post();
+}
+/**********************************************************/
 
 PARTICLEThread::~PARTICLEThread() 
 {
@@ -49,6 +80,10 @@ PARTICLEThread::~PARTICLEThread()
     free_histos ( ref_histos, num_objects);  
     if(particles != NULL)
         free ( particles);
+    if(new_particles != NULL)
+        free ( new_particles);
+    if(img_hsv8 != NULL)
+        cvReleaseImage(&img_hsv8);
 
     if (temp)
     {
@@ -58,7 +93,7 @@ PARTICLEThread::~PARTICLEThread()
     cout << "finished particle thread" << endl;
 }
 /**********************************************************/
-PARTICLEThread::PARTICLEThread() 
+PARTICLEThread::PARTICLEThread() : workersDone(0)
 {
     firstFrame = true;
     num_objects = 0;
@@ -77,6 +112,9 @@ PARTICLEThread::PARTICLEThread()
     ref_histos = NULL;
     tpl = NULL;
     total = 0;
+    img_hsv8 = NULL;
+    num_workers = PARTICLE_WORKERS;
+    init_bin_luts();
 }
 /**********************************************************/
 void PARTICLEThread::setName(string module) 
@@ -84,6 +122,13 @@ void PARTICLEThread::setName(string module)
     this->moduleName = module;
 }
 
+/**********************************************************/
+void PARTICLEThread::setParams(int particles, int workers) 
+{
+    num_particles = MAX( 1, particles );
+    num_workers = MAX( 1, workers );
+}
+
 /**********************************************************/
 bool PARTICLEThread::threadInit() 
 {
@@ -104,6 +149,13 @@ bool PARTICLEThread::threadInit()
     updateNeeded=false;
     bestTempl.templ=NULL;
     bestTempl.w=0.0;
+
+    // the calling thread evaluates a slice of particles as well
+    for (int t = 1; t < num_workers; t++)
+    {
+        workers.push_back(new PARTICLEWorker(this, workersDone));
+        workers.back()->start();
+    }
     return true;
 }
 /**********************************************************/
@@ -203,6 +255,13 @@ void PARTICLEThread::threadRelease()
     imageOut.close();
     imageOutBlob.close();
 
+    while(workers.size())
+    {
+        workers.back()->stop();
+        delete workers.back();
+        workers.pop_back();
+    }
+
     templateMutex.wait();
     while(tempList.size())
     {
@@ -228,7 +287,7 @@ void PARTICLEThread::initAll()
 /**********************************************************/
 void PARTICLEThread::runAll(IplImage *img)
 {
-    img_hsv = bgr2hsv( img );
+    compute_integral_histogram( img );
     if (firstFrame)
     {
         w = img->width;
@@ -243,30 +302,40 @@ void PARTICLEThread::runAll(IplImage *img)
         if (ref_histos!=NULL)
             free_histos ( ref_histos, num_objects);        
 
-        ref_histos = compute_ref_histos( img_hsv, *regions, num_objects );
+        ref_histos = compute_ref_histos( *regions, num_objects );
         if (particles != NULL)
             free (particles);
 
         particles= init_distribution( *regions, ref_histos, num_objects, num_particles );
+
+        // resampling swaps between two preallocated sets
+        if (new_particles == NULL)
+            new_particles = (particle* ) malloc( num_particles * sizeof( particle ) );
     }
     else
     {
-        // perform prediction and measurement for each particle
+        // perform prediction for each particle; this is kept
+        // sequential as the sampling relies on a single rng
         for( j = 0; j < num_particles; j++ ) 
-        {
             particles[j] = transition( particles[j], w, h, rng );
-            s = particles[j].s;
-            particles[j].w = likelihood( img_hsv, cvRound(particles[j].y),
-            cvRound( particles[j].x ),
-            cvRound( particles[j].width * s ),
-            cvRound( particles[j].height * s ),
-            particles[j].histo );
-        }
+
+        // perform measurement: the workers evaluate one slice each
+        // while the last slice is left to this thread
+        int slice = num_particles / (int)(workers.size() + 1);
+        for( size_t t = 0; t < workers.size(); t++ )
+            workers[t]->evaluate( (int)t * slice, (int)(t + 1) * slice );
+
+        evaluate_particles( (int)workers.size() * slice, num_particles );
+
+        for( size_t t = 0; t < workers.size(); t++ )
+            workersDone.wait();
+
         // normalize weights and resample a set of unweighted particles
         normalize_weights( particles, num_particles );
-        new_particles = resample( particles, num_particles );
-        free( particles );
+        resample( particles, new_particles, num_particles );
+        particle* tmp = particles;
         particles = new_particles;
+        new_particles = tmp;
     }
     qsort( particles, num_particles, sizeof( PARTICLEThread::particle ), &particle_cmp );
 
@@ -288,8 +357,19 @@ void PARTICLEThread::runAll(IplImage *img)
         display_particleBlob( frame_blob, particles[0], targetTemp );
     targetMutex.post();
     trace_template( frame, particles[0] );
-
-    cvReleaseImage(&img_hsv);
+}
+/**********************************************************/
+void PARTICLEThread::evaluate_particles( int first, int last )
+{
+    for( int n = first; n < last; n++ )
+    {
+        float sc = particles[n].s;
+        particles[n].w = likelihood( cvRound( particles[n].y ),
+                                     cvRound( particles[n].x ),
+                                     cvRound( particles[n].width * sc ),
+                                     cvRound( particles[n].height * sc ),
+                                     particles[n].histo );
+    }
 }
 /**********************************************************/
 void PARTICLEThread::setTemplate(ImageOf<PixelRgb> *_tpl)
@@ -350,108 +430,141 @@ int PARTICLEThread::get_regionsImage( IplImage* frame, CvRect** regions )
     return p.n;
 }
 /**********************************************************/
-PARTICLEThread::histogram** PARTICLEThread::compute_ref_histos( IplImage* frame, CvRect* regions, int n )
+PARTICLEThread::histogram** PARTICLEThread::compute_ref_histos( CvRect* regions, int n )
 {
     histogram** histos = (histogram**) malloc( n * sizeof( histogram* ) );
-    IplImage* tmp;
     int i;
 
-    // extract each region from frame and compute its histogram 
+    // compute the normalized histogram of each region
     for( i = 0; i < n; i++ )
     {
-        cvSetImageROI( frame, regions[i]);
-        tmp = cvCreateImage( cvGetSize(frame), IPL_DEPTH_32F, 3 );
-        cvCopy( frame, tmp, NULL );
-        cvResetImageROI( frame );
-        histos[i] = calc_histogram( &tmp, 1 );
-        normalize_histogram( histos[i] );
-        cvReleaseImage( &tmp );
+        histos[i] = (histogram*) malloc( sizeof(histogram) );
+        if( !region_histogram( regions[i].x, regions[i].y,
+                               regions[i].width, regions[i].height, histos[i] ) )
+            memset( histos[i]->histo, 0, NBINS * sizeof(float) );
     }
     return histos;
 }
 /**********************************************************/
-PARTICLEThread::histogram* PARTICLEThread::calc_histogram( IplImage** imgs, int n ) 
+void PARTICLEThread::init_bin_luts()
 {
-    IplImage* img;
-    histogram* histo;
-    IplImage* h, * s, * v;
-    float* hist;
-    int i, r, c, bin;
-    histo = (histogram*) malloc( sizeof(histogram) );
-    histo->n = NH*NS + NV;
-    hist = histo->histo;
-    memset( hist, 0, histo->n * sizeof(float) );
-    for( i = 0; i < n; i++ )
+    // bins of the 8-bit HSV space: H in [0,180), S and V in [0,255]
+    v_thresh8 = 0;
+    for( int n = 0; n < 256; n++ )
     {
-        // extract individual HSV planes from image 
-        img = imgs[i];
-        h = cvCreateImage( cvGetSize(img), IPL_DEPTH_32F, 1 );
-        s = cvCreateImage( cvGetSize(img), IPL_DEPTH_32F, 1 );
-        v = cvCreateImage( cvGetSize(img), IPL_DEPTH_32F, 1 );
-        cvSplit( img, h, s, v, NULL );
-
-        // increment appropriate histogram bin for each pixel 
-        for( r = 0; r < img->height; r++ )
-            for( c = 0; c < img->width; c++ )
-            {
-                bin = histo_bin( pixval32f( h, r, c ),
-                pixval32f( s, r, c ),
-                pixval32f( v, r, c ) );
-                hist[bin] += 1;
-            }
-        cvReleaseImage( &h );
-        cvReleaseImage( &s );
-        cvReleaseImage( &v );
+        float sv = (float)n / 255.0f;
+        lut_h[n] = MIN( (int)(2.0f * n * NH / H_MAX), NH-1 );
+        lut_s[n] = ( sv < S_THRESH ) ? -1 : MIN( (int)(sv * NS / S_MAX), NS-1 );
+        lut_v[n] = MIN( (int)(sv * NV / V_MAX), NV-1 );
+        if( sv < V_THRESH )
+            v_thresh8 = n + 1;
     }
-    return histo;
 }
 /**********************************************************/
-void PARTICLEThread::free_histos( PARTICLEThread::histogram** histo, int n) 
+void PARTICLEThread::compute_integral_histogram( IplImage* bgr )
 {
-    for (int i = 0; i < n; i++)    
-        free (histo[i]);
+    int W = bgr->width;
+    int H = bgr->height;
+    int iw = W + 1;
 
-    free(histo);
+    if( img_hsv8 == NULL || img_hsv8->width != W || img_hsv8->height != H )
+    {
+        if( img_hsv8 != NULL )
+            cvReleaseImage( &img_hsv8 );
+        img_hsv8 = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_8U, 3 );
+        bins.resize( W * H );
+        integral.resize( iw * (H + 1) * NBINS );
+    }
+    cvCvtColor( bgr, img_hsv8, CV_BGR2HSV );
+
+    // quantize each pixel and accumulate the integral histogram
+    // row by row; the first row and column are kept to zero
+    unsigned short rowHist[NBINS];
+    memset( &integral[0], 0, iw * NBINS * sizeof(unsigned short) );
+    for( int r = 0; r < H; r++ )
+    {
+        const uchar* hsv = (const uchar*)(img_hsv8->imageData + img_hsv8->widthStep*r);
+        unsigned char* b = &bins[r * W];
+        const unsigned short* prev = &integral[r * iw * NBINS];
+        unsigned short* cur = &integral[(r + 1) * iw * NBINS];
+
+        memset( rowHist, 0, sizeof(rowHist) );
+        memset( cur, 0, NBINS * sizeof(unsigned short) );
+        for( int c = 0; c < W; c++, hsv += 3 )
+        {
+            int sd = lut_s[hsv[1]];
+            if( sd < 0 || hsv[2] < v_thresh8 )
+                b[c] = (unsigned char)(NH * NS + lut_v[hsv[2]]);
+            else
+                b[c] = (unsigned char)(sd * NH + lut_h[hsv[0]]);
+            rowHist[b[c]]++;
+
+            prev += NBINS;
+            cur += NBINS;
+            for( int k = 0; k < NBINS; k++ )
+                cur[k] = (unsigned short)(prev[k] + rowHist[k]);
+        }
+    }
 }
 /**********************************************************/
-void PARTICLEThread::free_regions( CvRect** regions, int n) 
+bool PARTICLEThread::region_histogram( int x, int y, int w, int h, histogram* histo )
 {
-    for (int i = 0; i < n; i++)    
-        free (regions[i]);
+    int W = img_hsv8->width;
+    int H = img_hsv8->height;
+    int iw = W + 1;
 
-   free(regions);
+    // clip the region to the image as the ROI did
+    int x0 = MAX( x, 0 ), y0 = MAX( y, 0 );
+    int x1 = MIN( x + w, W ), y1 = MIN( y + h, H );
+
+    histo->n = NBINS;
+    if( x1 <= x0 || y1 <= y0 )
+        return false;
+
+    int area = ( x1 - x0 ) * ( y1 - y0 );
+    float inv_area = 1.0f / area;
+    float* hist = histo->histo;
+
+    if( area < 65536 )
+    {
+        // the wrap-around of the counters cancels out in the difference
+        const unsigned short* a = &integral[( y0 * iw + x0 ) * NBINS];
+        const unsigned short* b = &integral[( y0 * iw + x1 ) * NBINS];
+        const unsigned short* c = &integral[( y1 * iw + x0 ) * NBINS];
+        const unsigned short* d = &integral[( y1 * iw + x1 ) * NBINS];
+        for( int k = 0; k < NBINS; k++ )
+            hist[k] = (unsigned short)( d[k] - b[k] - c[k] + a[k] ) * inv_area;
+    }
+    else
+    {
+        // counters are not exact anymore, scan the bins
+        memset( hist, 0, NBINS * sizeof(float) );
+        for( int r = y0; r < y1; r++ )
+        {
+            const unsigned char* bn = &bins[r * W];
+            for( int c = x0; c < x1; c++ )
+                hist[bn[c]] += 1.0f;
+        }
+        for( int k = 0; k < NBINS; k++ )
+            hist[k] *= inv_area;
+    }
+    return true;
 }
 /**********************************************************/
-void PARTICLEThread::normalize_histogram( PARTICLEThread::histogram* histo ) 
+void PARTICLEThread::free_histos( PARTICLEThread::histogram** histo, int n) 
 {
-    float* hist;
-    float sum = 0, inv_sum;
-    int i, n;
-
-    hist = histo->histo;
-    n = histo->n;
+    for (int i = 0; i < n; i++)    
+        free (histo[i]);
 
-    // compute sum of all bins and multiply each bin by the sum's inverse 
-    for( i = 0; i < n; i++ )
-        sum += hist[i];
-    inv_sum = 1.0f / sum;
-    for( i = 0; i < n; i++ )
-        hist[i] *= inv_sum;
+    free(histo);
 }
 /**********************************************************/
-int PARTICLEThread::histo_bin( float h, float s, float v )
+void PARTICLEThread::free_regions( CvRect** regions, int n) 
 {
-    int hd, sd, vd;
-
-    // if S or V is less than its threshold, return a "colorless" bin 
-    vd = MIN( (int)(v * NV / V_MAX), NV-1 );
-    if( s < S_THRESH  ||  v < V_THRESH )
-        return NH * NS + vd;
+    for (int i = 0; i < n; i++)    
+        free (regions[i]);
 
-    // otherwise determine "colorful" bin 
-    hd = MIN( (int)(h * NH / H_MAX), NH-1 );
-    sd = MIN( (int)(s * NS / S_MAX), NS-1 );
-    return sd * NH + hd;
+   free(regions);
 }
 /**********************************************************/
 PARTICLEThread::particle* PARTICLEThread::init_distribution( CvRect* regions, histogram** histos, int n, int p) 
@@ -530,24 +643,17 @@ PARTICLEThread::particle PARTICLEThread::transition( const PARTICLEThread::parti
     return pn;
 }
 /**********************************************************/
-float PARTICLEThread::likelihood( IplImage* img, int r, int c, int w, int h, histogram* ref_histo ) 
+float PARTICLEThread::likelihood( int r, int c, int w, int h, histogram* ref_histo ) 
 {
-    IplImage* tmp;
-    histogram* histo;
+    histogram histo;
     float d_sq;
 
-    // extract region around (r,c) and compute and normalize its histogram 
-    cvSetImageROI( img, cvRect( c - w / 2, r - h / 2, w, h ) );
-    tmp = cvCreateImage( cvGetSize(img), IPL_DEPTH_32F, 3 );
-    cvCopy( img, tmp, NULL );
-    cvResetImageROI( img );
-    histo = calc_histogram( &tmp, 1 );
-    cvReleaseImage( &tmp );
-    normalize_histogram( histo );
+    // histogram of the region around (r,c) out of the integral histogram 
+    if( !region_histogram( c - w / 2, r - h / 2, w, h, &histo ) )
+        return exp( -LAMBDA * 1.0f );
 
     // compute likelihood as e^{\lambda D^2(h, h^*)} 
-    d_sq = histo_dist_sq( histo, ref_histo );
-    free( histo );
+    d_sq = histo_dist_sq( &histo, ref_histo );
     return exp( -LAMBDA * d_sq );
 }
 /**********************************************************/
@@ -587,14 +693,11 @@ void PARTICLEThread::normalize_weights( particle* particles, int n )
         particles[i].w /= sum;
 }
 /**********************************************************/
-PARTICLEThread::particle* PARTICLEThread::resample( particle* particles, int n ) 
+void PARTICLEThread::resample( particle* particles, particle* _new_particles, int n ) 
 {
-    particle* _new_particles;
     int i, j, np, k = 0;
 
-    //new_particles = (particle* )malloc( sizeof( particle ) );
     qsort( particles, n, sizeof( particle ), &particle_cmp );
-    _new_particles = (particle* ) malloc( n * sizeof( particle ) );
 
     for( i = 0; i < n; i++ ) 
     {
@@ -610,7 +713,7 @@ PARTICLEThread::particle* PARTICLEThread::resample( particle* particles, int n )
         _new_particles[k++] = particles[0];
 
     exit:
-    return _new_particles;
+    return;
 }
 /**********************************************************/
 void PARTICLEThread::display_particle( IplImage* img, const PARTICLEThread::particle &p, CvScalar color, Vector& target ) 
@@ -714,23 +817,6 @@ void PARTICLEThread::trace_template( IplImage* img, const particle &p )
     templateMutex.post();
 }
 /**********************************************************/
-float PARTICLEThread::pixval32f(IplImage* img, int r, int c) 
-{
-    return ( (float*)(img->imageData + img->widthStep*r) )[c];
-}
-/**********************************************************/
-IplImage* PARTICLEThread::bgr2hsv( IplImage* bgr ) 
-{
-    IplImage* bgr32f, * hsv;
-
-    bgr32f = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
-    hsv = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
-    cvConvertScale( bgr, bgr32f, 1.0 / 255.0, 0 );
-    cvCvtColor( bgr32f, hsv, CV_BGR2HSV );
-    cvReleaseImage( &bgr32f );
-    return hsv;
-}
-/**********************************************************/
 TemplateStruct PARTICLEThread::getBestTemplate()
 {
     TemplateStruct best;
@@ -751,6 +837,8 @@ TemplateStruct PARTICLEThread::getBestTemplate()
 PARTICLEManager::PARTICLEManager() : RateThread(20) 
 {
     tpl = NULL;
+    numParticles = PARTICLES;
+    numWorkers = PARTICLE_WORKERS;
 }
 /**********************************************************/
 PARTICLEManager::~PARTICLEManager() { }
@@ -760,6 +848,12 @@ void PARTICLEManager::setName(string module)
     this->moduleName = module;
 }
 /**********************************************************/
+void PARTICLEManager::setParams(int particles, int workers) 
+{
+    numParticles = particles;
+    numWorkers = workers;
+}
+/**********************************************************/
 bool PARTICLEManager::threadInit() 
 {
     //create all ports
@@ -778,6 +872,9 @@ bool PARTICLEManager::threadInit()
     particleThreadLeft->setName((moduleName + "/left").c_str());
     particleThreadRight->setName((moduleName + "/right").c_str());
 
+    particleThreadLeft->setParams(numParticles, numWorkers);
+    particleThreadRight->setParams(numParticles, numWorkers);
+
     shouldSend = false;
     particleThreadLeft->start();
     particleThreadRight->start();
@@ -909,6 +1006,10 @@ bool PARTICLEModule::configure(yarp::os::ResourceFinder &rf)
 
     /*pass the name of the module in order to create ports*/
     particleManager->setName(moduleName);    
+    particleManager->setParams(rf.check("particles", Value(PARTICLES),
+                                        "number of particles (int)").asInt(),
+                               rf.check("workers", Value(PARTICLE_WORKERS),
+                                        "threads evaluating the particles of each camera (int)").asInt());
     /* now start the thread to do the work */
     particleManager->start();
     
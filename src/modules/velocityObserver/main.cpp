@@ -100,6 +100,12 @@ algorithm and a simple moving average filter:
 --thrAcc \e D 
 - The same as above but for the second derivative's estimation.
  
+--bench-samples \e M 
+- Run off-line a benchmark of the estimate() latency on \e M 
+  samples of 32 channels, for a linear estimator with N=16 and a
+  quadratic estimator with N=25, with and without the
+  incremental fitting, then quit. No YARP server is required.
+ 
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -155,6 +161,8 @@ yarp connect /icub/right_arm/state:o /jointVel/pos:i
 \author Ugo Pattacini
 */ 
 
+#include <cmath>
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -320,6 +328,58 @@ public:
 
 
 
+int runBenchmark(ResourceFinder &rf)
+{
+    int nSamples=std::max(rf.find("bench-samples").asInt(),1);
+    const int nChannels=32;
+    const double Ts=0.01;
+    const double twoPi=2.0*acos(-1.0);
+
+    AWPolyEstimator *est[2][2];
+    est[0][0]=new AWLinEstimator(16,1.0);
+    est[0][1]=new AWLinEstimator(16,1.0);
+    est[1][0]=new AWQuadEstimator(25,1.0);
+    est[1][1]=new AWQuadEstimator(25,1.0);
+    const char *names[]={"AWLinEstimator(16)","AWQuadEstimator(25)"};
+
+    yInfo()<<"benchmarking estimate() on "<<nSamples<<" samples of "<<nChannels<<" channels ...";
+    for (int e=0; e<2; e++)
+    {
+        est[e][1]->setIncrementalFit(true);
+
+        double t[2]={0.0,0.0};
+        double err=0.0;
+        Vector x(nChannels);
+        for (int k=0; k<nSamples; k++)
+        {
+            for (int i=0; i<nChannels; i++)
+                x[i]=10.0*sin(twoPi*(0.2+0.05*i)*k*Ts+i);
+
+            AWPolyElement el(x,k*Ts);
+            Vector y[2];
+            for (int m=0; m<2; m++)
+            {
+                double t0=Time::now();
+                y[m]=est[e][m]->estimate(el);
+                t[m]+=Time::now()-t0;
+            }
+
+            for (int i=0; i<nChannels; i++)
+                err=std::max(err,fabs(y[0][i]-y[1][i]));
+        }
+
+        yInfo()<<names[e]<<": "<<1e6*t[0]/nSamples<<" [us/sample] standard; "
+               <<1e6*t[1]/nSamples<<" [us/sample] incremental; max deviation "<<err;
+
+        delete est[e][0];
+        delete est[e][1];
+    }
+
+    return 0;
+}
+
+
+
 int main(int argc, char *argv[])
 {
     Network yarp;
@@ -336,10 +396,14 @@ int main(int argc, char *argv[])
         cout<<"\t--thrVel    D: velocity max deviation threshold (default: 1.0)"     << endl;
         cout<<"\t--lenAcc    N: acceleration window's max length (default: 25)"      << endl;
         cout<<"\t--thrAcc    D: acceleration max deviation threshold (default: 1.0)" << endl;
+        cout<<"\t--bench-samples M: run the estimate() benchmark on M samples and quit"<< endl;
         cout<<endl;
 
         return 0;
     }
+
+    if (rf.check("bench-samples"))
+        return runBenchmark(rf);
     
     if (!yarp.checkNetwork())
     {
@@ -64,6 +64,11 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs   
 - this option disables the dynamics computation for the legs joints
 
+--bench-calls \e N 
+- Run off-line a benchmark of \e N Newton-Euler computations on
+  the iCub arm and leg with the standard and the fast backends, 
+  then quit. No YARP server is required.
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -114,6 +119,9 @@ This file can be edited at src/wholeBodyDynamics/main.cpp.
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
 
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <string.h>
@@ -744,6 +752,74 @@ public:
 };
 
 
+/************************************************************************/
+int runBenchmark(ResourceFinder &rf)
+{
+    int nCalls=std::max(rf.find("bench-calls").asInt(),1);
+
+    iCubArmDyn arm("right");
+    iCubLegDyn leg("right");
+    iDynLimb *limbs[]={&arm,&leg};
+    const char *names[]={"iCubArmDyn","iCubLegDyn"};
+    const char *backends[]={"standard","fast"};
+
+    Vector w0(3,0.0),dw0(3,0.0),ddp0(3,0.0),Fend(3,0.0),Muend(3,0.0);
+    ddp0[2]=9.81;
+
+    yInfo("benchmarking %d Newton-Euler computations per backend ...",nCalls);
+    bool ok=true;
+    srand(0);
+    for (int l=0; l<2; l++)
+    {
+        iDynLimb &limb=*limbs[l];
+        Vector q(limb.getDOF()),dq(limb.getDOF()),ddq(limb.getDOF());
+        for (size_t i=0; i<q.length(); i++)
+        {
+            q[i]=0.2*(rand()/(double)RAND_MAX-0.5);
+            dq[i]=rand()/(double)RAND_MAX-0.5;
+            ddq[i]=rand()/(double)RAND_MAX-0.5;
+        }
+        limb.setAng(q);
+        limb.setDAng(dq);
+        limb.setD2Ang(ddq);
+        limb.prepareNewtonEuler(DYNAMIC);
+
+        Matrix F[2],Mu[2];
+        for (int b=0; b<2; b++)
+        {
+            limb.setBackendNewtonEuler(b>0?NE_FAST:NE_STANDARD);
+
+            double t0=Time::now();
+            for (int i=0; i<nCalls; i++)
+                limb.computeNewtonEuler(w0,dw0,ddp0,Fend,Muend);
+            double t=Time::now()-t0;
+
+            F[b]=limb.getForces();
+            Mu[b]=limb.getMoments();
+            yInfo("%s %s: %g [us/call]",names[l],backends[b],1e6*t/nCalls);
+        }
+
+        double err=0.0;
+        for (int r=0; r<F[0].rows(); r++)
+        {
+            for (int c=0; c<F[0].cols(); c++)
+            {
+                err=std::max(err,fabs(F[0](r,c)-F[1](r,c)));
+                err=std::max(err,fabs(Mu[0](r,c)-Mu[1](r,c)));
+            }
+        }
+
+        if (err>1e-9)
+        {
+            yError("%s: the two backends differ by %g",names[l],err);
+            ok=false;
+        }
+    }
+
+    return (ok?0:1);
+}
+
+
 int main(int argc, char * argv[])
 {
     ResourceFinder rf;
@@ -771,9 +847,13 @@ int main(int argc, char * argv[])
         cout << "\t--dumpvel         dumps joint velocities and accelerations (debug use only)"                                  << endl;
         cout << "\t--experimental_com_vel  enables com velocity computation (experimental)"                                      << endl;
         cout << "\t--auto_drift_comp  enables automatic drift compensation  (experimental, under debug)"                         << endl;
+        cout << "\t--bench-calls N    runs off-line N Newton-Euler computations with each backend and quits"                  << endl;
         return 0;
     }
 
+    if (rf.check("bench-calls"))
+        return runBenchmark(rf);
+
     Network yarp;
 
     if (!yarp.checkNetwork())
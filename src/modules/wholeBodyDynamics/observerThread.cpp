@@ -446,6 +446,11 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     linEstLow =new AWLinEstimator(16,1.0);
     quadEstLow=new AWQuadEstimator(25,1.0);
     InertialEst = new AWLinEstimator(16,1.0);
+    linEstUp->setIncrementalFit(true);
+    quadEstUp->setIncrementalFit(true);
+    linEstLow->setIncrementalFit(true);
+    quadEstLow->setIncrementalFit(true);
+    InertialEst->setIncrementalFit(true);
 
     //-----------parts INIT VARIABLES----------------//
     init_upper();
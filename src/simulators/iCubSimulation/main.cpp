@@ -73,6 +73,26 @@
  *  torso_covers on
  *  left_arm_covers on
  *  right_arm_covers on
+ *
+ * The following command line options run the simulator without a window:
+ *
+ * --headless : step the world from the module thread, with no SDL window
+ *              and no camera images
+ *
+ * --speed k : run at k times real time (default 0, as fast as possible)
+ *
+ * --steps n : stop after n simulation steps (default 0, run until Ctrl-c)
+ *
+ * --seed s : seed for ODE and the C random generator (default 0); runs with
+ *            the same seed and the same commands give the same trajectory
+ *
+ * --clock name : port publishing the simulated time (default /clock); start
+ *                the other modules with YARP_CLOCK=name to follow it; the
+ *                encoders, touch, skin and inertial data are stamped with
+ *                the same simulated time
+ *
+ * On exit the number of steps per second achieved is printed, which
+ * is a convenient benchmark of the physics alone.
  * 
  * 
  * \section portsa_sec Ports Accessed
@@ -127,6 +147,7 @@
  * - /icubSim/touch : streams out a sequence the touch sensors for both hands
  * - /icubSim/inertial : streams out a sequence of inertial data taken from the head
  * - /icubSim/texture : port to receive texture data to place on an object (e.g. data from a webcam etc...)
+ * - /clock : simulated time as (seconds nanoseconds), in headless mode only
  *
  * \section in_files_sec Input Data Files
  * iCubSimulator expects the following configuration files:
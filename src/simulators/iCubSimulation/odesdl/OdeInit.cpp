@@ -51,6 +51,45 @@ OdeInit::OdeInit(RobotConfig *config) : mutex(1), robot_config(config)
     contactFrictionCoefficient = config->getContactFrictionCoefficient(); //unlike the other ODE params fron .ini file that are used to intiialize the properties of the simulation (dWorldSet...),
     //This parameter is employed on the run as contact joints are created (in OdeSdlSimulation::nearCallback() )
 
+    OdeParams odeParameters = config->getOdeParameters();
+    // dWorldQuickStep is an iterative solver: O(m*N) instead of O(m^3) in the number of constraints,
+    // less accurate but much faster when there are many contacts
+    quickStep = odeParameters.quickStep;
+    if (quickStep) {
+        dWorldSetQuickStepNumIterations(world, odeParameters.quickStepIterations);
+        dWorldSetQuickStepW(world, odeParameters.quickStepSOR);
+        yInfo("ODE solver: dWorldQuickStep, %d iterations, SOR %g\n",
+              odeParameters.quickStepIterations, odeParameters.quickStepSOR);
+    }
+    else {
+        yInfo("ODE solver: dWorldStep\n");
+    }
+    collisionPairCache = odeParameters.collisionPairCache;
+    timingReport = odeParameters.timingReport;
+
+#ifdef ICUB_SIM_ODE_THREADING
+    // independent islands (e.g. the robot and objects lying apart from it) are stepped in parallel
+    threading = NULL;
+    threadPool = NULL;
+    if (odeParameters.stepThreads > 1) {
+        threading = dThreadingAllocateMultiThreadedImplementation();
+        threadPool = dThreadingAllocateThreadPool(odeParameters.stepThreads, 0, dAllocateFlagBasicData, NULL);
+        if (threading != NULL && threadPool != NULL) {
+            dThreadingThreadPoolServeMultiThreadedImplementation(threadPool, threading);
+            dWorldSetStepThreadingImplementation(world, dThreadingImplementationGetFunctions(threading), threading);
+            dWorldSetStepIslandsProcessingMaxThreadCount(world, odeParameters.stepThreads);
+            yInfo("ODE islands stepped on %d threads\n", odeParameters.stepThreads);
+        }
+        else {
+            yWarning("unable to start the ODE thread pool, stepping islands on a single thread\n");
+        }
+    }
+#else
+    if (odeParameters.stepThreads > 1) {
+        yWarning("this ODE has no threading support, stepping islands on a single thread\n");
+    }
+#endif
+
     ground = dCreatePlane (space,0, 1, 0, 0);
     //feedback = new dJointFeedback;
     //feedback1 = new dJointFeedback;
@@ -107,6 +146,19 @@ OdeInit::~OdeInit()
     delete _wrld;
     delete _iCub;
     delete[] _controls;
+
+#ifdef ICUB_SIM_ODE_THREADING
+    if (threading != NULL) {
+        dThreadingImplementationShutdownProcessing(threading);
+    }
+    if (threadPool != NULL) {
+        dThreadingFreeThreadPool(threadPool);
+    }
+    if (threading != NULL) {
+        dWorldSetStepThreadingImplementation(world, NULL, NULL);
+        dThreadingFreeImplementation(threading);
+    }
+#endif
     
     dGeomDestroy(ground);
     dJointGroupDestroy(contactgroup);
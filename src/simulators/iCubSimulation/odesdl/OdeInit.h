@@ -40,6 +40,8 @@
 #include "RobotConfig.h"
 
 #include <list>
+#include <set>
+#include <utility>
 
 using namespace std;
 using namespace yarp::dev;
@@ -73,6 +75,16 @@ public:
     iCubSimulationControl **_controls;
     double contactFrictionCoefficient; //unlike the other ODE params fron .ini file that are used to intiialize the properties of the simulation (dWorldSet...),
     //This parameter is employed on the run as contact joints are created (in OdeSdlSimulation::nearCallback() )
+    bool quickStep; // dWorldQuickStep instead of the exact dWorldStep
+    bool collisionPairCache;
+    // pairs of iCub geoms found to be connected by a joint or on the self-collision ignore list;
+    // these can never touch, so nearCallback() skips them without looking them up again
+    std::set<std::pair<dGeomID,dGeomID> > ignoredPairs;
+    double timingReport; // period in seconds of the step timing report, 0 for none
+#ifdef ICUB_SIM_ODE_THREADING
+    dThreadingImplementationID threading;
+    dThreadingThreadPoolID threadPool;
+#endif
     //for whole_body_skin_emul
     struct contactOnSkin_t {
         dGeomID body_geom_id;
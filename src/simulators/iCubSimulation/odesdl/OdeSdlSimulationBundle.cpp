@@ -47,6 +47,9 @@ WorldManager *OdeSdlSimulationBundle::createWorldManager(RobotConfig& config) {
 }
 
 Simulation *OdeSdlSimulationBundle::createSimulation(RobotConfig& config) {
+    if (config.getFinder().check("headless")) {
+        return new OdeHeadlessSimulation();
+    }
     return new OdeSdlSimulation();
 }
 
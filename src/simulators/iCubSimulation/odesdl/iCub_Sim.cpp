@@ -21,6 +21,7 @@
 #include "iCub_Sim.h"
 
 #include "OdeInit.h"
+#include "SimulationTime.h"
 #include <yarp/os/Log.h>
 #include <yarp/os/LogStream.h>
 #include <cstdlib>
@@ -127,6 +128,22 @@ static const double EXTRA_MARGIN_FOR_TAXEL_POSITION_M = 0.03; //0.03 //for skin
 //however, with errors in the position, we need an extra margin, so the contact falls onto some taxels
 static const double MORE_EXTRA_MARGIN_FOR_TAXEL_POSITION_M = 0.01; //0.01;
 
+// per-step timing breakdown of ODE_process, reported every odeinit.timingReport seconds
+static double timeCollide = 0.0, timeStep = 0.0, timeControllers = 0.0, timeSensors = 0.0;
+static long timedSteps = 0;
+static double lastTimingReport = 0.0;
+
+static std::pair<dGeomID,dGeomID> collisionPair(dGeomID o1, dGeomID o2) {
+    return (o1<o2) ? std::make_pair(o1,o2) : std::make_pair(o2,o1);
+}
+
+// true for the geoms of the robot itself, which live in the iCub subspaces in the self-collision mode;
+// objects loaded directly into the iCub space may be deleted, so they are not cached
+static bool isICubPartGeom(OdeInit& odeinit, dGeomID geom) {
+    dSpaceID s = dGeomGetSpace(geom);
+    return (s != NULL) && (s != odeinit._iCub->iCub) && (dGeomGetSpace((dGeomID)s) == odeinit._iCub->iCub);
+}
+
 void OdeSdlSimulation::draw() {
     OdeInit& odeinit = OdeInit::get();
     odeinit._iCub->draw();
@@ -336,6 +353,14 @@ void OdeSdlSimulation::nearCallback (void *data, dGeomID o1, dGeomID o2) {
 
     assert(o1);
     assert(o2);
+
+    // pairs of robot links that can never touch are classified once, then skipped here
+    if (odeinit.collisionPairCache && odeinit.verbosity <= 3 && !odeinit.ignoredPairs.empty() &&
+        !dGeomIsSpace(o1) && !dGeomIsSpace(o2)) {
+        if (odeinit.ignoredPairs.count(collisionPair(o1,o2)) > 0) {
+            return;
+        }
+    }
      
     dSpaceID space1,space2;
     dSpaceID superSpace1,superSpace2;
@@ -353,15 +378,17 @@ void OdeSdlSimulation::nearCallback (void *data, dGeomID o1, dGeomID o2) {
     std::map<dGeomID,string>::iterator geom1namesIt;
     std::map<dGeomID,string>::iterator geom2namesIt;
     
-    if (dGeomIsSpace(o1)){
-       space1 = (dSpaceID)o1;
-    } else {
-       space1 = dGeomGetSpace(o1);
-       indentString = indentString + " --- "; //extra indentation level because it is a geom in that space
-    }
-    subLevel1 = dSpaceGetSublevel(space1);
-    for (int i=1;i<=subLevel1;i++){ //start from i=1, for sublevel==0 we don't add any indentation
-      indentString = indentString + " --- ";
+    if (odeinit.verbosity > 3) {
+        if (dGeomIsSpace(o1)){
+           space1 = (dSpaceID)o1;
+        } else {
+           space1 = dGeomGetSpace(o1);
+           indentString = indentString + " --- "; //extra indentation level because it is a geom in that space
+        }
+        subLevel1 = dSpaceGetSublevel(space1);
+        for (int i=1;i<=subLevel1;i++){ //start from i=1, for sublevel==0 we don't add any indentation
+          indentString = indentString + " --- ";
+        }
     }
      
     if (odeinit.verbosity > 3) yDebug("%s nearCallback()\n",indentString.c_str());
@@ -436,10 +463,16 @@ void OdeSdlSimulation::nearCallback (void *data, dGeomID o1, dGeomID o2) {
     dBodyID b2 = dGeomGetBody(o2);
     if (b1 && b2 && dAreConnectedExcluding (b1,b2,dJointTypeContact)){
       if (odeinit.verbosity > 3) yDebug("%s Collision ignored: the bodies of o1 and o2 are connected by a joint.\n",indentString.c_str());
+      if (odeinit.collisionPairCache && isICubPartGeom(odeinit,o1) && isICubPartGeom(odeinit,o2)){
+          odeinit.ignoredPairs.insert(collisionPair(o1,o2));
+      }
       return;
     }
     // list of self-collisions to ignore
     if (selfCollisionOnIgnoreList(geom1name,geom2name)){
+       if (odeinit.collisionPairCache && isICubPartGeom(odeinit,o1) && isICubPartGeom(odeinit,o2)){
+           odeinit.ignoredPairs.insert(collisionPair(o1,o2));
+       }
        if (odeinit.verbosity > 3){
            yDebug("%s geom: %s (class: %s, contained within %s) AND geom: %s (class: %s, contained within %s).\n",indentString.c_str(),geom1name.c_str(),geom1className.c_str(),odeinit._iCub->dSpaceNames[superSpace1].c_str(),geom2name.c_str(),geom2ClassName.c_str(),odeinit._iCub->dSpaceNames[superSpace2].c_str());
            yDebug("%s Collision ignored (ignore list).\n",indentString.c_str());
@@ -1066,6 +1099,10 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
 
     odeinit.mutex.wait();
     nFeedbackStructs=0;
+
+    bool timing = (odeinit.timingReport > 0.0);
+    double t0 = timing ? Time::now() : 0.0;
+    double t1;
     
     if (odeinit.verbosity > 3) yDebug("\n ***info code collision detection ***"); 
     if (odeinit.verbosity > 3) yDebug("OdeSdlSimulation::ODE_process: dSpaceCollide(odeinit.space,0,&nearCallback): will test iCub space against the rest of the world (e.g. ground).\n");
@@ -1079,8 +1116,17 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
         }
     }
     if (odeinit.verbosity > 3) yDebug("***END OF info code collision detection\n ***"); 
-    
-    dWorldStep(odeinit.world, dstep);
+    if (timing) {
+        t1 = Time::now(); timeCollide += t1-t0; t0 = t1;
+    }
+
+    if (odeinit.quickStep)
+        dWorldQuickStep(odeinit.world, dstep);
+    else
+        dWorldStep(odeinit.world, dstep);
+    if (timing) {
+        t1 = Time::now(); timeStep += t1-t0; t0 = t1;
+    }
     // do 1 TIMESTEP in controllers (ok to run at same rate as ODE: 1 iteration takes about 300 times less computation time than dWorldStep)
     for (int ipart = 0; ipart<MAX_PART; ipart++) {
         if (odeinit._controls[ipart] != NULL) {
@@ -1089,6 +1135,9 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
     }
     odeinit.sync = true;
     odeinit.mutex.post();
+    if (timing) {
+        t1 = Time::now(); timeControllers += t1-t0; t0 = t1;
+    }
 
     if (odeinit._iCub->actSkinEmul == "off"){
         if ( robot_streamer->shouldSendTouchLeftHand() || robot_streamer->shouldSendTouchRightHand() ) {
@@ -1176,6 +1225,23 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
     robot_streamer->checkTorques();
 
     odeinit._iCub->setJointControlAction();
+
+    if (timing) {
+        t1 = Time::now();
+        timeSensors += t1-t0;
+        timedSteps++;
+        if (t1-lastTimingReport >= odeinit.timingReport) {
+            if (lastTimingReport > 0.0) {
+                yInfo("ODE step timing over %ld steps (ms/step): collide %.3f, step %.3f, controllers %.3f, sensors %.3f, total %.3f (timestep %ld)\n",
+                      timedSteps, 1e3*timeCollide/timedSteps, 1e3*timeStep/timedSteps,
+                      1e3*timeControllers/timedSteps, 1e3*timeSensors/timedSteps,
+                      1e3*(timeCollide+timeStep+timeControllers+timeSensors)/timedSteps, ode_step_length);
+            }
+            timeCollide = timeStep = timeControllers = timeSensors = 0.0;
+            timedSteps = 0;
+            lastTimingReport = t1;
+        }
+    }
     
     //finishTimeODE = clock() ;
     //SPS();
@@ -1654,6 +1720,132 @@ bool OdeSdlSimulation::getImage(ImageOf<PixelRgb>& target) {
     return true;
 }
 
+OdeHeadlessSimulation::OdeHeadlessSimulation() {
+}
+
+OdeHeadlessSimulation::~OdeHeadlessSimulation() {
+    clockPort.close();
+}
+
+void OdeHeadlessSimulation::drawView(bool left, bool right, bool wide) {
+}
+
+void OdeHeadlessSimulation::clearBuffer() {
+}
+
+bool OdeHeadlessSimulation::getImage(ImageOf<PixelRgb>& target) {
+    return false;
+}
+
+void OdeHeadlessSimulation::publishClock(long steps) {
+    // integer arithmetic on the step count, so that the clock does not drift
+    long ms = steps*ode_step_length;
+    Bottle& b = clockPort.prepare();
+    b.clear();
+    b.addInt((int)(ms/1000));
+    b.addInt((int)((ms%1000)*1000000));
+    clockPort.write();
+}
+
+void OdeHeadlessSimulation::simLoop(int h,int w) {
+    yDebug("***** OdeHeadlessSimulation::simLoop \n");
+    OdeInit& odeinit = OdeInit::get();
+    ResourceFinder& finder = robot_config->getFinder();
+
+    // speed is a multiple of real time, 0 means as fast as possible
+    double speed = finder.check("speed",Value(0.0)).asDouble();
+    long maxSteps = finder.check("steps",Value(0)).asInt();
+    int seed = finder.check("seed",Value(0)).asInt();
+    ConstString clockName = finder.check("clock",Value("/clock")).asString();
+
+    // the same seed gives the same trajectory, as long as the commands
+    // sent to the simulator are the same and are stamped by our clock
+    dRandSetSeed((unsigned long)seed);
+    srand((unsigned int)seed);
+
+    if (!clockPort.open(clockName.c_str())) {
+        yError("Unable to open clock port %s\n", clockName.c_str());
+        return;
+    }
+
+    dAllocateODEDataForThread(dAllocateMaskAll);
+    odeinit.stop = false;
+
+    std::signal(SIGINT, sighandler);
+    std::signal(SIGTERM, sighandler);
+
+    if (odeinit._iCub->actStartHomePos == "on"){
+        odeinit.sendHomePos();
+    }
+    // self-collision detection waits for the robot to reach the home
+    // position, here measured in simulated rather than wall-clock time
+    long selfColStep = 0;
+    if (odeinit._iCub->actSelfCol == "on") {
+        if (odeinit._iCub->actStartHomePos == "on"){
+            selfColStep = (long)(2000/ode_step_length);
+        }
+        else{
+            yWarning("the robot is not starting from HomePos and self-collision mode is on. The initial posture is already self-colliding.\n");
+            START_SELF_COLLISION_DETECTION = true;
+        }
+    }
+
+    yInfo("Headless simulation: step %ld ms, speed %g (0 = as fast as possible), seed %d, clock on %s\n",
+          ode_step_length, speed, seed, clockName.c_str());
+
+    simrun = true;
+    long steps = 0;
+    double start = Time::now();
+    double lastReport = start;
+    long lastReportSteps = 0;
+    // the data sent by the simulator is stamped in the same time base as the clock
+    SimulationTime::setSimulatedTime(0.0);
+    publishClock(steps);
+
+    while (!odeinit.stop && (maxSteps<=0 || steps<maxSteps)) {
+        if (odeinit._wrld->WAITLOADING) {
+            // no textures to load without a window
+            odeinit.mutexTexture.wait();
+            odeinit._wrld->WAITLOADING = false;
+            odeinit._wrld->static_model = false;
+            odeinit.mutexTexture.post();
+        }
+        if (selfColStep>0 && steps>=selfColStep) {
+            START_SELF_COLLISION_DETECTION = true;
+            selfColStep = 0;
+        }
+
+        // the sensors sent by ODE_process describe the world at the end of the step
+        SimulationTime::setSimulatedTime((double)((steps+1)*ode_step_length)/1000.0);
+        ODE_process(1, (void*)1);
+        steps++;
+        publishClock(steps);
+
+        double now = Time::now();
+        if (speed>0.0) {
+            double wait = start + steps*dstep/speed - now;
+            if (wait>0.0) {
+                Time::delay(wait);
+            }
+        }
+        if (now-lastReport>=10.0) {
+            yInfo("Headless simulation: %.0f steps/s (%.1fx real time)\n",
+                  (steps-lastReportSteps)/(now-lastReport),
+                  (steps-lastReportSteps)*dstep/(now-lastReport));
+            lastReport = now;
+            lastReportSteps = steps;
+        }
+    }
+    simrun = false;
+
+    double elapsed = Time::now()-start;
+    if (elapsed>0.0) {
+        yInfo("Headless simulation: %ld steps (%.3f s simulated) in %.3f s, %.0f steps/s (%.1fx real time)\n",
+              steps, steps*dstep, elapsed, steps/elapsed, steps*dstep/elapsed);
+    }
+    clockPort.close();
+}
+
 void OdeSdlSimulation::inspectWholeBodyContactsAndSendTouch()
 {
       //SkinDynLib enums
@@ -30,6 +30,8 @@
 
 #include <yarp/os/Os.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
 
 #include "SDL_thread.h"
 #include "SDL.h"
@@ -115,7 +117,7 @@ public:
 
     virtual bool getTrqData(Bottle data);
 
-private:
+protected:
     static void draw();
 
     static void printStats();
@@ -171,5 +173,45 @@ private:
 
 };
 
+/**
+ *
+ * Simulation driver without any window, for batch runs and regression
+ * tests.  The world is stepped from the calling thread either as fast
+ * as possible or at a fixed multiple of real time, and the simulated
+ * time is published on a clock port that YARP modules can follow by
+ * setting YARP_CLOCK.  Selected by passing --headless to the simulator.
+ *
+ */
+class OdeHeadlessSimulation : public OdeSdlSimulation {
+public:
+    OdeHeadlessSimulation();
+
+    ~OdeHeadlessSimulation();
+
+    /**
+     *
+     * Nothing is rendered in headless mode.
+     *
+     */
+    void drawView(bool left, bool right, bool wide);
+
+    void clearBuffer();
+
+    virtual bool getImage(yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
+
+    /**
+     *
+     * Step the world until Ctrl-c or until the requested number of
+     * steps is done, then report the achieved steps per second.
+     *
+     */
+    void simLoop(int h,int w);
+
+private:
+    void publishClock(long steps);
+
+    yarp::os::BufferedPort<yarp::os::Bottle> clockPort;
+};
+
 #endif
 
@@ -49,6 +49,12 @@ public:
     double motorMaxTorque;
     double motorDryFriction;
     double jointStopBouncyness;
+    bool   quickStep;
+    int    quickStepIterations;
+    double quickStepSOR;
+    int    stepThreads;
+    bool   collisionPairCache;
+    double timingReport;
 };
 
 class RobotConfig {
@@ -158,10 +158,16 @@ private:
         p.worldTimestep   = bParamWorld.check("timestep", Value(10)).asInt();
         p.worldCFM        = bParamWorld.check("worldCFM", Value(0.00001)).asDouble();
         p.worldERP        = bParamWorld.check("worldERP", Value(0.2)).asDouble();
+        p.quickStep       = bParamWorld.check("solver", Value("exact")).asString()=="quick";
+        p.quickStepIterations = bParamWorld.check("quickStepIterations", Value(20)).asInt();
+        p.quickStepSOR    = bParamWorld.check("quickStepSOR", Value(1.3)).asDouble();
+        p.stepThreads     = bParamWorld.check("threads", Value(1)).asInt();
+        p.timingReport    = bParamWorld.check("timingReport", Value(0.0)).asDouble();
         
         p.maxContactCorrectingVel = bParamContacts.check("maxContactCorrectingVel", Value(1e6)).asDouble();
         p.contactFrictionCoefficient = bParamContacts.check("contactFrictionCoefficient",Value(1.0)).asDouble();
         p.contactSurfaceLayer     = bParamContacts.check("contactSurfaceLayer", Value(0.0)).asDouble();
+        p.collisionPairCache      = bParamContacts.check("collisionPairCache", Value("on")).asString()=="on";
 
         p.fudgeFactor         = bParamJoints.check("fudgeFactor", Value(0.02)).asDouble();
         p.jointCFM            = bParamJoints.check("jointCFM", Value(1e-5)).asDouble();
@@ -0,0 +1,42 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+* Copyright (C) 2010 RobotCub Consortium, European Commission FP6 Project IST-004370
+* Author: Paul Fitzpatrick, Vadim Tikhanoff
+* email:   paulfitz@alum.mit.edu, vadim.tikhanoff@iit.it
+* website: www.robotcub.org
+* Permission is granted to copy, distribute, and/or modify this program
+* under the terms of the GNU General Public License, version 2 or any
+* later version published by the Free Software Foundation.
+*
+* A copy of the license can be found at
+* http://www.robotcub.org/icub/license/gpl.txt
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+* Public License for more details
+*/
+#include "SimulationTime.h"
+
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Time.h>
+
+static yarp::os::Semaphore timeMutex(1);
+static bool simulated = false;
+static double simulatedTime = 0.0;
+
+void SimulationTime::setSimulatedTime(double t) {
+    timeMutex.wait();
+    simulated = true;
+    simulatedTime = t;
+    timeMutex.post();
+}
+
+double SimulationTime::now() {
+    timeMutex.wait();
+    bool useSimulated = simulated;
+    double t = simulatedTime;
+    timeMutex.post();
+    return useSimulated ? t : yarp::os::Time::now();
+}
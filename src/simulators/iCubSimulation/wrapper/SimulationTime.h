@@ -0,0 +1,50 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+* Copyright (C) 2010 RobotCub Consortium, European Commission FP6 Project IST-004370
+* Author: Paul Fitzpatrick, Vadim Tikhanoff
+* email:   paulfitz@alum.mit.edu, vadim.tikhanoff@iit.it
+* website: www.robotcub.org
+* Permission is granted to copy, distribute, and/or modify this program
+* under the terms of the GNU General Public License, version 2 or any
+* later version published by the Free Software Foundation.
+*
+* A copy of the license can be found at
+* http://www.robotcub.org/icub/license/gpl.txt
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+* Public License for more details
+*/
+
+#ifndef ICUBSIMULATION_SIMULATIONTIME_INC
+#define ICUBSIMULATION_SIMULATIONTIME_INC
+
+/**
+ *
+ * Time used to stamp the data sent by the simulator.  This is the
+ * wall-clock time, unless a simulation that publishes its own clock
+ * (e.g. the headless one) switches to the simulated time, so that
+ * the stamps are in the same time base as the published clock.
+ *
+ */
+class SimulationTime {
+public:
+    /**
+     *
+     * Stamp the data with the simulated time from now on, and set
+     * it to t seconds.
+     *
+     */
+    static void setSimulatedTime(double t);
+
+    /**
+     *
+     * The time to stamp data with, in seconds.
+     *
+     */
+    static double now();
+};
+
+#endif
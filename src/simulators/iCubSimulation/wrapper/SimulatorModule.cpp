@@ -18,6 +18,7 @@
 * Public License for more details
 */
 #include "SimulatorModule.h"
+#include "SimulationTime.h"
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/BufferedPort.h>
@@ -84,14 +85,14 @@ SimulatorModule::SimulatorModule(WorldManager& world, RobotConfig& config,
 
 void SimulatorModule::sendTouchLeftHand(Bottle& report){
     tactileLeftHandPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     tactileLeftHandPort.setEnvelope(generalStamp);
     tactileLeftHandPort.write();
 }
 
 void SimulatorModule::sendTouchRightHand(Bottle& report){
     tactileRightHandPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     tactileRightHandPort.setEnvelope(generalStamp);
     tactileRightHandPort.write();
 }
@@ -110,7 +111,7 @@ void SimulatorModule::sendSkinEvents(iCub::skinDynLib::skinContactList& skinCont
     iCub::skinDynLib::skinContactList &skinEvents = skinEventsPort.prepare();
     skinEvents.clear();
     skinEvents.insert(skinEvents.end(), skinContactListReport.begin(), skinContactListReport.end()); 
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     skinEventsPort.setEnvelope(generalStamp);
     skinEventsPort.write();
 }
@@ -121,14 +122,14 @@ bool SimulatorModule::shouldSendSkinEvents(){
 
 void SimulatorModule::sendTouchLeftArm(Bottle& report){
      tactileLeftArmPort.prepare() = report;
-     generalStamp.update(Time::now());
+     generalStamp.update(SimulationTime::now());
      tactileLeftArmPort.setEnvelope(generalStamp);
      tactileLeftArmPort.write();
 }
 
 void SimulatorModule::sendTouchRightArm(Bottle& report){
      tactileRightArmPort.prepare() = report;
-     generalStamp.update(Time::now());
+     generalStamp.update(SimulationTime::now());
      tactileRightArmPort.setEnvelope(generalStamp);
      tactileRightArmPort.write();
 }
@@ -143,14 +144,14 @@ bool SimulatorModule::shouldSendTouchRightArm() {
 
 void SimulatorModule::sendTouchLeftForearm(Bottle& report){
     tactileLeftForearmPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     tactileLeftForearmPort.setEnvelope(generalStamp);
     tactileLeftForearmPort.write();
 }
 
 void SimulatorModule::sendTouchRightForearm(Bottle& report){
     tactileRightForearmPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     tactileRightForearmPort.setEnvelope(generalStamp);
     tactileRightForearmPort.write();
 }
@@ -165,7 +166,7 @@ bool SimulatorModule::shouldSendTouchRightForearm() {
     
 void SimulatorModule::sendTouchTorso(Bottle& report){
     tactileTorsoPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     tactileTorsoPort.setEnvelope(generalStamp);
     tactileTorsoPort.write();
 }
@@ -177,7 +178,7 @@ bool SimulatorModule::shouldSendTouchTorso() {
 
 void SimulatorModule::sendInertial(Bottle& report){
     inertialPort.prepare() = report;
-    generalStamp.update(Time::now());
+    generalStamp.update(SimulationTime::now());
     inertialPort.setEnvelope(generalStamp);
     inertialPort.write();
 }
@@ -680,7 +681,7 @@ void SimulatorModule::displayStep(int pause) {
             order = "lwr";
         }
 
-        camerasStamp.update(Time::now());
+        camerasStamp.update(SimulationTime::now());
 
         for (int i=0; i<3; i++) {
             char ch = order[i];
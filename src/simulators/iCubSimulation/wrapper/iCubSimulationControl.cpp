@@ -30,6 +30,7 @@
 
 ///specific to this device driver.
 #include "iCubSimulationControl.h"
+#include "SimulationTime.h"
 #include "OdeInit.h"
 #include <yarp/dev/ControlBoardInterfacesImpl.inl>
 #include <yarp/os/Log.h>
@@ -1438,7 +1439,7 @@ bool iCubSimulationControl::getEncoderRaw(int axis, double *v)
 
 bool iCubSimulationControl::getEncodersTimedRaw(double *encs, double *stamps)
 {
-    double timeNow = Time::now();
+    double timeNow = SimulationTime::now();
     for(int axis = 0;axis<njoints;axis++)
     {
         stamps[axis] = timeNow;
@@ -1448,7 +1449,7 @@ bool iCubSimulationControl::getEncodersTimedRaw(double *encs, double *stamps)
 
 bool iCubSimulationControl::getEncoderTimedRaw(int axis, double *enc, double *stamp)
 {
-    *stamp = Time::now();
+    *stamp = SimulationTime::now();
     return getEncoderRaw(axis, enc);
 }
 
@@ -1550,7 +1551,7 @@ bool iCubSimulationControl::getMotorEncoderCountsPerRevolutionRaw(int m, double*
 
 bool iCubSimulationControl::getMotorEncodersTimedRaw(double *encs, double *stamps)
 {
-    double timeNow = Time::now();
+    double timeNow = SimulationTime::now();
     for(int axis = 0;axis<njoints;axis++)
     {
         stamps[axis] = timeNow;
@@ -1560,7 +1561,7 @@ bool iCubSimulationControl::getMotorEncodersTimedRaw(double *encs, double *stamp
 
 bool iCubSimulationControl::getMotorEncoderTimedRaw(int axis, double *enc, double *stamp)
 {
-    *stamp = Time::now();
+    *stamp = SimulationTime::now();
     return getMotorEncoderRaw(axis, enc);
 }
 